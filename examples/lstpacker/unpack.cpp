@@ -48,181 +48,198 @@ static std::string makeBaseFilename(unsigned idx, const std::string& fileNameHex
     return fileNameHexPrefix + hexValue.substr(2); // Replace prefix
 }
 
-void unpack(const bfs::path& directory, const libsiedler2::Archiv& lst, const libsiedler2::ArchivItem_Palette* palette,
-            const std::string& fileNameHexPrefix, bool paletteAsTxt)
+static void unpackItem(const bfs::path& directory, unsigned i, const ArchivItem* item,
+                       const libsiedler2::ArchivItem_Palette* palette, const std::string& fileNameHexPrefix,
+                       bool paletteAsTxt, bool& containsPalAnim)
 {
-    boost::filesystem::create_directories(directory);
-    bool containsPalAnim = false;
+    const std::string newFileStem = makeBaseFilename(i, fileNameHexPrefix);
+    bfs::path newFilepath = directory / newFileStem;
 
-    for(unsigned i = 0; i < lst.size(); ++i)
+    switch(item->getBobType())
     {
-        const ArchivItem* item = lst[i];
-
-        if(!item)
-            continue;
+        case BobType::Sound: // WAVs, MIDIs
+        {
+            auto subtype = SoundType::None;
 
-        const std::string newFileStem = makeBaseFilename(i, fileNameHexPrefix);
-        bfs::path newFilepath = directory / newFileStem;
+            const auto* i = dynamic_cast<const ArchivItem_Sound*>(item);
+            if(item)
+                subtype = i->getType();
 
-        switch(item->getBobType())
-        {
-            case BobType::Sound: // WAVs, MIDIs
+            switch(subtype)
             {
-                auto subtype = SoundType::None;
+                case SoundType::Midi: cerr << "Unsupported midi sound ignored: " << newFileStem << endl; break;
+                case SoundType::Wave:
+                {
+                    newFilepath.replace_extension(".wav");
 
-                const auto* i = dynamic_cast<const ArchivItem_Sound*>(item);
-                if(item)
-                    subtype = i->getType();
+                    cout << "extracting " << newFilepath << ": ";
 
-                switch(subtype)
+                    const auto* wave = dynamic_cast<const ArchivItem_Sound_Wave*>(item);
+                    bnw::ofstream fwave(newFilepath, ios::binary);
+                    if(fwave && wave && wave->write(fwave, false) == 0)
+                    {
+                        cout << "done" << endl;
+                    } else
+                        cout << "failed" << endl;
+                }
+                break;
+                case SoundType::XMidi:
                 {
-                    case SoundType::Midi: cerr << "Unsupported midi sound ignored: " << newFileStem << endl; break;
-                    case SoundType::Wave:
+                    newFilepath.replace_extension(".xmi");
+                    cout << "extracting " << newFilepath << ": ";
+
+                    const auto* wave = dynamic_cast<const ArchivItem_Sound_XMidi*>(item);
                     {
-                        newFilepath.replace_extension(".wav");
+                        bnw::ofstream fwave(newFilepath, ios::binary);
+                        if(fwave && wave->write(fwave) == 0)
+                            cout << "done";
+                        else
+                            cout << "failed";
+                        cout << endl;
+                    }
+
+                    newFilepath.replace_extension(".midi");
 
-                        cout << "extracting " << newFilepath << ": ";
+                    cout << "extracting " << newFilepath << ": ";
 
-                        const auto* wave = dynamic_cast<const ArchivItem_Sound_Wave*>(item);
+                    const MIDI_Track& midiTrack = wave->getMidiTrack(0);
+                    ArchivItem_Sound_Midi soundArchiv;
+                    soundArchiv.addTrack(midiTrack);
+                    soundArchiv.setPPQ(wave->getPPQN());
+                    {
                         bnw::ofstream fwave(newFilepath, ios::binary);
-                        if(fwave && wave && wave->write(fwave, false) == 0)
-                        {
-                            cout << "done" << endl;
-                        } else
-                            cout << "failed" << endl;
+                        if(fwave && soundArchiv.write(fwave) == 0)
+                            cout << "done";
+                        else
+                            cout << "failed";
+                        cout << endl;
                     }
+
                     break;
-                    case SoundType::XMidi:
-                    {
-                        newFilepath.replace_extension(".xmi");
-                        cout << "extracting " << newFilepath << ": ";
-
-                        auto wave = clone(dynamic_cast<const ArchivItem_Sound_XMidi&>(*item));
-                        {
-                            bnw::ofstream fwave(newFilepath, ios::binary);
-                            if(fwave && wave->write(fwave) == 0)
-                                cout << "done";
-                            else
-                                cout << "failed";
-                            cout << endl;
-                        }
-
-                        newFilepath.replace_extension(".midi");
-
-                        cout << "extracting " << newFilepath << ": ";
-
-                        const MIDI_Track& midiTrack = wave->getMidiTrack(0);
-                        ArchivItem_Sound_Midi soundArchiv;
-                        soundArchiv.addTrack(midiTrack);
-                        soundArchiv.setPPQ(wave->getPPQN());
-                        {
-                            bnw::ofstream fwave(newFilepath, ios::binary);
-                            if(fwave && soundArchiv.write(fwave) == 0)
-                                cout << "done";
-                            else
-                                cout << "failed";
-                            cout << endl;
-                        }
-
-                        break;
-                    }
-                    default: cerr << "Unsupported other sound ignored: " << newFileStem << endl; break;
                 }
+                default: cerr << "Unsupported other sound ignored: " << newFileStem << endl; break;
             }
-            break;
-            case BobType::Font:
-            {
-                const auto* font = dynamic_cast<const ArchivItem_Font*>(item);
+        }
+        break;
+        case BobType::Font:
+        {
+            const auto* font = dynamic_cast<const ArchivItem_Font*>(item);
 
-                newFilepath += ".dx" + s25util::toStringClassic((short)font->getDx());
-                newFilepath += ".dy" + s25util::toStringClassic((short)font->getDy());
-                newFilepath += (font->isUnicode) ? ".fonX" : ".fon";
-                cout << "extracting " << newFilepath << ": ";
+            newFilepath += ".dx" + s25util::toStringClassic((short)font->getDx());
+            newFilepath += ".dy" + s25util::toStringClassic((short)font->getDy());
+            newFilepath += (font->isUnicode) ? ".fonX" : ".fon";
+            cout << "extracting " << newFilepath << ": ";
 
-                unpack(newFilepath, *font, palette, font->isUnicode ? "U+" : "");
-            }
-            break;
-            case BobType::Palette:
-            {
-                Archiv items;
-                items.pushC(*item);
-                newFilepath.replace_extension(".bbm");
-
-                cout << "extracting " << newFilepath << ": ";
-
-                if(Write(newFilepath, items) != 0)
-                    cout << "failed" << endl;
-                else
-                    cout << "done" << endl;
-                if(paletteAsTxt)
-                    loader::WriteTxtPalette(newFilepath.replace_extension(".palette.txt"),
-                                            static_cast<const libsiedler2::ArchivItem_Palette&>(*item));
-            }
-            break;
-            case BobType::Bob:
+            boost::filesystem::create_directories(newFilepath);
+            // Glyphs are stored sparse, so iterate only the existing ones
+            bool fontContainsPalAnim = false;
+            for(const auto& glyph : font->getGlyphs())
             {
-                const auto* bob = dynamic_cast<const ArchivItem_Bob*>(item);
-                unpack(directory, *bob, palette);
-                // links[][8][2][6]
-                bnw::ofstream linksFile(directory / "mapping.links");
-                bob->writeLinks(linksFile);
+                unpackItem(newFilepath, glyph.codepoint, glyph.item.get(), palette, font->isUnicode ? "U+" : "",
+                           false, fontContainsPalAnim);
             }
-            break;
-            case BobType::Map: cerr << "MapFile is not supported. Ignored: " << newFileStem << endl; break;
-            case BobType::Text:
-            {
-                newFilepath.replace_extension(".txt");
-                cout << "extracting " << newFilepath << ": ";
+        }
+        break;
+        case BobType::Palette:
+        {
+            Archiv items;
+            items.pushC(*item);
+            newFilepath.replace_extension(".bbm");
+
+            cout << "extracting " << newFilepath << ": ";
+
+            if(Write(newFilepath, items) != 0)
+                cout << "failed" << endl;
+            else
+                cout << "done" << endl;
+            if(paletteAsTxt)
+                loader::WriteTxtPalette(newFilepath.replace_extension(".palette.txt"),
+                                        static_cast<const libsiedler2::ArchivItem_Palette&>(*item));
+        }
+        break;
+        case BobType::Bob:
+        {
+            // Images of bobs are only decoded on access
+            ArchivItem_Bob bob(dynamic_cast<const ArchivItem_Bob&>(*item));
+            if(bob.decodeAll() != 0)
+                cerr << "Failed to decode all images of " << newFileStem << endl;
+            unpack(directory, bob, palette);
+            // links[][8][2][6]
+            bnw::ofstream linksFile(directory / "mapping.links");
+            bob.writeLinks(linksFile);
+        }
+        break;
+        case BobType::Map: cerr << "MapFile is not supported. Ignored: " << newFileStem << endl; break;
+        case BobType::Text:
+        {
+            newFilepath.replace_extension(".txt");
+            cout << "extracting " << newFilepath << ": ";
 
-                const auto* txt = dynamic_cast<const ArchivItem_Text*>(item);
-                bnw::ofstream fTxt(newFilepath, ios::binary);
-                if(fTxt && txt && txt->write(fTxt, false) == 0)
-                {
-                    cout << "done" << endl;
-                } else
-                    cout << "failed" << endl;
-            }
-            break;
-            case BobType::Raw: cerr << "Raw item is not supported. Ignored: " << newFileStem << endl; break;
-            case BobType::MapHeader: cerr << "Map-header is not supported. Ignored: " << newFileStem << endl; break;
-            case BobType::BitmapRLE: // RLE komprimiertes Bitmap
-                newFilepath.replace_extension(".rle");
-                BOOST_FALLTHROUGH;
-                // no break
-            case BobType::BitmapPlayer: // Bitmap mit spezifischer Spielerfarbe
-                if(!newFilepath.has_extension())
-                    newFilepath.replace_extension(".player");
-                BOOST_FALLTHROUGH;
-                // no break
-            case BobType::BitmapShadow:
-                if(!newFilepath.has_extension())
-                    newFilepath.replace_extension(".shadow");
-                BOOST_FALLTHROUGH;
-                // no break
-            case BobType::Bitmap: // uncompressed Bitmap
+            const auto* txt = dynamic_cast<const ArchivItem_Text*>(item);
+            bnw::ofstream fTxt(newFilepath, ios::binary);
+            if(fTxt && txt && txt->write(fTxt, false) == 0)
             {
-                Archiv items;
-                const auto& bitmap = dynamic_cast<const ArchivItem_BitmapBase&>(*item);
-                items.pushC(bitmap);
-
-                newFilepath += ".nx" + s25util::toStringClassic(bitmap.getNx());
-                newFilepath += ".ny" + s25util::toStringClassic(bitmap.getNy());
-                newFilepath += ".bmp";
-
-                cout << "extracting " << newFilepath << ": ";
-
-                if(Write(newFilepath, items, palette) != 0)
-                    cout << "failed" << endl;
-                else
-                    cout << "done" << endl;
-                if(bitmap.getPalette() && (paletteAsTxt || (*bitmap.getPalette() != *palette)))
-                    loader::WriteTxtPalette((directory / newFileStem).replace_extension(".palette.txt"),
-                                            *bitmap.getPalette());
-            }
-            break;
-            case BobType::PaletteAnim: containsPalAnim = true; break;
-            default: cerr << "Unhandled bobtype: " << static_cast<unsigned>(item->getBobType()) << endl;
+                cout << "done" << endl;
+            } else
+                cout << "failed" << endl;
         }
+        break;
+        case BobType::Raw: cerr << "Raw item is not supported. Ignored: " << newFileStem << endl; break;
+        case BobType::MapHeader: cerr << "Map-header is not supported. Ignored: " << newFileStem << endl; break;
+        case BobType::BitmapRLE: // RLE komprimiertes Bitmap
+            newFilepath.replace_extension(".rle");
+            BOOST_FALLTHROUGH;
+            // no break
+        case BobType::BitmapPlayer: // Bitmap mit spezifischer Spielerfarbe
+            if(!newFilepath.has_extension())
+                newFilepath.replace_extension(".player");
+            BOOST_FALLTHROUGH;
+            // no break
+        case BobType::BitmapShadow:
+            if(!newFilepath.has_extension())
+                newFilepath.replace_extension(".shadow");
+            BOOST_FALLTHROUGH;
+            // no break
+        case BobType::Bitmap: // uncompressed Bitmap
+        {
+            Archiv items;
+            const auto& bitmap = dynamic_cast<const ArchivItem_BitmapBase&>(*item);
+            items.pushC(bitmap);
+
+            newFilepath += ".nx" + s25util::toStringClassic(bitmap.getNx());
+            newFilepath += ".ny" + s25util::toStringClassic(bitmap.getNy());
+            newFilepath += ".bmp";
+
+            cout << "extracting " << newFilepath << ": ";
+
+            if(Write(newFilepath, items, palette) != 0)
+                cout << "failed" << endl;
+            else
+                cout << "done" << endl;
+            if(bitmap.getPalette() && (paletteAsTxt || (*bitmap.getPalette() != *palette)))
+                loader::WriteTxtPalette((directory / newFileStem).replace_extension(".palette.txt"),
+                                        *bitmap.getPalette());
+        }
+        break;
+        case BobType::PaletteAnim: containsPalAnim = true; break;
+        default: cerr << "Unhandled bobtype: " << static_cast<unsigned>(item->getBobType()) << endl;
+    }
+}
+
+void unpack(const bfs::path& directory, const libsiedler2::Archiv& lst, const libsiedler2::ArchivItem_Palette* palette,
+            const std::string& fileNameHexPrefix, bool paletteAsTxt)
+{
+    boost::filesystem::create_directories(directory);
+    bool containsPalAnim = false;
+
+    for(unsigned i = 0; i < lst.size(); ++i)
+    {
+        const ArchivItem* item = lst[i];
+
+        if(!item)
+            continue;
+
+        unpackItem(directory, i, item, palette, fileNameHexPrefix, paletteAsTxt, containsPalAnim);
     }
 
     if(containsPalAnim)
@@ -6,7 +6,7 @@
 
 #include <cstddef>
 #include <memory>
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace libsiedler2 {
@@ -42,9 +42,9 @@ public:
     /// Return the item at the given index or nullptr if the index is out of bounds
     const ArchivItem* get(size_t index) const { return (index < size()) ? data[index].get() : nullptr; }
     /// Return the first item with the given name
-    ArchivItem* find(const std::string& name);
+    ArchivItem* find(std::string_view name);
     /// Return the first item with the given name
-    const ArchivItem* find(const std::string& name) const;
+    const ArchivItem* find(std::string_view name) const;
     /// Return the item at the given position and remove it from the archive
     std::unique_ptr<ArchivItem> release(size_t index);
     /// Return the number of entries (includes nullptr entries)
@@ -6,7 +6,9 @@
 
 #include "ICloneable.h" // IWYU pragma: export
 #include "enumTypes.h"
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace libsiedler2 {
 /// Base class for all ArchivItems. Defined by a type and possibly a name
@@ -21,9 +23,9 @@ public:
     /// liefert den Bobtype des Items.
     BobType getBobType() const { return bobtype_; }
     /// Set the name if the item
-    void setName(const std::string& name) { name_ = name; }
-    /// Return the name of the item
-    std::string getName() const { return name_; }
+    void setName(std::string_view name);
+    /// Return the name of the item. The view stays valid until the name is changed or the item is destroyed
+    std::string_view getName() const { return *name_; }
 
 protected:
     ArchivItem(const ArchivItem&) = default;
@@ -34,6 +36,7 @@ protected:
     // the line
     BobType bobtype_; /// Type of the element
 private:
-    std::string name_; /// Element name
+    /// Element name. Shared by all items with the same name, so copying items (and names) never allocates
+    std::shared_ptr<const std::string> name_;
 };
 } // namespace libsiedler2
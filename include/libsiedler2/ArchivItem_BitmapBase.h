@@ -5,8 +5,10 @@
 #pragma once
 
 #include "ArchivItem.h"
+#include "CopyOnWrite.h"
 #include "PixelBufferRef.h"
 #include "enumTypes.h"
+#include "itemCast.h"
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
@@ -15,6 +17,7 @@
 namespace libsiedler2 {
 
 class ArchivItem_Palette;
+class DeduplicationContext;
 struct ColorBGRA;
 
 /**
@@ -45,7 +48,9 @@ public:
     virtual int write(std::ostream& file, const ArchivItem_Palette* palette) const = 0;
 
     /// liefert den Textur-Datenblock.
-    const std::vector<uint8_t>& getPixelData() const { return pxlData_; }
+    const std::vector<uint8_t>& getPixelData() const { return pxlData_.get(); }
+    /// True iff the pixel data is shared with other bitmaps (copies or deduplicated ones)
+    bool isPixelDataShared() const { return pxlData_.isShared(); }
 
     /// liefert den X-Nullpunkt.
     int16_t getNx() const;
@@ -78,12 +83,16 @@ public:
 
     /// Return the currently used palette
     const ArchivItem_Palette* getPalette() const { return palette_.get(); }
+    /// Return the currently used palette which may be shared with other bitmaps
+    const std::shared_ptr<const ArchivItem_Palette>& getSharedPalette() const { return palette_; }
     /// Check if the given palette can be used for this bitmap. That is all ARGB colors are in the palette
     bool checkPalette(const ArchivItem_Palette& palette) const;
     /// Set the palette passing ownership
     void setPalette(std::unique_ptr<ArchivItem_Palette> palette);
-    /// Set the palette NOT passing ownership
+    /// Set the palette NOT passing ownership. Shares an equal palette used by other bitmaps if possible
     void setPaletteCopy(const ArchivItem_Palette& palette);
+    /// Set a palette which may be shared with other bitmaps
+    void setSharedPalette(std::shared_ptr<const ArchivItem_Palette> palette);
     /// Remove the currently used palette
     void removePalette();
 
@@ -108,23 +117,31 @@ protected:
     uint8_t getPalettedPixel(uint16_t x, uint16_t y) const;
     /// Return the pixel at the given position assuming the bitmap is ARGB
     ColorBGRA getARGBPixel(uint16_t x, uint16_t y) const;
-    PixelBufferPalettedRef getBufferPaletted() const;
-    PixelBufferBGRARef getBufferARGB() const;
-
-    std::vector<uint8_t>& getPixelData() { return pxlData_; }
+    /// Return a read-only view of the pixels
+    PixelBufferPalettedConstRef getBufferPaletted() const;
+    PixelBufferBGRAConstRef getBufferARGB() const;
+    /// Return a view of the pixels for modification (creates a private copy if it was shared)
+    PixelBufferPalettedRef getBufferPaletted();
+    PixelBufferBGRARef getBufferARGB();
+
+    /// Return the pixel data for modification (creates a private copy if it was shared)
+    std::vector<uint8_t>& getPixelData() { return pxlData_.getMutable(); }
     template<typename T>
     void doGetVisibleArea(int& vx, int& vy, unsigned& vw, unsigned& vh, T&& isTransparent) const;
 
     int16_t nx_; /// X-Nullpunkt.
     int16_t ny_; /// Y-Nullpunkt.
 private:
+    friend class DeduplicationContext;
+
     uint16_t width_;  /// Breite des Bildes.
     uint16_t height_; /// Höhe des Bildes.
 
-    std::vector<uint8_t> pxlData_; /// Die Texturdaten.
+    CopyOnWrite<std::vector<uint8_t>> pxlData_; /// Die Texturdaten.
 
-    std::unique_ptr<const ArchivItem_Palette> palette_; /// Die Palette.
-    TextureFormat format_;                              /// Das Texturformat.
+    /// Die Palette. Immutable, so it can be shared between bitmaps (e.g. copies) and gets replaced on change
+    std::shared_ptr<const ArchivItem_Palette> palette_;
+    TextureFormat format_; /// Das Texturformat.
 };
 
 // Define inline in header to allow optimizations
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ArchivItem_BitmapBase.h"
+#include "CopyOnWrite.h"
 #include "GetFormat.h"
 #include "PixelBufferPaletted.h"
 #include "enumTypes.h"
@@ -53,8 +54,13 @@ public:
 
     void getVisibleArea(int& vx, int& vy, unsigned& vw, unsigned& vh) const override;
 
-    uint8_t getPlayerColorIdx(uint16_t x, uint16_t y) const { return tex_pdata.get(x, y); }
-    bool isPlayerColor(uint16_t x, uint16_t y) const { return tex_pdata.get(x, y) != TRANSPARENT_PLAYER_CLR_IDX; }
+    uint8_t getPlayerColorIdx(uint16_t x, uint16_t y) const { return tex_pdata.get().get(x, y); }
+    bool isPlayerColor(uint16_t x, uint16_t y) const
+    {
+        return tex_pdata.get().get(x, y) != TRANSPARENT_PLAYER_CLR_IDX;
+    }
+    /// True iff the player color data is shared with other bitmaps (copies or deduplicated ones)
+    bool isPlayerDataShared() const { return tex_pdata.isShared(); }
 
     /// schreibt das Bitmap inkl. festgelegter Spielerfarbe in einen Puffer.
     int print(uint8_t* buffer, uint16_t buffer_width, uint16_t buffer_height, TextureFormat buffer_format,
@@ -80,7 +86,10 @@ public:
     int create(const T_PixelBuffer& pixelBuffer, const ArchivItem_Palette* palette, uint8_t plClrStartIdx = 128);
 
 protected:
-    PixelBufferPaletted tex_pdata; /// Die Spielerfarbedaten.
+    CopyOnWrite<PixelBufferPaletted> tex_pdata; /// Die Spielerfarbedaten.
+
+private:
+    friend class DeduplicationContext;
 };
 
 template<class T_PixelBuffer>
@@ -7,9 +7,12 @@
 #include "Archiv.h"
 #include "ArchivItem.h"
 #include "ImgDir.h"
+#include "enumTypes.h"
+#include <array>
 #include <cstdint>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <vector>
 
 namespace libsiedler2 {
@@ -19,6 +22,10 @@ class ArchivItem_Bitmap_Player;
 
 namespace libsiedler2 {
 
+/// Archive of the body and overlay images of a BOB file.
+/// The images are only decoded on first access via getImage/getBody/getOverlay as most are never used.
+/// Until then the entries of the archive are empty and the images are stored as the compressed color blocks of
+/// the file, which are shared with all copies. The color blocks are validated on load, so decoding can't fail.
 class ArchivItem_Bob : public ArchivItem, public Archiv
 {
 public:
@@ -40,9 +47,32 @@ public:
         // Array [overlayIdx][animStep][fat][direction]: [35][8][2][6]
         return getOverlayIdx(((overlayIdx * 8 + animationstep) * 2 + fat) * 6 + static_cast<unsigned>(direction));
     }
+    /// Return the index of the body image in the archive
+    static unsigned getBodyIdx(bool fat, ImgDir direction, unsigned animationstep)
+    {
+        // Array: [fat][direction][animStep]: [2][6][8]
+        return (fat * 6 + static_cast<unsigned>(direction)) * 8 + animationstep;
+    }
     ArchivItem_Bitmap_Player* getBody(bool fat, ImgDir direction, unsigned animationstep);
     ArchivItem_Bitmap_Player* getOverlay(unsigned overlayIdx, bool fat, ImgDir direction, unsigned animationstep);
 
+    /// Return the image at the given index of the archive, decoding it on first access.
+    /// nullptr if there is no image (e.g. unused overlay)
+    ArchivItem_Bitmap_Player* getImage(unsigned idx);
+    /// Decode all images not yet decoded, e.g. to access them directly via the archive
+    int decodeAll();
+    /// True iff the image at the given index can be returned by getImage
+    bool hasImage(unsigned idx) const;
+    /// Return size and draw offset of the image at the given index without decoding it. All 0 if there is no image
+    void getImageInfo(unsigned idx, uint16_t& width, uint16_t& height, int16_t& nx, int16_t& ny) const;
+    /// Draw the image at the given index into the buffer without decoding it into a bitmap (unless already done).
+    /// The top left of the image is drawn at (to_x, to_y), transparent pixels are skipped.
+    /// Player colors are drawn as for ArchivItem_Bitmap_Player::print.
+    /// May be called concurrently with other const functions
+    int printImage(unsigned idx, uint8_t* buffer, uint16_t buffer_width, uint16_t buffer_height,
+                   TextureFormat buffer_format, const ArchivItem_Palette* palette = nullptr,
+                   uint8_t plClrStartIdx = 128, uint16_t to_x = 0, uint16_t to_y = 0, bool only_player = false) const;
+
     /// Write the links in mapping format (TAB separated entries with # comments)
     void writeLinks(std::ostream& file) const;
     static std::map<uint16_t, uint16_t> readLinks(std::istream& file);
@@ -50,5 +80,29 @@ public:
 protected:
     uint16_t numOverlayImgs;     /// Number of actual overlay pictures (e.g. carried wares)
     std::vector<uint16_t> links; /// Array [overlayId][animStep=8][fat=2][direction=6] mapping to an overlay picture
+
+private:
+    /// Compressed image referencing a color block
+    struct ImageInfo
+    {
+        /// Index into ImageData::colorBlocks, NO_COLOR_BLOCK if the image is not used
+        uint8_t colorBlock;
+        uint8_t ny;
+        /// Start of each line in the color block
+        std::vector<uint16_t> starts;
+    };
+    /// Data of the file required for decoding the images
+    struct ImageData
+    {
+        /// Color block of the bodies followed by the ones of each direction for the overlays
+        std::array<std::vector<uint8_t>, 7> colorBlocks;
+        std::vector<ImageInfo> images;
+        std::shared_ptr<const ArchivItem_Palette> palette;
+    };
+
+    /// Decode the image at the given index into the archive
+    int decodeImage(unsigned idx);
+
+    std::shared_ptr<const ImageData> imageData_;
 };
 } // namespace libsiedler2
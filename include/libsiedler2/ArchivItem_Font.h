@@ -4,10 +4,12 @@
 
 #pragma once
 
-#include "Archiv.h"
 #include "ArchivItem.h"
 #include <cstdint>
 #include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace libsiedler2 {
 class ArchivItem_Palette;
@@ -16,10 +18,22 @@ class ArchivItem_Palette;
 namespace libsiedler2 {
 
 /// Klasse für Fonts.
-class ArchivItem_Font : public ArchivItem, public Archiv
+/// Glyphs are stored sparse (sorted by codepoint), so unicode fonts only use memory for existing glyphs
+class ArchivItem_Font : public ArchivItem
 {
 public:
+    struct Glyph
+    {
+        uint32_t codepoint;
+        std::unique_ptr<ArchivItem> item;
+    };
+
     ArchivItem_Font();
+    ArchivItem_Font(const ArchivItem_Font& other);
+    ArchivItem_Font(ArchivItem_Font&&) noexcept;
+    ~ArchivItem_Font() override;
+    ArchivItem_Font& operator=(const ArchivItem_Font& other);
+    ArchivItem_Font& operator=(ArchivItem_Font&&) noexcept;
     RTTR_CLONEABLE(ArchivItem_Font)
 
     /// lädt die Fontdaten aus einer Datei.
@@ -40,11 +54,43 @@ public:
     /// setzt den Y-Buchstabenabstand.
     void setDy(uint8_t dy) { this->dy = dy; }
 
+    /// Return the name of the glyph for the given codepoint, e.g. "U+41". Created on demand as glyphs are unnamed
+    static std::string getGlyphName(uint32_t codepoint);
+
+    /// Number of chars, i.e. one more than the highest codepoint which can be set without growing the font.
+    /// This is the value stored in the file
+    size_t size() const { return numChars_; }
+    /// Remove all glyphs and set the number of chars
+    void alloc(size_t numChars);
+    /// Remove all glyphs and set the number of chars to 0
+    void clear();
+    /// Return the glyph for the codepoint or nullptr if it does not exist
+    ArchivItem* get(size_t codepoint);
+    const ArchivItem* get(size_t codepoint) const;
+    const ArchivItem* operator[](size_t codepoint) const { return get(codepoint); }
+    ArchivItem* operator[](size_t codepoint) { return get(codepoint); }
+    /// Set the glyph for the codepoint, nullptr removes it. Increases the number of chars if required
+    void set(size_t codepoint, std::unique_ptr<ArchivItem> item);
+    /// Set the glyph for the codepoint to a copy of the given item
+    void setC(size_t codepoint, const ArchivItem& item);
+    /// Return the glyph for the codepoint and remove it from the font
+    std::unique_ptr<ArchivItem> release(size_t codepoint);
+    /// Number of existing glyphs
+    size_t getNumGlyphs() const { return glyphs_.size(); }
+    /// All existing glyphs sorted by codepoint
+    const std::vector<Glyph>& getGlyphs() const { return glyphs_; }
+
     bool isUnicode;
 
 protected:
     uint8_t dx; /// X-Buchstabenabstand.
     uint8_t dy; /// Y-Buchstabenabstand.
+
+private:
+    std::vector<Glyph>::const_iterator findGlyph(size_t codepoint) const;
+
+    size_t numChars_;
+    std::vector<Glyph> glyphs_;
 };
 
 } // namespace libsiedler2
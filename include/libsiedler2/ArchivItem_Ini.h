@@ -1,26 +1,22 @@
-// Copyright (C) 2005 - 2021 Settlers Freaks (sf-team at siedler25.org)
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
 //
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #pragma once
 
-#include "Archiv.h"
 #include "ArchivItem.h"
+#include <cstdint>
 #include <iosfwd>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace libsiedler2 {
-class ArchivItem_Text;
 
 /// Klasse für INI-Dateien (genauergesagt eine Sektion).
-class ArchivItem_Ini : public ArchivItem, public Archiv
+/// All keys and values are stored in a single string pool with a flat hash table for the lookup by key
+class ArchivItem_Ini : public ArchivItem
 {
-    ArchivItem_Text* getItem(const std::string& name);
-    const ArchivItem_Text* getItem(const std::string& name, bool enforce_exists = false) const;
-
-    // Add a value
-    void addValue(const std::string& name, const std::string& value);
-
 public:
     ArchivItem_Ini();
 
@@ -30,27 +26,71 @@ public:
 
     /// lädt die INI-Daten aus einer Datei.
     int load(std::istream& file);
+    /// Parse a section from the start of @p text (e.g. a mapped file) and remove the parsed part from it
+    int load(std::string_view& text);
 
     /// schreibt die INI-Daten in eine Datei.
     int write(std::ostream& file) const;
+    /// Append the INI data to @p buffer, e.g. to write multiple sections at once
+    void write(std::string& buffer) const;
+
+    /// Number of keys
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    /// Return the key/value at the given index, keys are in the order they are added
+    std::string_view getKey(size_t idx) const { return getString(entries_[idx].key); }
+    std::string_view getValueAt(size_t idx) const { return getString(entries_[idx].value); }
+    bool hasValue(std::string_view name) const { return findEntry(name) != NO_ENTRY; }
 
     /// Get a value by name, throw if it does not exist
-    std::string getValue(const std::string& name) const;
-    int getIntValue(const std::string& name) const;
-    bool getBoolValue(const std::string& name) const;
+    std::string getValue(std::string_view name) const;
+    int getIntValue(std::string_view name) const;
+    bool getBoolValue(std::string_view name) const;
 
     /// Get a value by name, return default if it does not exist
-    std::string getValue(const std::string& name, const std::string& defaultVal) const;
-    std::string getValue(const std::string& name, const char* defaultVal) const
+    std::string getValue(std::string_view name, const std::string& defaultVal) const;
+    std::string getValue(std::string_view name, const char* defaultVal) const
     {
         return getValue(name, std::string(defaultVal));
     }
-    int getValue(const std::string& name, int defaultVal) const;
-    int getValue(const std::string& name, bool defaultVal) const;
+    int getValue(std::string_view name, int defaultVal) const;
+    int getValue(std::string_view name, bool defaultVal) const;
 
     /// Set or change a value
-    void setValue(const std::string& name, const std::string& value);
-    void setValue(const std::string& name, int value);
+    void setValue(std::string_view name, std::string_view value);
+    void setValue(std::string_view name, int value);
+    /// Remove all keys
+    void clear();
+
+private:
+    static constexpr uint32_t NO_ENTRY = 0xFFFFFFFF;
+    /// Part of the string pool
+    struct StringRef
+    {
+        uint32_t offset, length;
+    };
+    struct Entry
+    {
+        StringRef key, value;
+    };
+
+    std::string_view getString(StringRef ref) const { return std::string_view(pool_).substr(ref.offset, ref.length); }
+    StringRef addString(std::string_view str);
+    /// Check whether the string points into the pool, i.e. is invalidated when adding strings
+    bool isInPool(std::string_view str) const;
+    /// Return the index of the entry with the given key or NO_ENTRY
+    uint32_t findEntry(std::string_view name) const;
+    void rebuildBuckets(size_t numBuckets);
+    /// Remove unused strings from the pool
+    void compactPool();
+
+    /// Keys and values of all entries
+    std::string pool_;
+    /// Bytes of pool_ not referenced anymore (replaced values)
+    size_t unusedBytes_ = 0;
+    std::vector<Entry> entries_;
+    /// Open addressing hash table (power of 2 size) with linear probing of the indices into entries_
+    std::vector<uint32_t> buckets_;
 };
 
 } // namespace libsiedler2
@@ -4,11 +4,16 @@
 
 #pragma once
 
-#include "Archiv.h"
 #include "ArchivItem.h"
+#include "CopyOnWrite.h"
+#include "span.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <vector>
 
 namespace libsiedler2 {
 class ArchivItem_Map_Header;
@@ -37,7 +42,8 @@ enum class MapLayer
 };
 
 /// S2 map file
-class ArchivItem_Map : public ArchivItem, private Archiv
+/// The present layers are stored in one contiguous block in ascending order, each getNumNodes() entries long
+class ArchivItem_Map : public ArchivItem
 {
 public:
     struct ExtraAnimalInfo
@@ -48,6 +54,45 @@ public:
     /// The number of map layers present in SWD files
     static constexpr unsigned NUM_SWD_LAYERS = static_cast<unsigned>(MapLayer::Lakes) + 1u;
 
+    /// Values of all (SWD) layers of a single node
+    struct NodeData
+    {
+        std::array<uint8_t, NUM_SWD_LAYERS> values;
+
+        uint8_t operator[](MapLayer type) const { return values[static_cast<unsigned>(type)]; }
+        uint8_t& operator[](MapLayer type) { return values[static_cast<unsigned>(type)]; }
+    };
+
+    /// Reference to the values of all present layers of a single node, i.e. one entry per layer at a stride of
+    /// getNumNodes(). Like the spans from getLayer it is only valid until the map is loaded, initialized or copied
+    template<typename T>
+    class BasicNodeRef
+    {
+    public:
+        bool hasLayer(MapLayer type) const
+        {
+            return static_cast<unsigned>(type) < NUM_SWD_LAYERS && (layerMask_ & getLayerBit(type)) != 0u;
+        }
+        /// Value of the given layer, which must be present
+        T& operator[](MapLayer type) const
+        {
+            assert(hasLayer(type));
+            return data_[static_cast<size_t>(getLayerIndex(layerMask_, type)) * numNodes_];
+        }
+
+    private:
+        friend class ArchivItem_Map;
+        BasicNodeRef(T* data, unsigned numNodes, unsigned layerMask)
+            : data_(data), numNodes_(numNodes), layerMask_(layerMask)
+        {}
+
+        T* data_;
+        unsigned numNodes_;
+        unsigned layerMask_;
+    };
+    using NodeRef = BasicNodeRef<uint8_t>;
+    using ConstNodeRef = BasicNodeRef<const uint8_t>;
+
     ArchivItem_Map();
     ~ArchivItem_Map() override;
     RTTR_CLONEABLE(ArchivItem_Map)
@@ -56,6 +101,11 @@ public:
     int load(std::istream& file, bool onlyHeader);
     /// Write the map to a file
     int write(std::ostream& file) const;
+    /// Load the map from the compressed format (see writeCompressed)
+    int loadCompressed(std::istream& file);
+    /// Write the map in a compressed format: Each layer is compressed separately, optionally delta filtered.
+    /// Loading it and writing it as SWD/WLD produces the same file as write()
+    int writeCompressed(std::ostream& file) const;
 
     /// Init the map layers from the given header
     void init(std::unique_ptr<ArchivItem_Map_Header> header);
@@ -63,12 +113,24 @@ public:
     /// Return the map header
     const ArchivItem_Map_Header& getHeader() const;
 
-    /// Get a layer of the map
-    const std::vector<uint8_t>& getLayer(MapLayer type) const;
-    /// Get a layer of the map
-    std::vector<uint8_t>& getLayer(MapLayer type);
+    /// Number of nodes (width * height), i.e. size of each layer
+    unsigned getNumNodes() const { return numNodes_; }
+
+    /// Get a layer of the map. Throws if it does not exist
+    span<const uint8_t> getLayer(MapLayer type) const;
+    /// Get a layer of the map. Throws if it does not exist
+    span<uint8_t> getLayer(MapLayer type);
     bool hasLayer(MapLayer type) const;
 
+    /// Get a reference to the values of all layers of a node without copying them
+    ConstNodeRef getNodeRef(unsigned idx) const;
+    /// Get a modifiable reference to the values of all layers of a node without copying them
+    NodeRef getNodeRef(unsigned idx);
+    /// Get a copy of the values of all layers for a node. Values of layers not present are 0
+    NodeData getNode(unsigned idx) const;
+    /// Set the values of all present layers for a node
+    void setNode(unsigned idx, const NodeData& node);
+
     /// Get the map data at the given index
     uint8_t getMapDataAt(MapLayer type, unsigned idx) const;
     /// Get the map data at the given idxitiob
@@ -90,6 +152,28 @@ public:
     ArchivItem_Map& operator=(ArchivItem_Map&&) = delete;
 
 private:
-    ArchivItem_Map_Header* header_;
+    friend class MapView;
+
+    static unsigned getLayerBit(MapLayer type) { return 1u << static_cast<unsigned>(type); }
+    /// Number of present layers in the bitset
+    static unsigned getNumLayers(unsigned layerMask)
+    {
+        unsigned result = 0;
+        for(; layerMask; layerMask &= layerMask - 1u)
+            ++result;
+        return result;
+    }
+    /// Position of the layer in the data block, i.e. number of present layers before it
+    static unsigned getLayerIndex(unsigned layerMask, MapLayer type)
+    {
+        return getNumLayers(layerMask & (getLayerBit(type) - 1u));
+    }
+
+    std::unique_ptr<ArchivItem_Map_Header> header_;
+    unsigned numNodes_;
+    /// Bitset of present layers
+    unsigned layerMask_;
+    /// Present layers of numNodes_ entries each, in ascending order
+    CopyOnWrite<std::vector<uint8_t>> layerData_;
 };
 } // namespace libsiedler2
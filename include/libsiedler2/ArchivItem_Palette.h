@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <iosfwd>
+#include <memory>
 
 namespace libsiedler2 {
 
@@ -84,6 +85,8 @@ public:
         return colors == other.colors && transparentIdx == other.transparentIdx;
     }
     bool operator!=(const ArchivItem_Palette& other) const { return !(*this == other); }
+    /// Return a hash of the colors and transparency which is equal for palettes comparing equal
+    size_t getHash() const;
 
 protected:
     std::array<ColorRGB, 256> colors; //-V730_NOINIT
@@ -91,4 +94,10 @@ protected:
     /// comparison with another uint8_t (intended)
     uint16_t transparentIdx;
 };
+
+/// Return a shared, immutable palette equal to (including the name) the given one.
+/// Palettes are interned: As long as one is in use the same instance is returned for equal palettes
+std::shared_ptr<const ArchivItem_Palette> internPalette(const ArchivItem_Palette& palette);
+/// Same as the above but can reuse the passed palette if no equal one is in use
+std::shared_ptr<const ArchivItem_Palette> internPalette(std::unique_ptr<ArchivItem_Palette> palette);
 } // namespace libsiedler2
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ArchivItem.h"
+#include "CopyOnWrite.h"
 #include <cstdint>
 #include <iosfwd>
 #include <vector>
@@ -25,14 +26,16 @@ public:
 
     /// liefert die Daten zurück (ro).
     const std::vector<uint8_t>& getData() const;
-    /// liefert die Daten zurück (rw).
+    /// liefert die Daten zurück (rw). Creates a private copy if the data is shared with copies of this item
     std::vector<uint8_t>& getData();
+    /// True iff the data is shared with other items (e.g. copies of this one)
+    bool isDataShared() const { return data.isShared(); }
 
     /// löscht den Datenblock.
     void clear();
 
 private:
-    std::vector<uint8_t> data; /// Die Daten.
+    CopyOnWrite<std::vector<uint8_t>> data; /// Die Daten.
 };
 
 } // namespace libsiedler2
@@ -11,6 +11,8 @@
 #include <memory>
 
 namespace libsiedler2 {
+class SharedBytes;
+
 /// Klasse für Sounditems.
 class ArchivItem_Sound : public ArchivItem
 {
@@ -19,10 +21,13 @@ public:
     ~ArchivItem_Sound() override;
 
     /// liefert den Typ des Sounds.
-    SoundType getType() const;
+    SoundType getType() const { return soundType_; }
 
     /// lädt die Sound-Daten aus einer Datei.
     virtual int load(std::istream& file, uint32_t length) = 0;
+    /// Load the sound from the given bytes. Sounds which store their data unparsed reference the bytes instead of
+    /// copying them, all others read them like a file
+    virtual int loadShared(const SharedBytes& source);
 
     /// schreibt die Sound-Daten in eine Datei.
     virtual int write(std::ostream& file) const = 0;
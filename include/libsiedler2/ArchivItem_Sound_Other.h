@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ArchivItem_Sound.h"
+#include "SharedBytes.h"
 #include <cstdint>
 #include <vector>
 
@@ -13,11 +14,14 @@ namespace libsiedler2 {
 class ArchivItem_Sound_Other : public ArchivItem_Sound
 {
 public:
+    /// Throws std::invalid_argument for Wave, Midi and XMidi which are handled by their own classes
     explicit ArchivItem_Sound_Other(SoundType sndType);
     RTTR_CLONEABLE(ArchivItem_Sound_Other)
 
     /// lädt die Daten aus einer Datei.
     int load(std::istream& file, uint32_t length) override;
+    /// References the bytes instead of copying them
+    int loadShared(const SharedBytes& source) override;
 
     /// schreibt die Daten in eine Datei.
     int write(std::ostream& file) const override;
@@ -25,12 +29,14 @@ public:
     /// räumt den Soundspeicher auf.
     void clear();
 
-    const std::vector<uint8_t>& getData() const { return data; }
-    void setData(const std::vector<uint8_t>& newData) { data = newData; }
+    span<const uint8_t> getData() const { return data; }
+    void setData(std::vector<uint8_t> newData) { data = SharedBytes(std::move(newData)); }
+    void setData(SharedBytes newData) { data = std::move(newData); }
     uint32_t getLength() const { return static_cast<uint32_t>(data.size()); }
 
 protected:
-    std::vector<uint8_t> data;
+    /// Owned or a view into a mapped file
+    SharedBytes data;
 };
 
 } // namespace libsiedler2
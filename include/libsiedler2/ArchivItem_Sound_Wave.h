@@ -5,11 +5,15 @@
 #pragma once
 
 #include "ArchivItem_Sound.h"
+#include "SharedBytes.h"
 #include "WAV_Header.h"
 #include <cstdint>
 #include <vector>
 
 namespace libsiedler2 {
+class Archiv;
+struct PcmFormat;
+
 /// Klasse für WAVE-Sounds.
 class ArchivItem_Sound_Wave : public ArchivItem_Sound
 {
@@ -19,6 +23,8 @@ public:
 
     /// lädt die Wave-Daten aus einer Datei.
     int load(std::istream& file, uint32_t length) override;
+    /// References the samples instead of copying them
+    int loadShared(const SharedBytes& source) override;
 
     /// schreibt die Wave-Daten in eine Datei.
     int write(std::ostream& file) const override { return write(file, false); }
@@ -27,15 +33,31 @@ public:
     /// räumt den Soundspeicher auf.
     void clear();
 
-    const std::vector<uint8_t>& getData() const { return data; }
-    void setData(const std::vector<uint8_t>& data) { this->data = data; }
+    span<const uint8_t> getData() const { return data; }
+    void setData(std::vector<uint8_t> newData) { data = SharedBytes(std::move(newData)); }
+    void setData(SharedBytes newData) { data = std::move(newData); }
     const WAV_Header& getHeader() const { return header; }
     void setHeader(const WAV_Header& newHeader) { header = newHeader; }
     uint32_t getLength() { return static_cast<uint32_t>(data.size()); }
 
+    /// Convert the samples (8 or 16 bit PCM, mono or stereo) to the given rate and channels as floats in [-1, 1]
+    int convert(const PcmFormat& format, std::vector<float>& samples) const;
+    /// Convert the samples (8 or 16 bit PCM, mono or stereo) to the given rate and channels as 16 bit integers
+    int convert(const PcmFormat& format, std::vector<int16_t>& samples) const;
+
 protected:
+    /// Set the header for sounds stored without one (S2 effects)
+    void setHeaderlessFormat(uint32_t length);
+
     WAV_Header header; //-V730_NOINIT
-    std::vector<uint8_t> data;
+    /// Owned or a view into a mapped file
+    SharedBytes data;
 };
 
+/// Convert all wave sounds of the archive to float samples using up to numThreads threads (0 = number of cores).
+/// buffers[i] contains the samples of archiv[i] and is empty for other items.
+/// Returns the error of a failed sound, if any
+int convertAllWaves(const Archiv& archiv, const PcmFormat& format, std::vector<std::vector<float>>& buffers,
+                    unsigned numThreads = 0);
+
 } // namespace libsiedler2
@@ -9,15 +9,18 @@
 #include "XMIDI_Track.h"
 #include <array>
 #include <cstdint>
+#include <mutex>
 
 namespace libsiedler2 {
+class Archiv;
+
 /// Klasse für XMIDI-Sounds.
 class ArchivItem_Sound_XMidi : public ArchivItem_Sound
 {
-    bool isTrackConverted(uint16_t track) const;
-
 public:
     ArchivItem_Sound_XMidi();
+    ArchivItem_Sound_XMidi(const ArchivItem_Sound_XMidi& other);
+    ArchivItem_Sound_XMidi& operator=(const ArchivItem_Sound_XMidi&) = delete;
     RTTR_CLONEABLE(ArchivItem_Sound_XMidi)
 
     int load(std::istream& file, uint32_t length) override;
@@ -35,8 +38,10 @@ public:
             return &tracklist[track];
         return nullptr;
     }
-    const MIDI_Track& getMidiTrack(uint16_t trackIdx);
-    MIDI_Track getMidiTrack(uint16_t trackIdx) const;
+    /// Return the track converted to MIDI. It is converted on first access and cached. Thread-safe
+    const MIDI_Track& getMidiTrack(uint16_t trackIdx) const;
+    /// Convert all tracks not yet converted using up to numThreads threads (0 = number of cores)
+    void convertAllTracks(unsigned numThreads = 0) const;
     uint16_t getNumTracks() const { return numTracks; }
     uint16_t getPPQN() const { return ppqs; }
 
@@ -45,7 +50,17 @@ public:
 protected:
     uint16_t numTracks, ppqs;
     std::array<XMIDI_Track, 256> tracklist;    //-V730_NOINIT
-    std::array<MIDI_Track, 256> midiTracklist; //-V730_NOINIT
+    /// Converted tracks, guarded by midiMutex_
+    mutable std::array<MIDI_Track, 256> midiTracklist; //-V730_NOINIT
+    mutable std::mutex midiMutex_;
+
+private:
+    /// Check whether the track was already converted. The lock must hold midiMutex_
+    bool isTrackConverted(uint16_t track, const std::unique_lock<std::mutex>& lock) const;
 };
 
+/// Convert the tracks of all XMIDI items in the archive (recursively) using up to numThreads threads (0 = number of
+/// cores), so later calls to getMidiTrack are only lookups
+void convertAllXMidiTracks(const Archiv& archiv, unsigned numThreads = 0);
+
 } // namespace libsiedler2
@@ -0,0 +1,27 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "span.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Fast lossless compression of a block of bytes (LZ77 with byte-aligned tokens similar to LZ4).
+/// Runs of equal bytes become overlapping matches, so it also acts as a run-length encoding.
+/// The decompressed size is not stored and must be known by the caller.
+std::vector<uint8_t> compressBlock(span<const uint8_t> data);
+/// Upper bound for the decompressed size of a block of the given compressed size.
+/// Each byte can expand to at most 255 bytes (extension byte of a match length)
+constexpr size_t getMaxDecompressedSize(size_t compressedSize)
+{
+    return compressedSize * 255u;
+}
+/// Decompress a block created by compressBlock into @p output which must have the original size. Returns an ErrorCode
+int decompressBlock(span<const uint8_t> compressed, span<uint8_t> output);
+
+} // namespace libsiedler2
@@ -0,0 +1,101 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ImgDir.h"
+#include "PixelBufferBGRA.h"
+#include "PixelBufferPaletted.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace libsiedler2 {
+class ArchivItem_Bob;
+class ArchivItem_Palette;
+
+/// Creates sprites of a bob with the overlay (e.g. carried ware) already drawn over the body,
+/// so a figure can be drawn with a single blit.
+/// The sprites are trimmed to their visible area and kept in a LRU cache limited by a memory budget.
+/// Not thread-safe, but warmUp creates the sprites in parallel.
+class BobCompositor
+{
+public:
+    static constexpr uint16_t NO_OVERLAY = 0xFFFF;
+    /// Value of Key::plClrStartIdx for sprites keeping the player colors in a separate plane
+    static constexpr uint8_t SEPARATE_PLAYER_CLRS = 0xFF;
+
+    struct Key
+    {
+        bool fat;
+        ImgDir direction;
+        uint8_t animationstep;
+        /// Overlay drawn over the body (index as for ArchivItem_Bob::getOverlay) or NO_OVERLAY
+        uint16_t overlayIdx = NO_OVERLAY;
+        /// First palette index of the player color to draw or SEPARATE_PLAYER_CLRS
+        uint8_t plClrStartIdx = SEPARATE_PLAYER_CLRS;
+    };
+    struct Sprite
+    {
+        PixelBufferBGRA pixels;
+        /// Player color offset of each pixel or ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX.
+        /// Only set for SEPARATE_PLAYER_CLRS, player colored pixels are drawn with the default colors then
+        PixelBufferPaletted playerColors;
+        /// Draw offset, i.e. the sprite is drawn at (x - nx, y - ny)
+        int16_t nx, ny;
+
+        uint16_t getWidth() const { return pixels.getWidth(); }
+        uint16_t getHeight() const { return pixels.getHeight(); }
+        bool hasPlayerColors() const { return !playerColors.getPixels().empty(); }
+        /// Memory used by the pixels
+        size_t getMemorySize() const { return pixels.getSizeInBytes() + playerColors.getSizeInBytes(); }
+    };
+
+    /// Bob and palette must outlive the compositor.
+    /// memoryBudget is the maximum size of all cached sprites in bytes
+    BobCompositor(const ArchivItem_Bob& bob, const ArchivItem_Palette& palette, size_t memoryBudget);
+
+    /// Return the sprite for the key, creating it if it is not cached. nullptr if the body does not exist.
+    /// The sprite is valid until the next call to a non-const function
+    const Sprite* get(const Key& key);
+    /// Create the sprites for all keys not yet cached using numThreads threads (0 = number of cores).
+    /// If not all sprites fit into the memory budget, the ones of the first keys are kept and the remaining keys are
+    /// skipped. Returns an ErrorCode (of the first failing key)
+    int warmUp(const std::vector<Key>& keys, unsigned numThreads = 0);
+    /// Remove all cached sprites
+    void clear();
+
+    size_t getNumSprites() const { return sprites_.size(); }
+    /// Memory used by all cached sprites in bytes
+    size_t getMemoryUsage() const { return memoryUsage_; }
+    size_t getMemoryBudget() const { return memoryBudget_; }
+    /// Change the budget, removing the least recently used sprites if required
+    void setMemoryBudget(size_t memoryBudget);
+
+    /// Create the sprite for the key. Does not use the cache and may be called concurrently. Returns an ErrorCode
+    int compose(const Key& key, Sprite& sprite) const;
+
+private:
+    struct CacheEntry
+    {
+        uint64_t key;
+        Sprite sprite;
+    };
+    static uint64_t toId(const Key& key);
+    /// Add the sprite as the most recently used one
+    const Sprite* insert(uint64_t id, Sprite&& sprite);
+    /// Remove the least recently used sprites until the usage fits the budget
+    void evict(size_t budget);
+
+    const ArchivItem_Bob& bob_;
+    const ArchivItem_Palette& palette_;
+    size_t memoryBudget_;
+    size_t memoryUsage_ = 0;
+    /// Most recently used first
+    std::list<CacheEntry> sprites_;
+    std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> spriteMap_;
+};
+
+} // namespace libsiedler2
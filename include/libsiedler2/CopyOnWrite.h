@@ -0,0 +1,49 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+
+namespace libsiedler2 {
+
+/// Holds a value which may be shared with other instances (e.g. copies) until one of them modifies it.
+/// Copying is O(1), the first mutable access of a shared value creates a private copy ("detach").
+/// An empty (default constructed) value does not allocate.
+template<class T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() = default;
+    explicit CopyOnWrite(T value) : data_(std::make_shared<T>(std::move(value))) {}
+
+    /// Return the value for reading
+    const T& get() const { return data_ ? *data_ : getEmpty(); }
+    /// Return the value for modification. Detaches it first if it is shared
+    T& getMutable()
+    {
+        if(!data_)
+            data_ = std::make_shared<T>();
+        else if(data_.use_count() > 1)
+            data_ = std::make_shared<T>(*data_);
+        return *data_;
+    }
+    /// True iff the value is used by other instances too
+    bool isShared() const { return data_.use_count() > 1; }
+    /// True iff both use the same storage
+    bool isSharedWith(const CopyOnWrite& other) const { return data_ == other.data_; }
+    /// Release the value (might be shared) and become empty
+    void reset() { data_.reset(); }
+
+private:
+    static const T& getEmpty()
+    {
+        static const T empty{};
+        return empty;
+    }
+
+    std::shared_ptr<T> data_;
+};
+
+} // namespace libsiedler2
@@ -0,0 +1,72 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "CopyOnWrite.h"
+#include "PixelBufferPaletted.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace libsiedler2 {
+class Archiv;
+class ArchivItem;
+class ArchivItem_BitmapBase;
+
+/// Shares the pixel data (and player color data) of bitmaps with identical content.
+/// All bitmaps passed to the same context (e.g. every bitmap loaded while it is set via @p setDeduplicationContext)
+/// use a single buffer for the same pixel data. Modifying a bitmap afterwards creates a private copy of its data.
+/// The context keeps every buffer it has seen alive until it is cleared or destroyed.
+class DeduplicationContext
+{
+public:
+    struct Statistics
+    {
+        /// Number of bitmaps passed in
+        size_t numBitmaps = 0;
+        /// Number of bitmaps which now share (some of) their data with a previous one
+        size_t numShared = 0;
+        /// Number of distinct buffers
+        size_t numUniqueBuffers = 0;
+        /// Sum of the sizes of all buffers released because of sharing
+        size_t bytesSaved = 0;
+    };
+
+    DeduplicationContext() = default;
+    DeduplicationContext(const DeduplicationContext&) = delete;
+    DeduplicationContext& operator=(const DeduplicationContext&) = delete;
+
+    /// Share the pixel data of the bitmap with previously seen bitmaps if possible
+    void deduplicate(ArchivItem_BitmapBase& bitmap);
+    /// Deduplicate the item if it is a bitmap or all its bitmaps if it is a container (e.g. a bob or a font).
+    /// Only the already decoded images of a bob are handled (see ArchivItem_Bob::decodeAll)
+    void deduplicate(ArchivItem& item);
+    /// Deduplicate all (contained) bitmaps in the archive
+    void deduplicate(Archiv& archive);
+
+    Statistics getStatistics() const;
+    /// Release all buffers and reset the statistics. Already deduplicated bitmaps stay shared
+    void clear();
+
+    /// Hash used to find candidates for identical pixel data
+    static uint64_t getHash(const std::vector<uint8_t>& data);
+
+private:
+    template<class T>
+    using BufferMap = std::unordered_multimap<uint64_t, CopyOnWrite<T>>;
+
+    /// Replace the buffer by an identical one from the map or add it. Returns true iff the bitmap was shared
+    template<class T>
+    bool shareBuffer(CopyOnWrite<T>& buffer, BufferMap<T>& buffers);
+
+    mutable std::mutex mutex_;
+    BufferMap<std::vector<uint8_t>> buffers_;
+    BufferMap<PixelBufferPaletted> playerBuffers_;
+    Statistics stats_;
+};
+
+} // namespace libsiedler2
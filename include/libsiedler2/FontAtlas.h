@@ -0,0 +1,101 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "PixelBufferPaletted.h"
+#include "enumTypes.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace libsiedler2 {
+class ArchivItem_Font;
+class ArchivItem_Palette;
+
+/// Compiled form of an ArchivItem_Font for drawing text:
+/// All glyphs are packed into a single texture (atlas) and found via a two-level codepoint table,
+/// so measuring and laying out a text only needs table lookups and no access to the individual bitmaps.
+class FontAtlas
+{
+public:
+    struct Glyph
+    {
+        /// Position and size in the atlas
+        uint16_t texX, texY, width, height;
+        /// Offset of the bitmap from the pen position (-nx, -ny of the glyph bitmap)
+        int16_t offsetX, offsetY;
+        /// Distance to the next glyph (width + dx of the font)
+        uint16_t advance;
+    };
+    /// A glyph placed at a position relative to the origin (top left) of the text
+    struct GlyphQuad
+    {
+        int32_t x, y;
+        uint16_t texX, texY, width, height;
+    };
+    struct TextExtent
+    {
+        unsigned width, height, numLines;
+    };
+
+    FontAtlas();
+
+    /// Pack all glyphs of the font into an atlas of the given format and at most maxWidth pixels wide.
+    /// Glyphs of non-unicode fonts are indexed by their OEM char and mapped to unicode codepoints.
+    /// Player colors are stored as for ArchivItem_Bitmap_Player with plClrStartIdx as the default colors.
+    /// Returns an ErrorCode
+    int create(const ArchivItem_Font& font, TextureFormat format, const ArchivItem_Palette* palette = nullptr,
+               uint16_t maxWidth = 512, uint8_t plClrStartIdx = 128);
+    void clear();
+
+    /// Return the glyph for the codepoint or nullptr if the font does not contain it
+    const Glyph* getGlyph(uint32_t codepoint) const;
+    /// Return the glyph used to draw the codepoint, the fallback glyph ('?' or empty) if it does not exist
+    const Glyph& getDrawnGlyph(uint32_t codepoint) const { return glyphs_[getGlyphIdx(codepoint)]; }
+    size_t getNumGlyphs() const { return glyphs_.size() - 1u; }
+    /// Height of a line (Y spacing of the font)
+    unsigned getLineHeight() const { return lineHeight_; }
+
+    /// Return the size of the UTF-8 text. Width is the one of the widest line
+    TextExtent measure(std::string_view text) const;
+    /// Place the glyphs of the UTF-8 text starting at (0, 0), '\n' starts a new line. Returns the size of the text.
+    /// Glyphs without pixels (e.g. space) are skipped
+    TextExtent layout(std::string_view text, std::vector<GlyphQuad>& quads) const;
+
+    TextureFormat getFormat() const { return format_; }
+    uint16_t getWidth() const { return width_; }
+    uint16_t getHeight() const { return height_; }
+    /// Pixels in getFormat(), transparent where there are no glyphs
+    const std::vector<uint8_t>& getPixelData() const { return pixels_; }
+    bool hasPlayerColors() const { return !playerColors_.getPixels().empty(); }
+    /// Player color offset of each pixel or ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX.
+    /// Empty if the font has no player colors
+    const PixelBufferPaletted& getPlayerColors() const { return playerColors_; }
+
+private:
+    using Page = std::array<uint16_t, 256>;
+    void addCodepoint(uint32_t codepoint, uint16_t glyphIdx);
+    /// Index into glyphs_ (0 if not found)
+    uint16_t getGlyphIdx(uint32_t codepoint) const;
+    /// Call glyphFunc(glyphIdx) for each char of the UTF-8 text and newLineFunc() for each '\n'
+    template<class T_GlyphFunc, class T_NewLineFunc>
+    void forEachGlyph(std::string_view text, const T_GlyphFunc& glyphFunc, const T_NewLineFunc& newLineFunc) const;
+
+    TextureFormat format_;
+    uint16_t width_, height_;
+    unsigned lineHeight_;
+    std::vector<uint8_t> pixels_;
+    PixelBufferPaletted playerColors_;
+    /// Index 0 is the fallback glyph
+    std::vector<Glyph> glyphs_;
+    /// Glyph indices of ASCII chars for the fast path
+    std::array<uint16_t, 128> asciiGlyphs_;
+    /// Index into pages_ for each block of 256 codepoints. Page 0 is empty (all fallback)
+    std::vector<uint16_t> pageIdx_;
+    std::vector<Page> pages_;
+};
+
+} // namespace libsiedler2
@@ -5,7 +5,7 @@
 #pragma once
 
 #include "enumTypes.h"
-#include <boost/pointer_cast.hpp>
+#include "itemCast.h"
 #include <memory>
 
 namespace libsiedler2 {
@@ -22,7 +22,7 @@ public:
     template<class T>
     std::unique_ptr<T> create(BobType type, SoundType subtype = SoundType::None) const
     {
-        return boost::dynamic_pointer_cast<T>(create(type, subtype));
+        return item_cast<T>(create(type, subtype));
     }
 };
 
@@ -10,6 +10,14 @@
 
 namespace libsiedler2 {
 
+/// Cast the result of clone() to the type of the cloned object when a static_cast is not possible (e.g. virtual bases)
+/// Can be overloaded for specific base classes, found via ADL
+template<typename To, typename From>
+To* cloneCast(From* from, To*)
+{
+    return dynamic_cast<To*>(from);
+}
+
 namespace detail {
     template<typename T, typename U, typename = void>
     struct is_static_castable : std::false_type
@@ -31,7 +39,7 @@ namespace detail {
     template<typename To, typename From>
     std::enable_if_t<!is_static_castable_v<From*, To*>, To*> safePtrCast(From* from)
     {
-        return dynamic_cast<To*>(from);
+        return cloneCast(from, static_cast<To*>(nullptr));
     }
 } // namespace detail
 
@@ -0,0 +1,70 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "span.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace libsiedler2 {
+class MIDI_Track;
+class XMIDI_Track;
+class XMIDI_TrackConverter;
+
+/// Pull-style reader yielding the decoded events of a MIDI or XMIDI track in time order.
+/// Meant for sequencers which would otherwise have to parse the output of XMIDI_TrackConverter::CreateMidiTrack.
+/// The events of an XMIDI track are identical to the ones of its converted MIDI track.
+/// The track must outlive the reader and payloads are only valid as long as the reader exists.
+class MIDI_EventReader
+{
+public:
+    struct Event
+    {
+        /// Absolute time in ticks
+        uint32_t time = 0;
+        uint8_t status = 0;
+        /// Data bytes of channel messages, type of meta events (status 0xFF) in data[0]. Unused bytes are 0
+        std::array<uint8_t, 2> data{};
+        /// Data of SysEx and meta events
+        span<const uint8_t> payload;
+
+        bool isEndOfTrack() const { return status == 0xFF && data[0] == 0x2F; }
+    };
+
+    /// Read the events from a standard MIDI track ("MTrk" chunk)
+    explicit MIDI_EventReader(const MIDI_Track& track);
+    /// Convert the XMIDI track to a list of events without creating the MIDI data
+    explicit MIDI_EventReader(const XMIDI_Track& track);
+    MIDI_EventReader(MIDI_EventReader&&) noexcept;
+    MIDI_EventReader& operator=(MIDI_EventReader&&) noexcept;
+    ~MIDI_EventReader();
+
+    /// Get the next event. Returns false if there is none, i.e. the end-of-track event was already returned.
+    /// Throws std::runtime_error on malformed tracks
+    bool next(Event& event);
+    bool isDone() const { return done_; }
+
+private:
+    bool nextMidiEvent(Event& event);
+    bool nextXMidiEvent(Event& event);
+    uint32_t readVLQ();
+    uint8_t readByte();
+    span<const uint8_t> readPayload();
+    void setEndOfTrack(Event& event, uint32_t time);
+
+    /// Set when reading an XMIDI track
+    std::unique_ptr<XMIDI_TrackConverter> converter_;
+    size_t curEvent_ = 0;
+    /// MIDI data after the chunk header when reading a MIDI track
+    span<const uint8_t> data_;
+    size_t pos_ = 0;
+    uint8_t runningStatus_ = 0;
+    uint32_t curTime_ = 0;
+    bool done_ = false;
+};
+
+} // namespace libsiedler2
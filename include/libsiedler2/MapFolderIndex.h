@@ -0,0 +1,62 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ArchivItem_Map_Header.h"
+#include <boost/filesystem/path.hpp>
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Information from the header of a map file
+struct MapInfo
+{
+    boost::filesystem::path filePath;
+    /// Size and last modification time of the file when the header was read
+    uintmax_t fileSize = 0;
+    std::time_t lastWriteTime = 0;
+    /// Result of reading the header. All other fields are only valid if this is ErrorCode::NONE
+    int errorCode = 0;
+
+    std::string name, author;
+    uint16_t width = 0, height = 0;
+    uint8_t gfxSet = 0;
+    uint8_t numPlayers = 0;
+    std::array<uint16_t, ArchivItem_Map_Header::maxPlayers> hqX{}, hqY{};
+};
+
+/// Index of the headers of all maps (SWD/WLD) in a folder.
+/// Only headers of files not yet in the index or changed since (size or modification time) are read.
+/// The index can be stored on disk, so listing an unchanged folder only requires the file status of each map.
+class MapFolderIndex
+{
+public:
+    /// Load an index previously written by write(). Returns an ErrorCode
+    int load(const boost::filesystem::path& indexFilePath);
+    /// Write the index to a file. Returns an ErrorCode
+    int write(const boost::filesystem::path& indexFilePath) const;
+
+    /// Update the index to contain exactly the maps in the folder.
+    /// Headers are read using up to @p numThreads threads (0 = number of cores). Returns an ErrorCode
+    int scan(const boost::filesystem::path& folderPath, unsigned numThreads = 0);
+
+    /// Return all maps sorted by path
+    const std::vector<MapInfo>& getMaps() const { return maps_; }
+    /// Number of headers read by the last scan (i.e. maps which were not up to date in the index)
+    size_t getNumHeadersRead() const { return numHeadersRead_; }
+
+    /// Read the header of a single map file into @p info (without file size and time). Returns an ErrorCode
+    static int readMapInfo(const boost::filesystem::path& filePath, MapInfo& info);
+
+private:
+    std::vector<MapInfo> maps_;
+    size_t numHeadersRead_ = 0;
+};
+
+} // namespace libsiedler2
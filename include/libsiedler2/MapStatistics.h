@@ -0,0 +1,103 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ArchivItem_Map.h"
+#include "enumTypes.h"
+#include "span.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Number of nodes for each value of a layer
+using LayerHistogram = std::array<uint32_t, 256>;
+/// Weight of a node for each value of a layer
+using LayerWeights = std::array<uint8_t, 256>;
+
+/// Count all values of the layer
+LayerHistogram computeHistogram(span<const uint8_t> layer);
+/// Count the nodes with (value & mask) == maskedValue
+uint32_t countMasked(span<const uint8_t> layer, uint8_t mask, uint8_t maskedValue);
+/// Weights of 1 for values in [first, last] and 0 otherwise
+LayerWeights getRangeWeights(uint8_t first, uint8_t last);
+/// Weights giving the amount of the resource for the values of the resources layer
+LayerWeights getResourceWeights(Resource resource);
+
+/// Sums of the (weighted) values of a layer over rectangular or hexagonal regions of the map.
+/// A table of prefix sums is precomputed so rectangles are O(1) and hexagons O(radius).
+/// Regions wrap around the map borders like the map itself
+class SummedAreaTable
+{
+public:
+    SummedAreaTable() = default;
+    /// Create the table for the given layer of the map. Each node counts with weights[value]
+    SummedAreaTable(const ArchivItem_Map& map, MapLayer layer, const LayerWeights& weights);
+
+    uint16_t getWidth() const { return width_; }
+    uint16_t getHeight() const { return height_; }
+    /// Sum over the whole map
+    uint32_t getTotal() const { return table_.empty() ? 0u : table_.back(); }
+    /// Sum over the rectangle starting at x, y (including) with the given size (at most the map size)
+    uint32_t getSum(int x, int y, unsigned width, unsigned height) const;
+    /// Sum over all nodes with a distance of at most radius from x, y. Radius must be less than half the map size
+    uint32_t getHexSum(unsigned x, unsigned y, unsigned radius) const;
+
+private:
+    /// Sum over [x0, x1) x [y0, y1) without wrapping
+    uint32_t getSumNoWrap(unsigned x0, unsigned y0, unsigned x1, unsigned y1) const;
+
+    uint16_t width_ = 0, height_ = 0;
+    /// (width + 1) * (height + 1) sums of all nodes above and left of the entry
+    std::vector<uint32_t> table_;
+};
+
+/// Summary of the region around the HQ of a player
+struct PlayerRegionSummary
+{
+    /// Resources summed up in resourceAmounts
+    static constexpr std::array<Resource, 6> resources = {R_Water, R_Fish, R_Coal, R_Iron, R_Gold, R_Granite};
+
+    uint8_t player;
+    /// Position of the HQ, i.e. the center of the region
+    uint16_t hqX, hqY;
+    uint32_t numTrees, numStones;
+    /// Total amount of each resource in the region, same order as resources
+    std::array<uint32_t, resources.size()> resourceAmounts;
+
+    uint32_t getResourceAmount(Resource resource) const;
+};
+
+/// Summarize the hexagonal region with the given radius around the HQ of each player of the map.
+/// Players without a HQ on the map are skipped. Uses a SummedAreaTable per value, so the radius must be less than half
+/// the map size. Throws if the object type or resources layer does not exist
+std::vector<PlayerRegionSummary> computePlayerRegionSummaries(const ArchivItem_Map& map, unsigned radius);
+
+/// Statistics over all nodes of a map
+class MapStatistics
+{
+public:
+    explicit MapStatistics(const ArchivItem_Map& map);
+
+    /// Return the histogram of a layer. Throws if it does not exist
+    const LayerHistogram& getHistogram(MapLayer type) const;
+    bool hasHistogram(MapLayer type) const;
+
+    /// Number of nodes containing the resource
+    uint32_t getNumResourceNodes(Resource resource) const;
+    /// Total amount of the resource on the map
+    uint32_t getResourceAmount(Resource resource) const;
+    uint32_t getNumTrees() const;
+    uint32_t getNumStones() const;
+
+private:
+    uint32_t getSumInRange(MapLayer type, uint8_t first, uint8_t last) const;
+
+    unsigned layerMask_ = 0;
+    std::array<LayerHistogram, ArchivItem_Map::NUM_SWD_LAYERS> histograms_{};
+};
+
+} // namespace libsiedler2
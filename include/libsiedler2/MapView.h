@@ -0,0 +1,62 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ArchivItem_Map.h"
+#include "span.h"
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Read-only view of a map file (SWD/WLD).
+/// The file is memory mapped and the layers point directly into it, so opening a map does not copy layer data.
+/// The only exception is the first layer of maps with the extra word bug: Its last 2 bytes are missing in the file, so
+/// it is copied to provide it as one contiguous span.
+/// Use materialize() to get a (modifiable) ArchivItem_Map.
+class MapView
+{
+public:
+    MapView();
+    ~MapView();
+    MapView(MapView&&) noexcept;
+    MapView& operator=(MapView&&) noexcept;
+
+    /// Open the map file. Returns an ErrorCode
+    int open(const boost::filesystem::path& filepath);
+    /// Use the map file contents in memory. The data must outlive the view. Returns an ErrorCode
+    int open(span<const uint8_t> data);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    /// Return the map header
+    const ArchivItem_Map_Header& getHeader() const;
+    /// Number of nodes (width * height), i.e. size of each layer
+    unsigned getNumNodes() const { return numNodes_; }
+    /// Get a layer of the map. Throws if it does not exist
+    span<const uint8_t> getLayer(MapLayer type) const;
+    bool hasLayer(MapLayer type) const;
+    uint8_t getMapDataAt(MapLayer type, unsigned idx) const { return getLayer(type)[idx]; }
+    const std::vector<ArchivItem_Map::ExtraAnimalInfo>& getExtraInfo() const { return extraInfo_; }
+
+    /// Create a map owning a copy of the data
+    std::unique_ptr<ArchivItem_Map> materialize() const;
+
+private:
+    boost::iostreams::mapped_file_source file_;
+    std::unique_ptr<ArchivItem_Map_Header> header_;
+    unsigned numNodes_;
+    /// Start of each layer or nullptr if not present
+    std::array<const uint8_t*, ArchivItem_Map::NUM_SWD_LAYERS> layers_;
+    /// Patched copy of the first layer for maps with the extra word bug (see ArchivItem_Map::load), empty otherwise
+    std::vector<uint8_t> fixedFirstLayer_;
+    std::vector<ArchivItem_Map::ExtraAnimalInfo> extraInfo_;
+};
+
+} // namespace libsiedler2
@@ -0,0 +1,45 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ColorBGRA.h"
+#include "span.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace libsiedler2 {
+class ArchivItem_Map;
+class PixelBufferBGRA;
+
+/// Settings for rendering a minimap
+struct MinimapOptions
+{
+    /// Number of distinct terrain types. The upper bits of the terrain layers are flags (e.g. harbor)
+    static constexpr unsigned numTerrains = 0x40;
+
+    /// Color of each terrain type. A node gets the average color of both of its triangles
+    std::array<ColorBGRA, numTerrains> terrainColors{};
+    /// Brighten/darken the nodes according to the shadows layer or (if not present) the slope of the terrain
+    bool shadeAltitude = true;
+    /// Draw trees and granite in the given colors
+    bool drawObjects = true;
+    ColorBGRA treeColor = ColorBGRA(0x10, 0x40, 0x10, 0xFF);
+    ColorBGRA graniteColor = ColorBGRA(0x80, 0x80, 0x80, 0xFF);
+    /// Owner of each node: 0 = none, else player index + 1. Not stored in map files, so empty to not draw owners
+    span<const uint8_t> owners;
+    /// Colors of the players for owned nodes
+    std::vector<ColorBGRA> playerColors;
+    /// Weight of the player color when blending it with the terrain (0-256)
+    unsigned ownerAlpha = 128;
+    /// Number of threads rendering the rows (0 = number of cores)
+    unsigned numThreads = 0;
+};
+
+/// Render a minimap of the whole map scaled to the size of @p buffer (nearest node, odd rows shifted half a node).
+/// Returns an ErrorCode
+int renderMinimap(const ArchivItem_Map& map, PixelBufferBGRA& buffer, const MinimapOptions& options);
+
+} // namespace libsiedler2
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "SharedBytes.h"
 #include <boost/filesystem/path.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/iostreams/stream.hpp>
@@ -14,4 +15,6 @@ using MMStream = boost::iostreams::stream<boost::iostreams::mapped_file_source>;
 /// Open the given memory stream from a file and return an ErrorCode
 /// Writes exceptions to stderr
 int openMemoryStream(const boost::filesystem::path& filepath, MMStream& stream);
+/// Return the content of the opened stream. The mapping stays open as long as the result (or a sub view) exists
+SharedBytes getMappedData(MMStream& stream);
 } // namespace libsiedler2
@@ -0,0 +1,50 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "span.h"
+#include <cstdint>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Target format for converting PCM sounds. Samples are interleaved by channel
+struct PcmFormat
+{
+    uint32_t sampleRate = 48000;
+    /// 1 (mono) or 2 (stereo)
+    uint16_t numChannels = 2;
+};
+
+/// Convert float samples in [-1, 1] to 16 bit integers with rounding and clamping. out must hold in.size() samples
+void convertToInt16(span<const float> in, int16_t* out);
+
+/// Resamples a single channel by a rational factor using a polyphase windowed-sinc filter.
+/// The filter is stored per phase with consecutive taps, so each output sample is a plain dot product
+/// which the compiler can vectorize.
+class PolyphaseResampler
+{
+public:
+    /// Create the filter for converting from inRate to outRate using about 2*halfWidth input samples per output sample
+    PolyphaseResampler(uint32_t inRate, uint32_t outRate, unsigned halfWidth = 8);
+
+    /// Number of output samples for the given number of input samples
+    size_t getOutputSize(size_t inputSize) const;
+    /// Resample the input and append the result to output
+    void process(span<const float> input, std::vector<float>& output) const;
+
+    uint32_t getUpFactor() const { return upFactor_; }
+    uint32_t getDownFactor() const { return downFactor_; }
+    unsigned getNumTaps() const { return numTaps_; }
+
+private:
+    /// Output rate = input rate * upFactor_ / downFactor_ (reduced fraction)
+    uint32_t upFactor_, downFactor_;
+    unsigned numTaps_;
+    /// numTaps_ coefficients for each of the upFactor_ phases
+    std::vector<float> coefficients_;
+};
+
+} // namespace libsiedler2
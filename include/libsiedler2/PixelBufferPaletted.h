@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ArchivItem_Palette.h"
+#include "GetFormat.h"
 #include "PixelBuffer.h"
 #include <cstdint>
 
@@ -11,11 +11,13 @@
 namespace libsiedler2 {
 class ArchivItem_Palette;
 
+/// Reference to pixels stored elsewhere. Read-only if T_PixelType is const
 template<typename T_PixelType>
 class PixelBufferRefBase
 {
 public:
     using PixelType = T_PixelType;
+    using ByteType = std::conditional_t<std::is_const_v<PixelType>, const uint8_t, uint8_t>;
 
     PixelBufferRefBase(PixelType* buf, uint16_t width, uint16_t height) : pixels_(buf), width_(width), height_(height)
     {}
@@ -23,7 +25,7 @@ public:
     uint16_t getHeight() const { return height_; }
     uint32_t getSizeInBytes() const { return getNumPixels() * sizeof(PixelType); }
     uint32_t getNumPixels() const { return static_cast<uint32_t>(width_) * static_cast<uint32_t>(height_); }
-    uint8_t* getPixelPtr() { return reinterpret_cast<uint8_t*>(pixels_); }
+    ByteType* getPixelPtr() { return reinterpret_cast<ByteType*>(pixels_); }
     const uint8_t* getPixelPtr() const { return reinterpret_cast<const uint8_t*>(pixels_); }
     PixelType* getPixelPtr(uint32_t x, uint32_t y) { return &pixels_[calcIdx(x, y)]; }
     const PixelType* getPixelPtr(uint32_t x, uint32_t y) const { return &pixels_[calcIdx(x, y)]; }
@@ -39,16 +41,22 @@ private:
     uint16_t width_, height_;
 };
 
-using PixelBufferBGRARef = PixelBufferRefBase<uint32_t>;
-
-class PixelBufferPalettedRef : public PixelBufferRefBase<uint8_t>
+template<typename T_PixelType>
+class PixelBufferPalettedRefBase : public PixelBufferRefBase<T_PixelType>
 {
     const ArchivItem_Palette& pal_;
 
 public:
-    PixelBufferPalettedRef(PixelType* buf, uint16_t width, uint16_t height, const ArchivItem_Palette& pal)
-        : PixelBufferRefBase(buf, width, height), pal_(pal)
+    using PixelType = T_PixelType;
+
+    PixelBufferPalettedRefBase(PixelType* buf, uint16_t width, uint16_t height, const ArchivItem_Palette& pal)
+        : PixelBufferRefBase<T_PixelType>(buf, width, height), pal_(pal)
     {}
     const ArchivItem_Palette& getPalette() const { return pal_; }
 };
+
+using PixelBufferBGRARef = PixelBufferRefBase<uint32_t>;
+using PixelBufferBGRAConstRef = PixelBufferRefBase<const uint32_t>;
+using PixelBufferPalettedRef = PixelBufferPalettedRefBase<uint8_t>;
+using PixelBufferPalettedConstRef = PixelBufferPalettedRefBase<const uint8_t>;
 } // namespace libsiedler2
@@ -0,0 +1,61 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "span.h"
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Read-only bytes kept alive by a reference counted owner.
+/// The owner is either a buffer created from a vector or something external like a file mapping
+/// into which the bytes point. Copies and sub views share the owner and do not copy the bytes.
+class SharedBytes
+{
+public:
+    using iterator = span<const uint8_t>::iterator;
+
+    SharedBytes() = default;
+    /// Take ownership of the data
+    explicit SharedBytes(std::vector<uint8_t> data)
+    {
+        if(data.empty())
+            return;
+        auto buffer = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+        data_ = span<const uint8_t>(*buffer);
+        owner_ = std::move(buffer);
+    }
+    /// View of data which stays valid as long as owner exists
+    SharedBytes(std::shared_ptr<const void> owner, span<const uint8_t> data) : owner_(std::move(owner)), data_(data) {}
+
+    span<const uint8_t> get() const { return data_; }
+    operator span<const uint8_t>() const { return data_; }
+    const uint8_t* data() const { return data_.data(); }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+    iterator begin() const { return data_.begin(); }
+    iterator end() const { return data_.end(); }
+    const uint8_t& operator[](size_t idx) const { return data_[idx]; }
+    const uint8_t& back() const { return data_.back(); }
+
+    /// Return a view of a part of the data sharing the same owner
+    SharedBytes subView(size_t offset, size_t count) const
+    {
+        assert(offset + count <= size());
+        return SharedBytes(owner_, data_.subspan(offset, count));
+    }
+    /// True iff both use the same owner (e.g. point into the same mapped file)
+    bool isSharedWith(const SharedBytes& other) const { return owner_ && owner_ == other.owner_; }
+
+private:
+    std::shared_ptr<const void> owner_;
+    span<const uint8_t> data_;
+};
+
+} // namespace libsiedler2
@@ -0,0 +1,83 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "PcmConversion.h"
+#include "span.h"
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace libsiedler2 {
+class Archiv;
+
+/// Type of the samples in a sound bank
+enum class SampleFormat : uint16_t
+{
+    Int16,
+    Float32
+};
+
+/// Read-only sound bank file holding all sounds of an archive as PCM samples in a common format.
+/// Format (little endian): Header ("SBNK", version, sample format, number of entries),
+/// entry table (offset, frames, rate, channels) and the interleaved samples of each entry starting at a 16 byte
+/// aligned offset. The file is memory mapped, so the samples can be played directly from it.
+class SoundBank
+{
+public:
+    struct Entry
+    {
+        /// Offset of the first sample from the start of the file
+        uint32_t offset;
+        uint32_t numFrames;
+        uint32_t sampleRate;
+        uint16_t numChannels;
+    };
+
+    /// Alignment of the samples of each entry (relative to the start of the file)
+    static constexpr unsigned alignment = 16;
+
+    SoundBank();
+    ~SoundBank();
+    SoundBank(SoundBank&&) noexcept;
+    SoundBank& operator=(SoundBank&&) noexcept;
+
+    /// Convert the sounds of the archive and write them as a sound bank. Entry i holds archiv[i],
+    /// entries of items which are not wave sounds are empty. Returns an ErrorCode
+    static int write(std::ostream& file, const Archiv& archiv, const PcmFormat& format, SampleFormat sampleFormat,
+                     unsigned numThreads = 0);
+    static int write(const boost::filesystem::path& filepath, const Archiv& archiv, const PcmFormat& format,
+                     SampleFormat sampleFormat, unsigned numThreads = 0);
+
+    /// Open the sound bank file. Returns an ErrorCode
+    int open(const boost::filesystem::path& filepath);
+    /// Use the sound bank contents in memory. The data must be 16 byte aligned and outlive the bank.
+    /// Returns an ErrorCode
+    int open(span<const uint8_t> data);
+    void close();
+    bool isOpen() const { return !data_.empty(); }
+
+    SampleFormat getSampleFormat() const { return sampleFormat_; }
+    size_t getNumSounds() const { return entries_.size(); }
+    /// Get the entry at the given index. Throws if it does not exist
+    const Entry& getEntry(size_t idx) const;
+    /// Get the interleaved samples of an entry. Throws if the entry does not exist or has a different sample format
+    span<const int16_t> getSamplesInt16(size_t idx) const;
+    span<const float> getSamplesFloat(size_t idx) const;
+    /// The whole file
+    span<const uint8_t> getData() const { return data_; }
+
+private:
+    span<const uint8_t> getSampleData(size_t idx, SampleFormat sampleFormat) const;
+
+    boost::iostreams::mapped_file_source file_;
+    span<const uint8_t> data_;
+    SampleFormat sampleFormat_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace libsiedler2
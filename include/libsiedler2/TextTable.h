@@ -0,0 +1,57 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "span.h"
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libsiedler2 {
+class Archiv;
+
+/// All texts of a GER/ENG file converted to UTF-8 and stored in one contiguous buffer.
+/// Loading needs only a few allocations independent of the number of texts, unlike loading into an Archiv
+/// which creates an ArchivItem_Text per entry.
+class TextTable
+{
+public:
+    /// Load a GER/ENG file (or a plain text file as a single entry) like LoadTXT.
+    /// If conversion is true, the texts are in the OEM format of S2 (see OemTextToAnsi), else ANSI.
+    /// Returns an ErrorCode
+    int load(const boost::filesystem::path& filepath, bool conversion = true);
+    /// Load from the file contents in memory. Returns an ErrorCode
+    int load(span<const uint8_t> data, bool conversion = true);
+    void clear();
+
+    /// Number of entries including empty ones
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    /// Return true if the entry exists, i.e. it is not an empty slot of the file
+    bool hasText(size_t idx) const { return idx < entries_.size() && entries_[idx].offset != NO_TEXT; }
+    /// Return the text of an entry, an empty string if it does not exist. The text is followed by a NULL terminator
+    std::string_view getText(size_t idx) const;
+    std::string_view operator[](size_t idx) const { return getText(idx); }
+
+    /// Fill the archive with an ArchivItem_Text (ANSI) per existing entry, the same as loading the file would
+    void toArchiv(Archiv& items) const;
+
+private:
+    static constexpr uint32_t NO_TEXT = 0xFFFFFFFF;
+    struct Entry
+    {
+        uint32_t offset, length;
+    };
+
+    void addText(std::string_view text, bool conversion);
+
+    /// All texts, each followed by a NULL terminator
+    std::string buffer_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace libsiedler2
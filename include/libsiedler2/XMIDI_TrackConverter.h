@@ -13,8 +13,14 @@ namespace libsiedler2 {
 class MIDI_Track;
 class XMIDI_Track;
 
+/// Converts an XMIDI track to a standard MIDI track.
+/// Events are collected in creation order in a contiguous array and stable sorted by time once conversion is done.
+/// Payloads of system messages are stored in one shared buffer.
 class XMIDI_TrackConverter
 {
+    /// Reads the converted events directly
+    friend class MIDI_EventReader;
+
 private:
     struct MIDI_Event
     {
@@ -23,21 +29,30 @@ private:
 
         std::array<uint8_t, 2> data;
 
-        std::vector<uint8_t> buffer;
-        int duration;
-        MIDI_Event* next_note;
-        uint32_t note_time;
-        MIDI_Event* next;
-        MIDI_Event() : time(0), status(0), data(), duration(0), next_note(nullptr), note_time(0), next(nullptr) {}
+        /// Payload in sysexData
+        uint32_t bufferOffset;
+        uint32_t bufferSize;
+        MIDI_Event(int time = 0, uint8_t status = 0)
+            : time(time), status(status), data(), bufferOffset(0), bufferSize(0)
+        {}
     };
 
+    static constexpr int NO_EVENT = -1;
+
     struct first_state // Status,   Data[0]
     {
-        std::array<MIDI_Event*, 16> patch; // 0xC
-        std::array<MIDI_Event*, 16> bank;  // 0xB,      0
-        std::array<MIDI_Event*, 16> pan;   // 0xB,      7
-        std::array<MIDI_Event*, 16> vol;   // 0xB,      10
-        first_state() : patch(), bank(), pan(), vol() {}
+        // Index of the first event of each kind per channel or NO_EVENT
+        std::array<int, 16> patch; // 0xC
+        std::array<int, 16> bank;  // 0xB,      0
+        std::array<int, 16> pan;   // 0xB,      7
+        std::array<int, 16> vol;   // 0xB,      10
+        first_state()
+        {
+            patch.fill(NO_EVENT);
+            bank.fill(NO_EVENT);
+            pan.fill(NO_EVENT);
+            vol.fill(NO_EVENT);
+        }
     };
 
 public:
@@ -60,12 +75,14 @@ private:
     uint32_t GetVLQ2();
     static void PutVLQ(uint32_t value, std::vector<uint8_t>& outBuffer);
 
-    void CreateNewEvent(int time);
+    MIDI_Event& CreateNewEvent(int time);
+    /// Update first state entry to the event if it is the earliest one
+    void SetFirstState(int& firstEvent, int time) const;
 
     const XMIDI_Track& track;
-    MIDI_Event* events;
-    uint32_t numEvents;
-    MIDI_Event* curEvent;
+    /// All events, sorted by time after the conversion
+    std::vector<MIDI_Event> events;
+    std::vector<uint8_t> sysexData;
     size_t position;
 
     enum MidiStatus
@@ -0,0 +1,243 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ArchivItem.h"
+#include "ArchivItem_Sound.h"
+#include "enumTypes.h"
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+
+namespace libsiedler2 {
+class Archiv;
+class ArchivItem_BitmapBase;
+class ArchivItem_Bitmap_Player;
+class baseArchivItem_Bitmap;
+class baseArchivItem_Bitmap_RLE;
+class baseArchivItem_Bitmap_Raw;
+class baseArchivItem_Bitmap_Shadow;
+class ArchivItem_Bob;
+class ArchivItem_Font;
+class ArchivItem_Ini;
+class ArchivItem_Map;
+class ArchivItem_Map_Header;
+class ArchivItem_Palette;
+class ArchivItem_PaletteAnimation;
+class ArchivItem_Raw;
+class ArchivItem_Text;
+class ArchivItem_Sound_Midi;
+class ArchivItem_Sound_Other;
+class ArchivItem_Sound_Wave;
+class ArchivItem_Sound_XMidi;
+
+/// Describes which items can be of type T based on their type tags (BobType, SoundType)
+/// matches(item): False if the item cannot be a T
+/// isImplied: If true, every item for which matches() is true is a T (e.g. the loader relies on that)
+/// The default is used for types not known to the library: Every item might be one
+template<class T>
+struct ItemTypeTraits
+{
+    static constexpr bool isImplied = false;
+    static bool matches(const ArchivItem&) { return true; }
+};
+
+namespace detail {
+    template<bool T_isImplied, BobType... T_types>
+    struct BobTypeTraits
+    {
+        static constexpr bool isImplied = T_isImplied;
+        static bool matches(const ArchivItem& item)
+        {
+            const BobType type = item.getBobType();
+            return ((type == T_types) || ...);
+        }
+    };
+    template<SoundType T_type>
+    struct SoundTypeTraits
+    {
+        static constexpr bool isImplied = true;
+        static bool matches(const ArchivItem& item)
+        {
+            return item.getBobType() == BobType::Sound
+                   && static_cast<const ArchivItem_Sound&>(item).getType() == T_type;
+        }
+    };
+} // namespace detail
+
+template<>
+struct ItemTypeTraits<ArchivItem>
+{
+    static constexpr bool isImplied = true;
+    static bool matches(const ArchivItem&) { return true; }
+};
+template<>
+struct ItemTypeTraits<Archiv> : detail::BobTypeTraits<true, BobType::Bob>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_BitmapBase>
+    : detail::BobTypeTraits<true, BobType::BitmapRLE, BobType::BitmapPlayer, BobType::BitmapShadow, BobType::Bitmap>
+{};
+template<>
+struct ItemTypeTraits<baseArchivItem_Bitmap>
+    : detail::BobTypeTraits<true, BobType::BitmapRLE, BobType::BitmapShadow, BobType::Bitmap>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Bitmap_Player> : detail::BobTypeTraits<true, BobType::BitmapPlayer>
+{};
+template<>
+struct ItemTypeTraits<baseArchivItem_Bitmap_RLE> : detail::BobTypeTraits<true, BobType::BitmapRLE>
+{};
+template<>
+struct ItemTypeTraits<baseArchivItem_Bitmap_Raw> : detail::BobTypeTraits<true, BobType::Bitmap>
+{};
+template<>
+struct ItemTypeTraits<baseArchivItem_Bitmap_Shadow> : detail::BobTypeTraits<true, BobType::BitmapShadow>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Bob> : detail::BobTypeTraits<true, BobType::Bob>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Font> : detail::BobTypeTraits<true, BobType::Font>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Ini> : detail::BobTypeTraits<true, BobType::Ini>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Map> : detail::BobTypeTraits<true, BobType::Map>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Map_Header> : detail::BobTypeTraits<true, BobType::MapHeader>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Palette> : detail::BobTypeTraits<true, BobType::Palette>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_PaletteAnimation> : detail::BobTypeTraits<true, BobType::PaletteAnim>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Raw> : detail::BobTypeTraits<true, BobType::Raw>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Text> : detail::BobTypeTraits<true, BobType::Text>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Sound> : detail::BobTypeTraits<true, BobType::Sound>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Sound_Midi> : detail::SoundTypeTraits<SoundType::Midi>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Sound_Wave> : detail::SoundTypeTraits<SoundType::Wave>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Sound_XMidi> : detail::SoundTypeTraits<SoundType::XMidi>
+{};
+template<>
+struct ItemTypeTraits<ArchivItem_Sound_Other>
+{
+    static constexpr bool isImplied = true;
+    static bool matches(const ArchivItem& item)
+    {
+        if(item.getBobType() != BobType::Sound)
+            return false;
+        const SoundType type = static_cast<const ArchivItem_Sound&>(item).getType();
+        return type != SoundType::None && type != SoundType::Wave && type != SoundType::Midi
+               && type != SoundType::XMidi;
+    }
+};
+
+namespace detail {
+    /// dynamic_cast which remembers the offset of the result for the last seen dynamic type.
+    /// The offset is the same for all objects of the same type, so RTTI is only used when the type changes
+    template<class T>
+    const T* cachedDynamicCast(const ArchivItem& item)
+    {
+        struct Cache
+        {
+            const std::type_info* type = nullptr;
+            std::ptrdiff_t offset = 0;
+            bool isValid = false;
+        };
+        static thread_local Cache cache;
+
+        const std::type_info& type = typeid(item);
+        if(cache.type != &type)
+        {
+            const T* result = dynamic_cast<const T*>(&item);
+            cache.type = &type;
+            cache.isValid = result != nullptr;
+            if(result)
+                cache.offset = reinterpret_cast<const std::byte*>(result) - reinterpret_cast<const std::byte*>(&item);
+        }
+        if(!cache.isValid)
+            return nullptr;
+        const T* result = reinterpret_cast<const T*>(reinterpret_cast<const std::byte*>(&item) + cache.offset);
+        assert(result == dynamic_cast<const T*>(&item));
+        return result;
+    }
+} // namespace detail
+
+/// Checked cast of an item to a (derived) item type or Archiv. Returns nullptr if the item is not a T.
+/// Uses the type tags of the item to reject (and in most cases accept) the cast, so RTTI is only needed
+/// for classes which are not identified by their tag or can't be reached by a static_cast (virtual bases)
+template<class T>
+const T* item_cast(const ArchivItem* item)
+{
+    using Type = std::remove_const_t<T>;
+    using Traits = ItemTypeTraits<Type>;
+    if(!item || !Traits::matches(*item))
+        return nullptr;
+    if constexpr(Traits::isImplied && detail::is_static_castable_v<const ArchivItem*, const Type*>)
+    {
+        const auto* result = static_cast<const Type*>(item);
+        assert(result == dynamic_cast<const Type*>(item));
+        return result;
+    } else
+        return detail::cachedDynamicCast<Type>(*item);
+}
+
+template<class T>
+std::remove_const_t<T>* item_cast(ArchivItem* item)
+{
+    return const_cast<std::remove_const_t<T>*>(item_cast<T>(static_cast<const ArchivItem*>(item)));
+}
+
+/// Reference version. Throws std::bad_cast if the item is not a T
+template<class T>
+const T& item_cast(const ArchivItem& item)
+{
+    const auto* result = item_cast<T>(&item);
+    if(!result)
+        throw std::bad_cast();
+    return *result;
+}
+
+template<class T>
+std::remove_const_t<T>& item_cast(ArchivItem& item)
+{
+    return const_cast<std::remove_const_t<T>&>(item_cast<T>(static_cast<const ArchivItem&>(item)));
+}
+
+/// Cast the owned item. The item is destroyed if it is not a T
+template<class T>
+std::unique_ptr<T> item_cast(std::unique_ptr<ArchivItem> item)
+{
+    T* result = item_cast<T>(item.get());
+    if(result)
+        item.release();
+    return std::unique_ptr<T>(result);
+}
+
+/// Used by clone() for types with virtual base classes
+template<class To>
+To* cloneCast(ArchivItem* from, To*)
+{
+    return item_cast<To>(from);
+}
+
+} // namespace libsiedler2
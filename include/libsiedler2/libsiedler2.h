@@ -14,6 +14,7 @@ namespace libsiedler2 {
 // Fwd decl
 class Archiv;
 class ArchivItem_Palette;
+class DeduplicationContext;
 class IAllocator;
 
 /// Setzt das verwendete Texturausgabeformat.
@@ -21,10 +22,36 @@ TextureFormat setGlobalTextureFormat(TextureFormat format);
 /// liefert das verwendete Texturausgabeformat.
 TextureFormat getGlobalTextureFormat();
 
+/// Return the allocator used for creating items by the current thread
 const IAllocator& getAllocator();
 /// Setzt den Item-Allocator.
 void setAllocator(IAllocator* newAllocator);
 
+/// Use the given allocator for all items created by the current thread (e.g. via Load) during the lifetime of this
+/// object instead of the global one. The allocator must outlive the scope, scopes can be nested.
+class AllocatorScope
+{
+public:
+    explicit AllocatorScope(const IAllocator& allocator);
+    AllocatorScope(const AllocatorScope&) = delete;
+    AllocatorScope& operator=(const AllocatorScope&) = delete;
+    ~AllocatorScope();
+
+private:
+    const IAllocator* prevAllocator_;
+};
+
+/// Set the context used to share identical pixel data of loaded bitmaps (nullptr to disable, the default).
+/// The context is not owned and must outlive its usage. Returns the previous context
+DeduplicationContext* setDeduplicationContext(DeduplicationContext* context);
+/// Return the context set by setDeduplicationContext or nullptr
+DeduplicationContext* getDeduplicationContext();
+/// Let wave and other unparsed sounds loaded from LST, DAT/IDX and sound files reference the memory mapped file
+/// instead of copying their data (off by default). The file stays mapped as long as any of its sounds exists.
+/// Returns the previous setting
+bool setSoundDataMapping(bool enable);
+bool getSoundDataMapping();
+
 /// Lädt die Datei im Format ihrer Endung.
 int Load(const boost::filesystem::path& filepath, Archiv& items, const ArchivItem_Palette* palette = nullptr);
 /// Schreibt die Datei im Format ihrer Endung.
@@ -5,11 +5,40 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 namespace libsiedler2 {
 /// Wandelt einen String vom ANSI ins OEM Format um.
-std::string AnsiToOem(const std::string& from);
+std::string AnsiToOem(std::string_view from);
 
 /// Wandelt einen String vom OEM ins ANSI Format um.
-std::string OemToAnsi(const std::string& from);
+std::string OemToAnsi(std::string_view from);
+
+/// Convert a string from OEM to UTF-8. Same as converting it to ANSI (Windows-1252) and from there to UTF-8,
+/// except that chars without an ANSI counterpart become their code page 437 char instead of NULL
+std::string OemToUtf8(std::string_view from);
+
+/// Convert a string from ANSI (Windows-1252) to UTF-8
+std::string AnsiToUtf8(std::string_view from);
+
+/// Convert a string from UTF-8 to ANSI (Windows-1252). Chars not in Windows-1252 or invalid sequences become '?'
+std::string Utf8ToAnsi(std::string_view from);
+
+/// Convert a text from the OEM format of S2 text files to ANSI in a single pass:
+/// Characters are converted like OemToAnsi, "@@" and "\r" become "\n"
+std::string OemTextToAnsi(std::string_view from);
+
+/// Convert a text to the OEM format of S2 text files in a single pass:
+/// Characters are converted like AnsiToOem, "\n" becomes "@@"
+std::string AnsiTextToOem(std::string_view from);
+
+/// Replace "\r\n" and single "\r" by "\n" in a single pass
+std::string normalizeLineBreaks(std::string_view from);
+
+/// Convert a text from the OEM format of S2 text files to UTF-8 in a single pass (like OemTextToAnsi + OemToUtf8)
+/// and append it to @p to
+void appendOemTextAsUtf8(std::string_view from, std::string& to);
+
+/// Convert an ANSI text to UTF-8 and normalize its line breaks in a single pass and append it to @p to
+void appendAnsiTextAsUtf8(std::string_view from, std::string& to);
 } // namespace libsiedler2
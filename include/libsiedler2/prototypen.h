@@ -13,12 +13,14 @@ namespace libsiedler2 {
 class ArchivItem_Palette;
 class ArchivItem;
 class Archiv;
+class SharedBytes;
 
 /// Die verschiedenen Lade-/Schreibfunktionen der Dateien
 namespace loader {
     /// lädt eine spezifizierten Bobtype aus einer Datei in ein ArchivItem.
+    /// If given, fileData is the content of the whole stream and sounds may reference it instead of copying
     int LoadType(BobType bobtype, std::istream& lst, std::unique_ptr<ArchivItem>& item,
-                 const ArchivItem_Palette* palette = nullptr);
+                 const ArchivItem_Palette* palette = nullptr, const SharedBytes* fileData = nullptr);
 
     /// schreibt eine spezifizierten Bobtype aus einem ArchivItem in eine Datei.
     int WriteType(BobType bobtype, std::ostream& lst, const ArchivItem& item,
@@ -87,6 +89,12 @@ namespace loader {
 #define WriteSWD WriteMAP
 #define WriteWSD WriteMAP
 
+    /// load a compressed map (SWZ, see ArchivItem_Map::writeCompressed) into the archive.
+    int LoadSWZ(const boost::filesystem::path& filepath, Archiv& items);
+
+    /// write the map in the archive into a compressed map file (SWZ).
+    int WriteSWZ(const boost::filesystem::path& filepath, const Archiv& items);
+
     /// lädt eine BOB-File in ein Archiv.
     int LoadBOB(const boost::filesystem::path& filepath, Archiv& items, const ArchivItem_Palette* palette);
 
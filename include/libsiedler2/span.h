@@ -0,0 +1,71 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace libsiedler2 {
+
+/// Non-owning view of a contiguous sequence of elements.
+/// Subset of C++20 std::span (dynamic extent only) so it can be replaced once we require C++20
+template<class T>
+class span
+{
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using pointer = T*;
+    using reference = T&;
+    using iterator = T*;
+
+    constexpr span() noexcept = default;
+    constexpr span(T* data, size_type size) noexcept : data_(data), size_(size) {}
+    /// Conversion from span<U> if U* converts to T* without slicing (e.g. span<uint8_t> to span<const uint8_t>)
+    template<class U, std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>, int> = 0>
+    constexpr span(const span<U>& other) noexcept : data_(other.data()), size_(other.size())
+    {}
+    /// View of a contiguous container (e.g. std::vector or std::array)
+    template<class T_Container,
+             class T_Elem = std::remove_pointer_t<decltype(std::declval<T_Container&>().data())>,
+             std::enable_if_t<std::is_convertible_v<T_Elem (*)[], T (*)[]>, int> = 0>
+    constexpr span(T_Container& container) noexcept : data_(container.data()), size_(container.size())
+    {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_type size() const noexcept { return size_; }
+    constexpr size_type size_bytes() const noexcept { return size_ * sizeof(T); }
+    constexpr bool empty() const noexcept { return size_ == 0u; }
+
+    constexpr T& operator[](size_type idx) const
+    {
+        assert(idx < size_);
+        return data_[idx];
+    }
+    constexpr T& front() const { return (*this)[0]; }
+    constexpr T& back() const { return (*this)[size_ - 1u]; }
+    constexpr iterator begin() const noexcept { return data_; }
+    constexpr iterator end() const noexcept { return data_ + size_; }
+
+    constexpr span first(size_type count) const
+    {
+        assert(count <= size_);
+        return span(data_, count);
+    }
+    constexpr span subspan(size_type offset, size_type count) const
+    {
+        assert(offset <= size_ && count <= size_ - offset);
+        return span(data_ + offset, count);
+    }
+
+private:
+    T* data_ = nullptr;
+    size_type size_ = 0;
+};
+
+} // namespace libsiedler2
@@ -118,7 +118,7 @@ void Archiv::pushC(const ArchivItem& item)
     data.emplace_back(clone(item));
 }
 
-const ArchivItem* Archiv::find(const std::string& name) const
+const ArchivItem* Archiv::find(std::string_view name) const
 {
     for(const auto& it : data)
     {
@@ -129,7 +129,7 @@ const ArchivItem* Archiv::find(const std::string& name) const
     return nullptr;
 }
 
-ArchivItem* Archiv::find(const std::string& name)
+ArchivItem* Archiv::find(std::string_view name)
 {
     for(auto& it : data)
     {
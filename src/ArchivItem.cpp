@@ -3,7 +3,74 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "ArchivItem.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
-libsiedler2::ArchivItem::ArchivItem(BobType bobtype) : bobtype_(bobtype), name_("untitled") {}
+namespace {
+using NamePtr = std::shared_ptr<const std::string>;
+
+/// Table of all names currently used by items
+struct NameTable
+{
+    std::mutex mutex;
+    /// Key views the string owned by the value
+    std::unordered_map<std::string_view, std::weak_ptr<const std::string>> names;
+};
+
+NameTable& getNameTable()
+{
+    // Never destroyed as items might be destroyed during static destruction
+    static auto* table = new NameTable;
+    return *table;
+}
+
+/// Remove the name from the table when the last item using it is gone
+void releaseName(const std::string* name)
+{
+    NameTable& table = getNameTable();
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        const auto it = table.names.find(*name);
+        // It might have been replaced already if it got interned again in between
+        if(it != table.names.end() && it->first.data() == name->data())
+            table.names.erase(it);
+    }
+    delete name;
+}
+
+/// Return a shared copy of the given name. Items with equal names share it, so copying items never allocates.
+/// Names are released when no item uses them anymore
+NamePtr internName(std::string_view name)
+{
+    NameTable& table = getNameTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    const auto it = table.names.find(name);
+    if(it != table.names.end())
+    {
+        if(NamePtr result = it->second.lock())
+            return result;
+        // Expired but not yet released, replace it so the key views the new string
+        table.names.erase(it);
+    }
+    NamePtr result(new std::string(name), releaseName);
+    table.names.emplace(*result, result);
+    return result;
+}
+
+const NamePtr& getDefaultName()
+{
+    // Kept alive forever as most items use it
+    static const auto* const name = new NamePtr(internName("untitled"));
+    return *name;
+}
+} // namespace
+
+libsiedler2::ArchivItem::ArchivItem(BobType bobtype) : bobtype_(bobtype), name_(getDefaultName()) {}
 
 libsiedler2::ArchivItem::~ArchivItem() = default;
+
+void libsiedler2::ArchivItem::setName(std::string_view name)
+{
+    name_ = internName(name);
+}
@@ -55,11 +55,11 @@ int baseArchivItem_Bitmap::print(uint8_t* buffer, uint16_t buffer_width, uint16_
     auto doCall = [this, fromRect, toRect](auto&& dstBuf) {
         if(this->getFormat() == TextureFormat::Paletted)
         {
-            const PixelBufferPalettedRef srcBuf = this->getBufferPaletted();
+            const PixelBufferPalettedConstRef srcBuf = this->getBufferPaletted();
             CopyPixelBuffer(srcBuf, dstBuf, fromRect, toRect);
         } else
         {
-            const PixelBufferBGRARef srcBuf = this->getBufferARGB();
+            const PixelBufferBGRAConstRef srcBuf = this->getBufferARGB();
             CopyPixelBuffer(srcBuf, dstBuf, fromRect, toRect);
         }
     };
@@ -31,9 +31,7 @@ ArchivItem_BitmapBase::ArchivItem_BitmapBase(const ArchivItem_BitmapBase& item)
 
     pxlData_ = item.pxlData_;
 
-    palette_ = nullptr;
-    if(item.palette_)
-        setPaletteCopy(*item.palette_);
+    palette_ = item.palette_;
     format_ = item.format_;
 }
 
@@ -137,39 +135,54 @@ ColorBGRA ArchivItem_BitmapBase::getPixel(uint16_t x, uint16_t y) const
 
 uint8_t* ArchivItem_BitmapBase::getPixelPtr(uint16_t x, uint16_t y)
 {
-    return &pxlData_[(y * width_ + x) * getBBP()];
+    return &getPixelData()[(y * width_ + x) * getBBP()];
 }
 
 const uint8_t* ArchivItem_BitmapBase::getPixelPtr(uint16_t x, uint16_t y) const
 {
-    return &pxlData_[(y * width_ + x) * getBBP()];
+    return &getPixelData()[(y * width_ + x) * getBBP()];
 }
 
 uint8_t ArchivItem_BitmapBase::getPalettedPixel(uint16_t x, uint16_t y) const
 {
     assert(format_ == TextureFormat::Paletted);
-    return pxlData_[y * width_ + x];
+    return getPixelData()[y * width_ + x];
 }
 
 ColorBGRA ArchivItem_BitmapBase::getARGBPixel(uint16_t x, uint16_t y) const
 {
     assert(format_ == TextureFormat::BGRA);
-    return ColorBGRA::fromBGRA(&pxlData_[(y * width_ + x) * 4u]);
+    return ColorBGRA::fromBGRA(&getPixelData()[(y * width_ + x) * 4u]);
 }
 
-PixelBufferPalettedRef ArchivItem_BitmapBase::getBufferPaletted() const
+PixelBufferPalettedConstRef ArchivItem_BitmapBase::getBufferPaletted() const
 {
     if(getFormat() != TextureFormat::Paletted)
         throw std::logic_error("Image not paletted");
     assert(palette_);
-    return PixelBufferPalettedRef(const_cast<uint8_t*>(pxlData_.data()), width_, height_, *palette_);
+    return PixelBufferPalettedConstRef(getPixelData().data(), width_, height_, *palette_);
 }
 
-PixelBufferBGRARef ArchivItem_BitmapBase::getBufferARGB() const
+PixelBufferBGRAConstRef ArchivItem_BitmapBase::getBufferARGB() const
 {
     if(getFormat() != TextureFormat::BGRA)
         throw std::logic_error("Image not BGRA");
-    return PixelBufferBGRARef(reinterpret_cast<uint32_t*>(const_cast<uint8_t*>(pxlData_.data())), width_, height_);
+    return PixelBufferBGRAConstRef(reinterpret_cast<const uint32_t*>(getPixelData().data()), width_, height_);
+}
+
+PixelBufferPalettedRef ArchivItem_BitmapBase::getBufferPaletted()
+{
+    if(getFormat() != TextureFormat::Paletted)
+        throw std::logic_error("Image not paletted");
+    assert(palette_);
+    return PixelBufferPalettedRef(getPixelData().data(), width_, height_, *palette_);
+}
+
+PixelBufferBGRARef ArchivItem_BitmapBase::getBufferARGB()
+{
+    if(getFormat() != TextureFormat::BGRA)
+        throw std::logic_error("Image not BGRA");
+    return PixelBufferBGRARef(reinterpret_cast<uint32_t*>(getPixelData().data()), width_, height_);
 }
 
 TextureFormat ArchivItem_BitmapBase::getWantedFormat(TextureFormat origFormat)
@@ -202,7 +215,8 @@ void ArchivItem_BitmapBase::init(int16_t width, int16_t height, TextureFormat fo
 
     uint8_t clear = (format == TextureFormat::Paletted) ? palette_->getTransparentIdx() : 0; //-V522
 
-    pxlData_.resize(width_ * height_ * getBBP(), clear);
+    // Always use new storage as the old one might be shared
+    pxlData_ = CopyOnWrite<std::vector<uint8_t>>(std::vector<uint8_t>(width_ * height_ * getBBP(), clear));
 }
 
 void ArchivItem_BitmapBase::init(int16_t width, int16_t height, TextureFormat format, const ArchivItem_Palette* newPal)
@@ -226,7 +240,7 @@ void ArchivItem_BitmapBase::clear()
 {
     width_ = 0;
     height_ = 0;
-    pxlData_.clear();
+    pxlData_.reset();
 }
 
 /**
@@ -285,7 +299,8 @@ int ArchivItem_BitmapBase::convertFormat(TextureFormat newFormat)
             for(unsigned x = 0; x < width_; x++)
                 newBuffer.set(x, y, getPixel(x, y));
         }
-        pxlData_.assign(newBuffer.getPixelPtr(), newBuffer.getPixelPtr() + newBuffer.getSizeInBytes());
+        pxlData_ = CopyOnWrite<std::vector<uint8_t>>(
+          std::vector<uint8_t>(newBuffer.getPixelPtr(), newBuffer.getPixelPtr() + newBuffer.getSizeInBytes()));
     } else
     {
         PixelBufferPaletted newBuffer(width_, height_);
@@ -297,7 +312,8 @@ int ArchivItem_BitmapBase::convertFormat(TextureFormat newFormat)
                 newBuffer.set(x, y, clr.getAlpha() == 0 ? palette_->getTransparentIdx() : palette_->lookup(clr));
             }
         }
-        pxlData_.assign(newBuffer.getPixelPtr(), newBuffer.getPixelPtr() + newBuffer.getSizeInBytes());
+        pxlData_ = CopyOnWrite<std::vector<uint8_t>>(
+          std::vector<uint8_t>(newBuffer.getPixelPtr(), newBuffer.getPixelPtr() + newBuffer.getSizeInBytes()));
     }
     format_ = newFormat;
     return ErrorCode::NONE;
@@ -352,21 +368,26 @@ bool ArchivItem_BitmapBase::checkPalette(const ArchivItem_Palette& palette) cons
  */
 void ArchivItem_BitmapBase::setPalette(std::unique_ptr<ArchivItem_Palette> palette)
 {
-    if(!palette && format_ == TextureFormat::Paletted)
-        throw std::runtime_error("Cannot remove palette from paletted image");
-    palette_ = std::move(palette);
+    setSharedPalette(internPalette(std::move(palette)));
 }
 
 void ArchivItem_BitmapBase::setPaletteCopy(const ArchivItem_Palette& palette)
 {
     if(palette_.get() == &palette)
         return; // Optimization for setting self palette
-    setPalette(libsiedler2::clone(palette));
+    setSharedPalette(internPalette(palette));
+}
+
+void ArchivItem_BitmapBase::setSharedPalette(std::shared_ptr<const ArchivItem_Palette> palette)
+{
+    if(!palette && format_ == TextureFormat::Paletted)
+        throw std::runtime_error("Cannot remove palette from paletted image");
+    palette_ = std::move(palette);
 }
 
 void ArchivItem_BitmapBase::removePalette()
 {
-    setPalette(nullptr);
+    setSharedPalette(nullptr);
 }
 
 } // namespace libsiedler2
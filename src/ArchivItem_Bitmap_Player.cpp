@@ -117,6 +117,7 @@ int ArchivItem_Bitmap_Player::load(uint16_t width, const std::vector<uint8_t>& i
     // Speicher anlegen
     const unsigned height = starts.size();
     init(width, height, getWantedFormat(TextureFormat::Paletted), palette);
+    PixelBufferPaletted& plClrData = tex_pdata.getMutable();
 
     if(image.empty())
         return ErrorCode::NONE;
@@ -157,7 +158,7 @@ int ArchivItem_Bitmap_Player::load(uint16_t width, const std::vector<uint8_t>& i
                 // Spielerfarbe Pixel setzen
                 for(uint8_t i = 0; i < shift; ++i, ++x)
                 {
-                    tex_pdata.set(x, y, image[position]);
+                    plClrData.set(x, y, image[position]);
                     setPixel(x, y, image[position] + 128);
                 }
                 ++position;
@@ -280,7 +281,8 @@ void ArchivItem_Bitmap_Player::init(int16_t width, int16_t height, TextureFormat
 {
     ArchivItem_BitmapBase::init(width, height, format);
 
-    tex_pdata = PixelBufferPaletted(getWidth(), getHeight(), TRANSPARENT_PLAYER_CLR_IDX);
+    tex_pdata = CopyOnWrite<PixelBufferPaletted>(
+      PixelBufferPaletted(getWidth(), getHeight(), TRANSPARENT_PLAYER_CLR_IDX));
 }
 
 /**
@@ -289,7 +291,7 @@ void ArchivItem_Bitmap_Player::init(int16_t width, int16_t height, TextureFormat
 void ArchivItem_Bitmap_Player::clear()
 {
     ArchivItem_BitmapBase::clear();
-    tex_pdata.clear();
+    tex_pdata.reset();
 }
 
 /**
@@ -326,6 +328,7 @@ int ArchivItem_Bitmap_Player::create(uint16_t width, uint16_t height, const uint
 
     // Texturspeicher anfordern
     init(width, height, buffer_format, buffer_format == TextureFormat::BGRA ? nullptr : palette);
+    PixelBufferPaletted& plClrData = tex_pdata.getMutable();
 
     const unsigned bpp = getBBP(buffer_format);
 
@@ -342,7 +345,7 @@ int ArchivItem_Bitmap_Player::create(uint16_t width, uint16_t height, const uint
                 {
                     uint8_t c = palette->lookup(clr);
                     if(c >= plClrStartIdx && c <= plClrStartIdx + numPlayerClrs - 1) // Spielerfarbe
-                        tex_pdata.set(x, y, c - plClrStartIdx);
+                        plClrData.set(x, y, c - plClrStartIdx);
                 }
                 clr.toBGRA(getPixelPtr(x, y));
             } else
@@ -350,7 +353,7 @@ int ArchivItem_Bitmap_Player::create(uint16_t width, uint16_t height, const uint
                 uint8_t c = buffer[posBuffer];
                 if(c >= plClrStartIdx && c <= plClrStartIdx + numPlayerClrs - 1) // Spielerfarbe
                 {
-                    tex_pdata.set(x, y, c - plClrStartIdx);
+                    plClrData.set(x, y, c - plClrStartIdx);
                     c = palette->getTransparentIdx();
                 }
                 *getPixelPtr(x, y) = c;
@@ -416,11 +419,11 @@ int ArchivItem_Bitmap_Player::print(uint8_t* buffer, uint16_t buffer_width, uint
         auto doCall = [this, fromRect, toRect](auto&& dstBuf) {
             if(this->getFormat() == TextureFormat::Paletted)
             {
-                const PixelBufferPalettedRef srcBuf = this->getBufferPaletted();
+                const PixelBufferPalettedConstRef srcBuf = this->getBufferPaletted();
                 CopyPixelBuffer(srcBuf, dstBuf, fromRect, toRect);
             } else
             {
-                const PixelBufferBGRARef srcBuf = this->getBufferARGB();
+                const PixelBufferBGRAConstRef srcBuf = this->getBufferARGB();
                 CopyPixelBuffer(srcBuf, dstBuf, fromRect, toRect);
             }
         };
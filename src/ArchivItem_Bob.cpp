@@ -4,13 +4,17 @@
 
 #include "ArchivItem_Bob.h"
 #include "ArchivItem_Bitmap_Player.h"
+#include "ArchivItem_Palette.h"
+#include "ColorBGRA.h"
 #include "ErrorCodes.h"
 #include "IAllocator.h"
+#include "itemCast.h"
 #include "libsiedler2.h"
 #include "loadMapping.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include "s25util/StringConversion.h"
 #include <boost/range/adaptor/indexed.hpp>
+#include <algorithm>
 #include <iostream>
 #include <limits>
 
@@ -24,6 +28,8 @@ constexpr unsigned NUM_LINKS_PER_OVERLAY = 8 * 2 * 6;
 constexpr uint16_t SPRITE_WIDTH = 32;
 /// Draw offset in X
 constexpr uint16_t X_OFFSET = 16;
+/// Marks overlay images which are not linked and hence not decoded
+constexpr uint8_t NO_COLOR_BLOCK = 0xFF;
 } // namespace
 
 namespace libsiedler2 {
@@ -60,6 +66,56 @@ static int readImageData(libendian::EndianIStreamAdapter<false, std::istream&>&
     return ErrorCode::NONE;
 }
 
+/// Call func(x, y, colorIdx, isPlayerClr) for each non-transparent pixel of an image compressed into a color block.
+/// For player colors colorIdx is the offset to the first player color
+template<class T_Func>
+static int forEachPixel(const std::vector<uint8_t>& colorBlock, const std::vector<uint16_t>& starts, T_Func&& func)
+{
+    if(colorBlock.empty())
+        return ErrorCode::NONE;
+    for(uint16_t y = 0; y < starts.size(); ++y)
+    {
+        size_t position = starts[y];
+        // Read line till x is full
+        for(uint16_t x = 0; x < SPRITE_WIDTH;)
+        {
+            if(position >= colorBlock.size())
+                return ErrorCode::UNEXPECTED_EOF;
+            const uint8_t shift = colorBlock[position++];
+            const uint8_t count = std::min<uint8_t>(shift & 0x3F, SPRITE_WIDTH - x);
+            if(shift < 0x40)
+            {
+                // Transparent
+            } else if(shift < 0x80)
+            {
+                // Colored pixels
+                if(position + (shift & 0x3F) > colorBlock.size())
+                    return ErrorCode::UNEXPECTED_EOF;
+                for(uint8_t i = 0; i < count; ++i)
+                    func(x + i, y, colorBlock[position++], false);
+                position += (shift & 0x3F) - count;
+            } else
+            {
+                // Player colors or compressed pixels
+                if(position >= colorBlock.size())
+                    return ErrorCode::UNEXPECTED_EOF;
+                for(uint8_t i = 0; i < count; ++i)
+                    func(x + i, y, colorBlock[position], shift < 0xC0);
+                ++position;
+            }
+            x += count;
+        }
+    }
+    return ErrorCode::NONE;
+}
+
+/// Check that the image can be decoded from the color block, so decoding it later can't fail.
+/// Empty color blocks result in transparent images
+static int validateImage(const std::vector<uint8_t>& colorBlock, const std::vector<uint16_t>& starts)
+{
+    return forEachPixel(colorBlock, starts, [](uint16_t, uint16_t, uint8_t, bool) {});
+}
+
 ArchivItem_Bob::ArchivItem_Bob() : ArchivItem(BobType::Bob), numOverlayImgs(0) {}
 
 ArchivItem_Bob::~ArchivItem_Bob() = default;
@@ -81,54 +137,44 @@ int ArchivItem_Bob::load(std::istream& file, const ArchivItem_Palette* palette)
 
     libendian::EndianIStreamAdapter<false, std::istream&> fs(file);
 
+    clear();
+    imageData_.reset();
+    auto imageData = std::make_shared<ImageData>();
+    imageData->palette = internPalette(*palette);
+
     // Read body color block
-    std::vector<uint8_t> raw_base;
-    if(int ec = readColorBlock(fs, raw_base))
+    if(int ec = readColorBlock(fs, imageData->colorBlocks[0]))
         return ec;
 
     // Read body images (to get full figure draw this then draw the item image (below) over it)
     // They form an array [fat][direction][animStep]
-    alloc(NUM_BODY_IMAGES);
-    for(uint32_t i = 0; i < NUM_BODY_IMAGES; ++i)
+    imageData->images.resize(NUM_BODY_IMAGES);
+    for(ImageInfo& image : imageData->images)
     {
-        std::vector<uint16_t> starts;
-        uint8_t ny;
-        if(int ec = readImageData(fs, starts, ny))
+        if(int ec = readImageData(fs, image.starts, image.ny))
             return ec;
-
-        auto image = getAllocator().create<ArchivItem_Bitmap_Player>(BobType::BitmapPlayer);
-        assert(image);
-        image->setNx(X_OFFSET);
-        image->setNy(ny);
-
-        int ec = image->load(SPRITE_WIDTH, raw_base, starts, true, palette);
-        if(ec)
+        image.colorBlock = 0;
+        if(int ec = validateImage(imageData->colorBlocks[0], image.starts))
             return ec;
-
-        set(i, std::move(image));
     }
 
     // Color blocks for each direction
-    std::array<std::vector<uint8_t>, 6> raw;
-
-    for(auto& i : raw)
+    for(unsigned i = 1; i < imageData->colorBlocks.size(); i++)
     {
-        if(int ec = readColorBlock(fs, i))
+        if(int ec = readColorBlock(fs, imageData->colorBlocks[i]))
             return ec;
     }
 
     // Number of overlay images (e.g. goods of carriers)
     fs >> numOverlayImgs;
 
-    alloc_inc(numOverlayImgs);
-
-    std::vector<std::vector<uint16_t>> starts(numOverlayImgs);
-    std::vector<uint8_t> ny(numOverlayImgs);
-
+    imageData->images.resize(NUM_BODY_IMAGES + numOverlayImgs);
     for(uint16_t i = 0; i < numOverlayImgs; ++i)
     {
-        if(int ec = readImageData(fs, starts[i], ny[i]))
+        ImageInfo& image = imageData->images[NUM_BODY_IMAGES + i];
+        if(int ec = readImageData(fs, image.starts, image.ny))
             return ec;
+        image.colorBlock = NO_COLOR_BLOCK;
     }
 
     // Number of complete pictures.
@@ -140,7 +186,6 @@ int ArchivItem_Bob::load(std::istream& file, const ArchivItem_Palette* palette)
         return ErrorCode::UNEXPECTED_EOF;
 
     links.resize(numLinks);
-    std::vector<bool> loaded(numOverlayImgs, false);
 
     for(uint32_t i = 0; i < numLinks; ++i)
     {
@@ -151,26 +196,25 @@ int ArchivItem_Bob::load(std::istream& file, const ArchivItem_Palette* palette)
         if(links[i] >= numOverlayImgs)
             return ErrorCode::WRONG_FORMAT;
 
-        if(loaded[links[i]])
+        // The overlay uses the color block of the direction it is first used with
+        ImageInfo& image = imageData->images[NUM_BODY_IMAGES + links[i]];
+        if(image.colorBlock != NO_COLOR_BLOCK)
             continue;
-
-        auto image = getAllocator().create<ArchivItem_Bitmap_Player>(BobType::BitmapPlayer);
-        assert(image);
-        image->setNx(X_OFFSET);
-        image->setNy(ny[links[i]]);
-
-        int ec = image->load(SPRITE_WIDTH, raw[i % 6], starts[links[i]], true, palette);
-        if(ec)
+        image.colorBlock = static_cast<uint8_t>(1 + i % 6);
+        if(int ec = validateImage(imageData->colorBlocks[image.colorBlock], image.starts))
             return ec;
-
-        set(NUM_BODY_IMAGES + links[i], std::move(image));
-        loaded[links[i]] = true;
     }
     // Adjust links so they point to actual indices in the archive as we moved them by NUM_BODY_IMAGES
     for(auto& link : links)
         link += NUM_BODY_IMAGES;
 
-    return (!fs) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
+    if(!fs)
+        return ErrorCode::UNEXPECTED_EOF;
+
+    // Images are decoded on first access
+    alloc(imageData->images.size());
+    imageData_ = std::move(imageData);
+    return ErrorCode::NONE;
 }
 
 /**
@@ -188,15 +232,118 @@ int ArchivItem_Bob::write(std::ostream&, const ArchivItem_Palette*)
 
 ArchivItem_Bitmap_Player* ArchivItem_Bob::getBody(bool fat, ImgDir direction, unsigned animationstep)
 {
-    // Array: [fat][direction][animStep]: [2][6][8]
-    const unsigned bodyIdx = (fat * 6 + static_cast<unsigned>(direction)) * 8 + animationstep;
-    return dynamic_cast<ArchivItem_Bitmap_Player*>(get(bodyIdx));
+    return getImage(getBodyIdx(fat, direction, animationstep));
 }
 
 ArchivItem_Bitmap_Player* ArchivItem_Bob::getOverlay(unsigned overlayIdx, bool fat, ImgDir direction,
                                                      unsigned animationstep)
 {
-    return dynamic_cast<ArchivItem_Bitmap_Player*>(get(getOverlayIdx(overlayIdx, fat, direction, animationstep)));
+    return getImage(getOverlayIdx(overlayIdx, fat, direction, animationstep));
+}
+
+bool ArchivItem_Bob::hasImage(unsigned idx) const
+{
+    if(idx >= size())
+        return false;
+    if(get(idx))
+        return true;
+    return imageData_ && idx < imageData_->images.size()
+           && imageData_->images[idx].colorBlock != NO_COLOR_BLOCK;
+}
+
+ArchivItem_Bitmap_Player* ArchivItem_Bob::getImage(unsigned idx)
+{
+    if(!get(idx) && hasImage(idx) && decodeImage(idx) != ErrorCode::NONE)
+        return nullptr;
+    return item_cast<ArchivItem_Bitmap_Player>(get(idx));
+}
+
+int ArchivItem_Bob::decodeImage(unsigned idx)
+{
+    const ImageInfo& info = imageData_->images[idx];
+    auto image = getAllocator().create<ArchivItem_Bitmap_Player>(BobType::BitmapPlayer);
+    assert(image);
+    image->setNx(X_OFFSET);
+    image->setNy(info.ny);
+
+    if(int ec = image->load(SPRITE_WIDTH, imageData_->colorBlocks[info.colorBlock], info.starts, true,
+                            imageData_->palette.get()))
+        return ec;
+
+    set(idx, std::move(image));
+    return ErrorCode::NONE;
+}
+
+int ArchivItem_Bob::decodeAll()
+{
+    for(unsigned i = 0; i < size(); i++)
+    {
+        if(!get(i) && hasImage(i))
+        {
+            if(int ec = decodeImage(i))
+                return ec;
+        }
+    }
+    return ErrorCode::NONE;
+}
+
+void ArchivItem_Bob::getImageInfo(unsigned idx, uint16_t& width, uint16_t& height, int16_t& nx, int16_t& ny) const
+{
+    if(const auto* bmp = item_cast<ArchivItem_Bitmap_Player>(get(idx)))
+    {
+        width = bmp->getWidth();
+        height = bmp->getHeight();
+        nx = bmp->getNx();
+        ny = bmp->getNy();
+    } else if(hasImage(idx))
+    {
+        const ImageInfo& info = imageData_->images[idx];
+        width = SPRITE_WIDTH;
+        height = static_cast<uint16_t>(info.starts.size());
+        nx = X_OFFSET;
+        ny = info.ny;
+    } else
+        width = height = nx = ny = 0;
+}
+
+int ArchivItem_Bob::printImage(unsigned idx, uint8_t* buffer, uint16_t buffer_width, uint16_t buffer_height,
+                               TextureFormat buffer_format, const ArchivItem_Palette* palette,
+                               uint8_t plClrStartIdx, uint16_t to_x, uint16_t to_y, bool only_player) const
+{
+    if(buffer_width == 0 || buffer_height == 0)
+        return ErrorCode::NONE;
+    if(!buffer)
+        return ErrorCode::INVALID_BUFFER;
+    // Already decoded images might have been changed, so use them
+    if(const auto* bmp = item_cast<ArchivItem_Bitmap_Player>(get(idx)))
+    {
+        return bmp->print(buffer, buffer_width, buffer_height, buffer_format, palette, plClrStartIdx, to_x, to_y, 0, 0,
+                          0, 0, only_player);
+    }
+    if(!hasImage(idx))
+        return ErrorCode::WRONG_ARCHIVE;
+    if(!palette)
+        palette = imageData_->palette.get();
+
+    const ImageInfo& info = imageData_->images[idx];
+    const size_t bbp = ArchivItem_BitmapBase::getBBP(buffer_format);
+    return forEachPixel(imageData_->colorBlocks[info.colorBlock], info.starts,
+                        [&](uint16_t x, uint16_t y, uint8_t clrIdx, bool isPlayerClr) {
+                            const unsigned dstX = to_x + x, dstY = to_y + y;
+                            if(dstX >= buffer_width || dstY >= buffer_height)
+                                return;
+                            if(isPlayerClr)
+                                clrIdx += plClrStartIdx;
+                            else if(only_player)
+                                return;
+                            else if(palette->isTransparent(clrIdx))
+                                return;
+                            uint8_t* dst = &buffer[(static_cast<size_t>(dstY) * buffer_width + dstX) * bbp];
+                            if(buffer_format == TextureFormat::Paletted)
+                                *dst = clrIdx;
+                            else
+                                ColorBGRA(palette->get(clrIdx)).toBGRA(dst);
+                        });
 }
 
 void ArchivItem_Bob::writeLinks(std::ostream& file) const
@@ -7,8 +7,9 @@
 #include "prototypen.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include "libendian/EndianOStreamAdapter.h"
+#include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <iterator>
 #include <stdexcept>
 
 /** @class libsiedler2::ArchivItem_Font
@@ -26,7 +27,28 @@
  *  Y-Buchstabenabstand.
  */
 
-libsiedler2::ArchivItem_Font::ArchivItem_Font() : ArchivItem(BobType::Font), isUnicode(false), dx(0), dy(0) {}
+libsiedler2::ArchivItem_Font::ArchivItem_Font()
+    : ArchivItem(BobType::Font), isUnicode(false), dx(0), dy(0), numChars_(0)
+{}
+
+libsiedler2::ArchivItem_Font::ArchivItem_Font(const ArchivItem_Font& other)
+    : ArchivItem(other), isUnicode(other.isUnicode), dx(other.dx), dy(other.dy), numChars_(other.numChars_)
+{
+    glyphs_.reserve(other.glyphs_.size());
+    for(const Glyph& glyph : other.glyphs_)
+        glyphs_.push_back(Glyph{glyph.codepoint, libsiedler2::clone(glyph.item)});
+}
+
+libsiedler2::ArchivItem_Font::ArchivItem_Font(ArchivItem_Font&&) noexcept = default;
+libsiedler2::ArchivItem_Font::~ArchivItem_Font() = default;
+libsiedler2::ArchivItem_Font& libsiedler2::ArchivItem_Font::operator=(ArchivItem_Font&&) noexcept = default;
+
+libsiedler2::ArchivItem_Font& libsiedler2::ArchivItem_Font::operator=(const ArchivItem_Font& other)
+{
+    if(this != &other)
+        *this = ArchivItem_Font(other);
+    return *this;
+}
 
 /**
  *  lädt die Fontdaten aus einer Datei.
@@ -58,7 +80,7 @@ int libsiedler2::ArchivItem_Font::load(std::istream& file, const ArchivItem_Pale
     } else
         numChars = 256;
 
-    // Speicher für Buchstaben alloziieren
+    // Only the existing glyphs are stored
     alloc(numChars);
 
     // Buchstaben einlesen
@@ -79,15 +101,33 @@ int libsiedler2::ArchivItem_Font::load(std::istream& file, const ArchivItem_Pale
         int ec = loader::LoadType(bobtype, file, item, palette);
         if(ec)
             return ec;
-        std::stringstream name;
-        name << "U+" << std::hex << i;
-        item->setName(name.str());
-        set(i, std::move(item));
+        // Glyphs are not named on load, use getGlyphName if required. Added in order, so no sorting required
+        if(item)
+            glyphs_.push_back(Glyph{i, std::move(item)});
     }
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
 
+/**
+ *  Return the name of the glyph for the given codepoint ("U+" followed by the lowercase hex value)
+ */
+std::string libsiedler2::ArchivItem_Font::getGlyphName(uint32_t codepoint)
+{
+    static constexpr char hexDigits[] = "0123456789abcdef";
+    char buffer[2 + 8];
+    char* const end = std::end(buffer);
+    char* pos = end;
+    do
+    {
+        *--pos = hexDigits[codepoint & 0xF];
+        codepoint >>= 4;
+    } while(codepoint);
+    *--pos = '+';
+    *--pos = 'U';
+    return std::string(pos, end);
+}
+
 /**
  *  schreibt die Fontdaten in eine Datei.
  *
@@ -117,9 +157,13 @@ int libsiedler2::ArchivItem_Font::write(std::ostream& file, const ArchivItem_Pal
     fs << dx << dy;
 
     // Buchstaben schreiben
+    auto itGlyph = std::lower_bound(glyphs_.begin(), glyphs_.end(), 32u,
+                                    [](const Glyph& glyph, uint32_t codepoint) { return glyph.codepoint < codepoint; });
     for(size_t i = 32; i < numChars; ++i)
     {
-        const ArchivItem* item = get(i);
+        const ArchivItem* item = nullptr;
+        if(itGlyph != glyphs_.end() && itGlyph->codepoint == i)
+            item = (itGlyph++)->item.get();
         BobType bobtype = BobType::None;
 
         if(item)
@@ -138,3 +182,65 @@ int libsiedler2::ArchivItem_Font::write(std::ostream& file, const ArchivItem_Pal
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
+
+void libsiedler2::ArchivItem_Font::alloc(size_t numChars)
+{
+    glyphs_.clear();
+    numChars_ = numChars;
+}
+
+void libsiedler2::ArchivItem_Font::clear()
+{
+    alloc(0);
+}
+
+std::vector<libsiedler2::ArchivItem_Font::Glyph>::const_iterator
+libsiedler2::ArchivItem_Font::findGlyph(size_t codepoint) const
+{
+    return std::lower_bound(glyphs_.begin(), glyphs_.end(), codepoint,
+                            [](const Glyph& glyph, size_t codepoint) { return glyph.codepoint < codepoint; });
+}
+
+libsiedler2::ArchivItem* libsiedler2::ArchivItem_Font::get(size_t codepoint)
+{
+    return const_cast<ArchivItem*>(static_cast<const ArchivItem_Font&>(*this).get(codepoint));
+}
+
+const libsiedler2::ArchivItem* libsiedler2::ArchivItem_Font::get(size_t codepoint) const
+{
+    const auto it = findGlyph(codepoint);
+    return (it != glyphs_.end() && it->codepoint == codepoint) ? it->item.get() : nullptr;
+}
+
+void libsiedler2::ArchivItem_Font::set(size_t codepoint, std::unique_ptr<ArchivItem> item)
+{
+    if(codepoint > 0xFFFFFFFFu)
+        throw std::out_of_range("Codepoint out of range");
+    const auto itPos = findGlyph(codepoint);
+    const auto it = glyphs_.begin() + (itPos - glyphs_.cbegin());
+    if(it != glyphs_.end() && it->codepoint == codepoint)
+    {
+        if(item)
+            it->item = std::move(item);
+        else
+            glyphs_.erase(it);
+    } else if(item)
+        glyphs_.insert(it, Glyph{static_cast<uint32_t>(codepoint), std::move(item)});
+    numChars_ = std::max(numChars_, codepoint + 1u);
+}
+
+void libsiedler2::ArchivItem_Font::setC(size_t codepoint, const ArchivItem& item)
+{
+    set(codepoint, libsiedler2::clone(item));
+}
+
+std::unique_ptr<libsiedler2::ArchivItem> libsiedler2::ArchivItem_Font::release(size_t codepoint)
+{
+    const auto itPos = findGlyph(codepoint);
+    if(itPos == glyphs_.end() || itPos->codepoint != codepoint)
+        return nullptr;
+    const auto it = glyphs_.begin() + (itPos - glyphs_.cbegin());
+    std::unique_ptr<ArchivItem> result = std::move(it->item);
+    glyphs_.erase(it);
+    return result;
+}
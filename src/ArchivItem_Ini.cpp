@@ -1,16 +1,46 @@
-// Copyright (C) 2005 - 2021 Settlers Freaks (sf-team at siedler25.org)
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
 //
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "ArchivItem_Ini.h"
-#include "ArchivItem_Text.h"
 #include "ErrorCodes.h"
-#include "IAllocator.h"
-#include "libsiedler2.h"
-#include "s25util/StringConversion.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 
 namespace libsiedler2 {
 
+namespace {
+    /// Return the part of @p text up to the next '\n' (excluding) and remove it including the '\n' from @p text
+    std::string_view getLine(std::string_view& text)
+    {
+        const auto posNl = text.find('\n');
+        const std::string_view line = text.substr(0, posNl);
+        text.remove_prefix(posNl == std::string_view::npos ? text.size() : posNl + 1);
+        return line;
+    }
+
+    /// Parse an int like s25util::fromStringClassic: Surrounding whitespace is allowed, anything else throws
+    int parseInt(std::string_view value)
+    {
+        constexpr const char* whitespace = " \t\n\v\f\r";
+        std::string_view number = value;
+        number.remove_prefix(std::min(number.find_first_not_of(whitespace), number.size()));
+        number = number.substr(0, number.find_last_not_of(whitespace) + 1);
+        if(number.size() > 1u && number.front() == '+' && number[1] != '-')
+            number.remove_prefix(1);
+        int result;
+        const auto [end, ec] = std::from_chars(number.data(), number.data() + number.size(), result);
+        if(number.empty() || ec != std::errc() || end != number.data() + number.size())
+            throw std::invalid_argument("Invalid value: " + std::string(value));
+        return result;
+    }
+} // namespace
+
 /** @class ArchivItem_Ini
  *
  *  Klasse für INI-Dateien (genauer gesagt eine Sektion).
@@ -35,44 +65,58 @@ int ArchivItem_Ini::load(std::istream& file)
     if(!file)
         return ErrorCode::FILE_NOT_ACCESSIBLE;
 
-    std::string section;
-    if(!std::getline(file, section))
+    // Read only the lines of this section, i.e. up to and including the first empty line
+    std::string text, line;
+    bool isHeader = true;
+    while(std::getline(file, line))
+    {
+        text += line;
+        text += '\n';
+        if(isHeader ? line.empty() : line.substr(0, line.find('\r')).empty())
+            break;
+        isHeader = false;
+    }
+    if(text.empty())
         return file.eof() ? ErrorCode::NONE : ErrorCode::UNEXPECTED_EOF;
 
-    if(!section.empty())
+    std::string_view textView = text;
+    return load(textView);
+}
+
+int ArchivItem_Ini::load(std::string_view& text)
+{
+    clear();
+    const std::string_view sectionLine = getLine(text);
+    std::string_view section;
+    if(!sectionLine.empty())
     {
-        size_t posStart = section.find('[');
-        size_t posEnd = section.find_last_of(']');
-        if(posStart == std::string::npos || posEnd == std::string::npos || posStart > posEnd)
+        const size_t posStart = sectionLine.find('[');
+        const size_t posEnd = sectionLine.find_last_of(']');
+        if(posStart == std::string_view::npos || posEnd == std::string_view::npos || posStart > posEnd)
             return ErrorCode::WRONG_FORMAT;
-        section = section.substr(posStart + 1, posEnd - posStart - 1);
+        section = sectionLine.substr(posStart + 1, posEnd - posStart - 1);
     }
     if(section.empty())
         return ErrorCode::WRONG_HEADER;
 
     setName(section);
 
-    while(true)
+    // The text up to the next section is an upper bound for the size of the keys and values
+    pool_.reserve(std::min(text.find("\n["), text.size()));
+    while(!text.empty())
     {
-        std::string entry;
-        if(!std::getline(file, entry))
-            break;
-        size_t posNl = entry.find_first_of("\r\n");
-        if(posNl != std::string::npos)
-            entry.erase(posNl);
+        std::string_view entry = getLine(text);
+        entry = entry.substr(0, entry.find('\r'));
         if(entry.empty())
             break;
 
-        size_t pos = entry.find('=');
-        if(pos == std::string::npos)
+        const size_t pos = entry.find('=');
+        if(pos == std::string_view::npos)
             return ErrorCode::WRONG_FORMAT;
-        std::string name = entry.substr(0, pos);
-        std::string value = entry.substr(pos + 1);
-
+        const std::string_view name = entry.substr(0, pos);
         if(name.empty())
             continue;
-
-        setValue(name, value);
+        setValue(name, entry.substr(pos + 1));
     }
 
     return ErrorCode::NONE;
@@ -90,83 +134,167 @@ int ArchivItem_Ini::write(std::ostream& file) const
     if(!file)
         return ErrorCode::FILE_NOT_ACCESSIBLE;
 
-    file << "[" << getName() << "]\r\n";
-
-    for(size_t i = 0; i < size(); ++i)
-    {
-        const auto* item = dynamic_cast<const ArchivItem_Text*>(get(i));
-        file << item->getName() << "=" << item->getText() << "\r\n"; //-V522
-    }
+    std::string buffer;
+    write(buffer);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
 
-void ArchivItem_Ini::addValue(const std::string& name, const std::string& value)
+void ArchivItem_Ini::write(std::string& buffer) const
 {
-    auto item = getAllocator().create<ArchivItem_Text>(BobType::Text);
-    item->setText(value); //-V522
-    item->setName(name);
+    const std::string_view name = getName();
+    // Each line has a '=' and a line break
+    buffer.reserve(buffer.size() + name.size() + 4u + pool_.size() - unusedBytes_ + entries_.size() * 3u);
+    buffer.append("[").append(name).append("]\r\n");
+    for(const Entry& entry : entries_)
+        buffer.append(getString(entry.key)).append("=").append(getString(entry.value)).append("\r\n");
+}
 
-    push(std::move(item));
+ArchivItem_Ini::StringRef ArchivItem_Ini::addString(std::string_view str)
+{
+    const StringRef result{static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(str.size())};
+    pool_.append(str);
+    return result;
 }
 
-ArchivItem_Text* ArchivItem_Ini::getItem(const std::string& name)
+bool ArchivItem_Ini::isInPool(std::string_view str) const
 {
-    return dynamic_cast<ArchivItem_Text*>(find(name));
+    const std::less_equal<const char*> lessEqual;
+    return lessEqual(pool_.data(), str.data()) && lessEqual(str.data(), pool_.data() + pool_.size());
 }
-const ArchivItem_Text* ArchivItem_Ini::getItem(const std::string& name, bool enforce_exists) const
+
+uint32_t ArchivItem_Ini::findEntry(std::string_view name) const
 {
-    const auto* item = dynamic_cast<const ArchivItem_Text*>(find(name));
-    if(!item && enforce_exists)
-        throw std::runtime_error("Missing INI key '" + name + "'");
-    return item;
+    if(buckets_.empty())
+        return NO_ENTRY;
+    const size_t mask = buckets_.size() - 1u;
+    for(size_t i = std::hash<std::string_view>()(name) & mask;; i = (i + 1u) & mask)
+    {
+        const uint32_t idx = buckets_[i];
+        if(idx == NO_ENTRY || getString(entries_[idx].key) == name)
+            return idx;
+    }
+}
+
+void ArchivItem_Ini::rebuildBuckets(size_t numBuckets)
+{
+    buckets_.assign(numBuckets, NO_ENTRY);
+    const size_t mask = numBuckets - 1u;
+    for(uint32_t idx = 0; idx < entries_.size(); idx++)
+    {
+        size_t i = std::hash<std::string_view>()(getString(entries_[idx].key)) & mask;
+        while(buckets_[i] != NO_ENTRY)
+            i = (i + 1u) & mask;
+        buckets_[i] = idx;
+    }
+}
+
+void ArchivItem_Ini::compactPool()
+{
+    std::string oldPool;
+    std::swap(oldPool, pool_);
+    pool_.reserve(oldPool.size() - unusedBytes_);
+    for(Entry& entry : entries_)
+    {
+        entry.key = addString(std::string_view(oldPool).substr(entry.key.offset, entry.key.length));
+        entry.value = addString(std::string_view(oldPool).substr(entry.value.offset, entry.value.length));
+    }
+    unusedBytes_ = 0;
+}
+
+void ArchivItem_Ini::clear()
+{
+    pool_.clear();
+    unusedBytes_ = 0;
+    entries_.clear();
+    buckets_.clear();
 }
 
-std::string ArchivItem_Ini::getValue(const std::string& name) const
+std::string ArchivItem_Ini::getValue(std::string_view name) const
 {
-    return getItem(name, true)->getText();
+    const uint32_t idx = findEntry(name);
+    if(idx == NO_ENTRY)
+        throw std::runtime_error("Missing INI key '" + std::string(name) + "'");
+    return std::string(getValueAt(idx));
 }
 
-int ArchivItem_Ini::getIntValue(const std::string& name) const
+int ArchivItem_Ini::getIntValue(std::string_view name) const
 {
-    return s25util::fromStringClassic<int>(getValue(name));
+    return parseInt(getValue(name));
 }
 
-bool ArchivItem_Ini::getBoolValue(const std::string& name) const
+bool ArchivItem_Ini::getBoolValue(std::string_view name) const
 {
-    return s25util::fromStringClassic<int>(getValue(name)) != 0;
+    return getIntValue(name) != 0;
 }
 
-std::string ArchivItem_Ini::getValue(const std::string& name, const std::string& defaultVal) const
+std::string ArchivItem_Ini::getValue(std::string_view name, const std::string& defaultVal) const
 {
-    const auto* item = getItem(name);
-    return item ? item->getText() : defaultVal;
+    const uint32_t idx = findEntry(name);
+    return idx != NO_ENTRY ? std::string(getValueAt(idx)) : defaultVal;
 }
 
-int ArchivItem_Ini::getValue(const std::string& name, int defaultVal) const
+int ArchivItem_Ini::getValue(std::string_view name, int defaultVal) const
 {
-    const auto* item = getItem(name);
-    return item ? s25util::fromStringClassic<int>(item->getText()) : defaultVal;
+    const uint32_t idx = findEntry(name);
+    return idx != NO_ENTRY ? parseInt(getValueAt(idx)) : defaultVal;
 }
 
-int ArchivItem_Ini::getValue(const std::string& name, bool defaultVal) const
+int ArchivItem_Ini::getValue(std::string_view name, bool defaultVal) const
 {
-    const auto* item = getItem(name);
-    return item ? (s25util::fromStringClassic<int>(item->getText()) != 0) : defaultVal;
+    const uint32_t idx = findEntry(name);
+    return idx != NO_ENTRY ? (parseInt(getValueAt(idx)) != 0) : defaultVal;
 }
 
-void ArchivItem_Ini::setValue(const std::string& name, const std::string& value)
+void ArchivItem_Ini::setValue(std::string_view name, std::string_view value)
 {
-    auto* item = getItem(name);
-    if(item)
-        item->setText(value);
-    else // Not found so add
-        addValue(name, value);
+    const uint32_t idx = findEntry(name);
+    if(idx != NO_ENTRY)
+    {
+        StringRef& curValue = entries_[idx].value;
+        if(value.size() <= curValue.length)
+        {
+            // Replace in place
+            pool_.replace(curValue.offset, value.size(), value);
+            unusedBytes_ += curValue.length - value.size();
+            curValue.length = static_cast<uint32_t>(value.size());
+        } else
+        {
+            unusedBytes_ += curValue.length;
+            curValue = addString(value);
+        }
+        if(unusedBytes_ > 256u && unusedBytes_ > pool_.size() / 2u)
+            compactPool();
+        return;
+    }
+
+    // Not found so add. Arguments referring to the pool (e.g. from getValueAt) must be copied first
+    // as adding the key might reallocate it
+    std::string nameCopy, valueCopy;
+    if(isInPool(name))
+        name = nameCopy = name;
+    if(isInPool(value))
+        value = valueCopy = value;
+    const StringRef key = addString(name);
+    entries_.push_back(Entry{key, addString(value)});
+    // Keep the load factor below 1/2
+    if(entries_.size() * 2u > buckets_.size())
+        rebuildBuckets(std::max<size_t>(16u, buckets_.size() * 2u));
+    else
+    {
+        const size_t mask = buckets_.size() - 1u;
+        size_t i = std::hash<std::string_view>()(name) & mask;
+        while(buckets_[i] != NO_ENTRY)
+            i = (i + 1u) & mask;
+        buckets_[i] = static_cast<uint32_t>(entries_.size() - 1u);
+    }
 }
 
-void ArchivItem_Ini::setValue(const std::string& name, int value)
+void ArchivItem_Ini::setValue(std::string_view name, int value)
 {
-    std::string temp = s25util::toStringClassic(value);
-    setValue(name, temp);
+    std::array<char, 16> buffer;
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    setValue(name, std::string_view(buffer.data(), result.ptr - buffer.data()));
 }
-} // namespace libsiedler2
\ No newline at end of file
+} // namespace libsiedler2
@@ -4,35 +4,80 @@
 
 #include "ArchivItem_Map.h"
 #include "ArchivItem_Map_Header.h"
-#include "ArchivItem_Raw.h"
+#include "BlockCompression.h"
 #include "ErrorCodes.h"
+#include "GetIStreamSize.h"
 #include "IAllocator.h"
+#include "MapBlockHeader.h"
+#include "fileFormatHelpers.h"
 #include "libsiedler2.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 
 namespace {
+const char COMPRESSED_ID[5] = "SWDZ";
+constexpr uint16_t COMPRESSED_VERSION = 1;
 
-struct BlockHeader
-{                     //-V802
-    uint16_t id;      // Must be 0x2710
-    uint32_t unknown; // Always 0
-    uint16_t w, h;
-    uint16_t multiplier; // Not sure, always 1
-    uint32_t blockLength;
+/// Transformation of a layer before compression
+enum class LayerFilter : uint8_t
+{
+    None,
+    /// Difference to the previous value (good for smooth layers like the altitude)
+    Delta
 };
-} // namespace
 
-namespace libsiedler2 {
+/// Write a block compressed with compressBlock from data of the given size
+template<class T_Stream>
+void writeCompressedBlock(T_Stream& fs, size_t size, const std::vector<uint8_t>& compressed)
+{
+    fs << static_cast<uint32_t>(size) << static_cast<uint32_t>(compressed.size());
+    fs.writeRaw(compressed.data(), compressed.size());
+}
 
-ArchivItem_Map::ArchivItem_Map() : ArchivItem(BobType::Map), header_(nullptr) {}
+/// Read a block written by writeCompressedBlock which must decompress to expectedSize bytes.
+/// The sizes in the file are checked against expectedSize and streamEnd (end position of the stream) before allocating.
+/// Returns an ErrorCode
+template<class T_Stream>
+int readCompressedBlock(T_Stream& fs, long streamEnd, size_t expectedSize, std::vector<uint8_t>& data)
+{
+    uint32_t size, compressedSize;
+    if(!(fs >> size >> compressedSize))
+        return libsiedler2::ErrorCode::UNEXPECTED_EOF;
+    if(size != expectedSize)
+        return libsiedler2::ErrorCode::WRONG_FORMAT;
+    const long remainingSize = streamEnd - fs.getPosition();
+    if(remainingSize < 0 || compressedSize > static_cast<unsigned long>(remainingSize))
+        return libsiedler2::ErrorCode::UNEXPECTED_EOF;
+    std::vector<uint8_t> compressed(compressedSize);
+    if(!fs.readRaw(compressed.data(), compressed.size()))
+        return libsiedler2::ErrorCode::UNEXPECTED_EOF;
+    data.resize(size);
+    return libsiedler2::decompressBlock(compressed, data);
+}
 
-ArchivItem_Map::ArchivItem_Map(const ArchivItem_Map& other) : ArchivItem(other), Archiv(other)
+/// Size of a serialized map header (it has a fixed layout)
+size_t getMapHeaderSize()
 {
-    header_ = static_cast<ArchivItem_Map_Header*>(get(0));
+    static const size_t size = [] {
+        std::ostringstream stream;
+        libsiedler2::ArchivItem_Map_Header().write(stream);
+        return stream.str().size();
+    }();
+    return size;
 }
+} // namespace
+
+namespace libsiedler2 {
+
+ArchivItem_Map::ArchivItem_Map() : ArchivItem(BobType::Map), numNodes_(0), layerMask_(0) {}
+
+ArchivItem_Map::ArchivItem_Map(const ArchivItem_Map& other)
+    : ArchivItem(other), extraInfo(other.extraInfo), header_(libsiedler2::clone(other.header_)),
+      numNodes_(other.numNodes_), layerMask_(other.layerMask_), layerData_(other.layerData_)
+{}
 
 ArchivItem_Map::~ArchivItem_Map() = default;
 
@@ -49,8 +94,10 @@ int ArchivItem_Map::load(std::istream& file, bool onlyHeader)
     if(!file)
         return ErrorCode::FILE_NOT_ACCESSIBLE;
 
-    clear();
-    header_ = nullptr;
+    header_.reset();
+    numNodes_ = 0;
+    layerMask_ = 0;
+    layerData_.reset();
 
     {
         auto header = getAllocator().create<ArchivItem_Map_Header>(BobType::MapHeader);
@@ -60,8 +107,7 @@ int ArchivItem_Map::load(std::istream& file, bool onlyHeader)
         if(ec)
             return ec;
 
-        push(std::move(header));
-        header_ = static_cast<ArchivItem_Map_Header*>(get(0));
+        header_ = std::move(header);
     }
 
     // nur der Header?
@@ -71,52 +117,46 @@ int ArchivItem_Map::load(std::istream& file, bool onlyHeader)
     const ArchivItem_Map_Header& header = getHeader();
     const uint16_t w = header.getWidth();
     const uint16_t h = header.getHeight();
+    const unsigned numNodes = static_cast<unsigned>(w) * static_cast<unsigned>(h);
+    // Only present layers are stored. They are added after their block header was validated
+    std::vector<uint8_t> layerData;
+
+    // Used to validate the block sizes before allocating
+    const std::istream::pos_type startPos = file.tellg();
+    const auto streamEnd = static_cast<long>(getIStreamSize(file));
+    file.seekg(startPos);
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
 
     libendian::EndianIStreamAdapter<false, std::istream&> fs(file);
-    for(uint32_t i = 1; i < 15; ++i)
+    for(uint32_t i = 0; i < NUM_SWD_LAYERS; ++i)
     {
-        BlockHeader bHeader;
-        fs >> bHeader.id >> bHeader.unknown >> bHeader.w >> bHeader.h >> bHeader.multiplier >> bHeader.blockLength;
-        // Header id must match
-        if(!fs || bHeader.id != 0x2710 || bHeader.unknown != 0)
-        {
-            return ErrorCode::WRONG_FORMAT;
-        }
-        // Multiplier of 0 means unused block and implies no data
-        if(bHeader.multiplier == 0)
-        {
-            assert(bHeader.blockLength == 0);
-            push(nullptr);
+        bool hasData;
+        if(int ec = readMapBlockHeader(fs, w, h, hasData))
+            return ec;
+        if(!hasData)
             continue;
-        }
-        // Blocksize must match extents
-        if(bHeader.blockLength != static_cast<uint32_t>(w) * static_cast<uint32_t>(h))
-        {
-            assert(false);
-            return ErrorCode::WRONG_FORMAT;
-        }
-        // If there is data, size must match
-        if(bHeader.w != w || bHeader.h != h)
-        {
-            assert(false);
-            return ErrorCode::WRONG_FORMAT;
-        }
 
-        auto layer = getAllocator().create<ArchivItem_Raw>(BobType::Raw);
-        if(auto ec = layer->load(file, bHeader.blockLength)) //-V522
-            return ec;
-        if(i == 1 && header.hasExtraWord())
+        const long remainingSize = streamEnd - fs.getPosition();
+        if(remainingSize < 0 || numNodes > static_cast<unsigned long>(remainingSize))
+            return ErrorCode::UNEXPECTED_EOF;
+        const size_t offset = layerData.size();
+        layerData.resize(offset + numNodes);
+        uint8_t* layer = &layerData[offset];
+        if(!file.read(reinterpret_cast<char*>(layer), numNodes))
+            return ErrorCode::UNEXPECTED_EOF;
+        if(i == 0 && header.hasExtraWord() && numNodes >= 3u)
         {
             // Work around for map file bug: There are 2 extra bytes inbetween the header which would actually belong to
             // the first block
             fs.setPositionRel(-2);
-            std::vector<uint8_t>& data = layer->getData();
             // Replace last 2 bytes by 3rd last one
-            data[data.size() - 1] = data[data.size() - 2] = data[data.size() - 3];
+            layer[numNodes - 1] = layer[numNodes - 2] = layer[numNodes - 3];
         }
-
-        push(std::move(layer));
+        layerMask_ |= 1u << i;
     }
+    numNodes_ = numNodes;
+    layerData_ = CopyOnWrite<std::vector<uint8_t>>(std::move(layerData));
 
     extraInfo.clear();
 
@@ -124,7 +164,7 @@ int ArchivItem_Map::load(std::istream& file, bool onlyHeader)
     {
         ExtraAnimalInfo info;
         fs >> info.id;
-        if(info.id == 0xFF)
+        if(!fs || info.id == 0xFF)
             break;
         fs >> info.x >> info.y;
         extraInfo.push_back(info);
@@ -133,6 +173,145 @@ int ArchivItem_Map::load(std::istream& file, bool onlyHeader)
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
 
+int ArchivItem_Map::loadCompressed(std::istream& file)
+{
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+
+    header_.reset();
+    numNodes_ = 0;
+    layerMask_ = 0;
+    layerData_.reset();
+    extraInfo.clear();
+
+    // Used to validate sizes read from the file
+    const std::istream::pos_type startPos = file.tellg();
+    const auto streamEnd = static_cast<long>(getIStreamSize(file));
+    file.seekg(startPos);
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+
+    libendian::EndianIStreamAdapter<false, std::istream&> fs(file);
+    std::array<char, 4> id;
+    uint16_t version;
+    if(!(fs >> id >> version) || !isChunk(id, COMPRESSED_ID))
+        return ErrorCode::WRONG_HEADER;
+    if(version != COMPRESSED_VERSION)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+
+    std::vector<uint8_t> block;
+    if(int ec = readCompressedBlock(fs, streamEnd, getMapHeaderSize(), block))
+        return ec;
+    {
+        auto header = getAllocator().create<ArchivItem_Map_Header>(BobType::MapHeader);
+        assert(header);
+        std::istringstream headerStream(std::string(block.begin(), block.end()));
+        if(int ec = header->load(headerStream)) //-V522
+            return ec;
+        header_ = std::move(header);
+    }
+
+    const unsigned numNodes = static_cast<unsigned>(header_->getWidth()) * header_->getHeight();
+    uint16_t layerMask;
+    if(!(fs >> layerMask))
+        return ErrorCode::UNEXPECTED_EOF;
+    if(layerMask >> NUM_SWD_LAYERS)
+        return ErrorCode::WRONG_FORMAT;
+
+    // The size is taken from the header, so check that the layers fit into the rest of the stream before allocating
+    const size_t layerDataSize = size_t(numNodes) * getNumLayers(layerMask);
+    const long remainingSize = streamEnd - fs.getPosition();
+    if(remainingSize < 0 || layerDataSize > getMaxDecompressedSize(static_cast<size_t>(remainingSize)))
+        return ErrorCode::UNEXPECTED_EOF;
+    std::vector<uint8_t> layerData(layerDataSize);
+    for(uint32_t i = 0; i < NUM_SWD_LAYERS; ++i)
+    {
+        if(!(layerMask & (1u << i)))
+            continue;
+        uint8_t filter;
+        if(!(fs >> filter))
+            return ErrorCode::UNEXPECTED_EOF;
+        if(int ec = readCompressedBlock(fs, streamEnd, numNodes, block))
+            return ec;
+        uint8_t* layer = &layerData[size_t(getLayerIndex(layerMask, static_cast<MapLayer>(i))) * numNodes];
+        switch(static_cast<LayerFilter>(filter))
+        {
+            case LayerFilter::None: std::copy(block.begin(), block.end(), layer); break;
+            case LayerFilter::Delta:
+            {
+                uint8_t value = 0;
+                for(unsigned j = 0; j < numNodes; ++j)
+                    layer[j] = value += block[j];
+                break;
+            }
+            default: return ErrorCode::UNSUPPORTED_FORMAT;
+        }
+    }
+    numNodes_ = numNodes;
+    layerMask_ = layerMask;
+    layerData_ = CopyOnWrite<std::vector<uint8_t>>(std::move(layerData));
+
+    uint32_t numExtraInfos;
+    if(!(fs >> numExtraInfos))
+        return ErrorCode::UNEXPECTED_EOF;
+    for(uint32_t i = 0; i < numExtraInfos && fs; ++i)
+    {
+        ExtraAnimalInfo info;
+        fs >> info.id >> info.x >> info.y;
+        extraInfo.push_back(info);
+    }
+
+    return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
+}
+
+int ArchivItem_Map::writeCompressed(std::ostream& file) const
+{
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+
+    if(!header_)
+        return ErrorCode::WRONG_ARCHIVE;
+    std::ostringstream headerStream;
+    if(int ec = header_->write(headerStream))
+        return ec;
+    const std::string headerData = headerStream.str();
+
+    libendian::EndianOStreamAdapter<false, std::ostream&> fs(file);
+    std::array<char, 4> id;
+    setChunkId(id, COMPRESSED_ID);
+    fs << id << COMPRESSED_VERSION;
+    const span<const uint8_t> headerBytes(reinterpret_cast<const uint8_t*>(headerData.data()), headerData.size());
+    writeCompressedBlock(fs, headerBytes.size(), compressBlock(headerBytes));
+
+    fs << static_cast<uint16_t>(layerMask_);
+    std::vector<uint8_t> deltas(numNodes_);
+    for(uint32_t i = 0; i < NUM_SWD_LAYERS; ++i)
+    {
+        const auto type = static_cast<MapLayer>(i);
+        if(!hasLayer(type))
+            continue;
+        const span<const uint8_t> layer = getLayer(type);
+        // Use the delta filter only if it helps
+        uint8_t lastValue = 0;
+        for(unsigned j = 0; j < numNodes_; ++j)
+        {
+            deltas[j] = layer[j] - lastValue;
+            lastValue = layer[j];
+        }
+        const std::vector<uint8_t> compressed = compressBlock(layer);
+        const std::vector<uint8_t> compressedDeltas = compressBlock(deltas);
+        const bool useDelta = compressedDeltas.size() < compressed.size();
+        fs << static_cast<uint8_t>(useDelta ? LayerFilter::Delta : LayerFilter::None);
+        writeCompressedBlock(fs, layer.size(), useDelta ? compressedDeltas : compressed);
+    }
+
+    fs << static_cast<uint32_t>(extraInfo.size());
+    for(const ExtraAnimalInfo& it : extraInfo)
+        fs << it.id << it.x << it.y;
+
+    return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
+}
+
 /**
  *  schreibt die Mapdaten in eine Datei.
  *
@@ -145,36 +324,32 @@ int ArchivItem_Map::write(std::ostream& file) const
     if(!file)
         return ErrorCode::FILE_NOT_ACCESSIBLE;
 
-    const auto* header = dynamic_cast<const ArchivItem_Map_Header*>(get(0));
-
-    if(!header)
+    if(!header_)
         return ErrorCode::WRONG_ARCHIVE;
-    int ec = header->write(file);
+    int ec = header_->write(file);
     if(ec)
         return ec;
 
-    BlockHeader bHeader;
+    MapBlockHeader bHeader;
     bHeader.id = 0x2710;
     bHeader.unknown = 0;
-    bHeader.w = header->getWidth();
-    bHeader.h = header->getHeight();
+    bHeader.w = header_->getWidth();
+    bHeader.h = header_->getHeight();
     // For unused
     bHeader.multiplier = 0;
     bHeader.blockLength = 0;
 
     libendian::EndianOStreamAdapter<false, std::ostream&> fs(file);
-    for(uint32_t i = 1; i < std::max(15u, uint32_t(size())); ++i)
+    for(uint32_t i = 0; i < NUM_SWD_LAYERS; ++i)
     {
-        const auto* layer = dynamic_cast<const ArchivItem_Raw*>(get(i));
         fs << bHeader.id << bHeader.unknown << bHeader.w << bHeader.h;
-        if(layer)
+        const auto type = static_cast<MapLayer>(i);
+        if(hasLayer(type))
         {
-            fs << uint16_t(1);
-            assert(layer->getData().size() == size_t(header->getWidth()) * size_t(header->getHeight()));
-            // Size is written in layer
-            ec = layer->write(file, true);
-            if(ec)
-                return ec;
+            const span<const uint8_t> layer = getLayer(type);
+            assert(layer.size() == size_t(header_->getWidth()) * size_t(header_->getHeight()));
+            fs << uint16_t(1) << static_cast<uint32_t>(layer.size());
+            file.write(reinterpret_cast<const char*>(layer.data()), layer.size());
         } else
             fs << bHeader.multiplier << bHeader.blockLength;
     }
@@ -190,16 +365,17 @@ int ArchivItem_Map::write(std::ostream& file) const
 
 void ArchivItem_Map::init(std::unique_ptr<ArchivItem_Map_Header> header)
 {
-    clear();
-    header_ = nullptr;
-    if(!header)
+    header_ = std::move(header);
+    layerData_.reset();
+    if(!header_)
+    {
+        numNodes_ = 0;
+        layerMask_ = 0;
         return;
-    alloc(NUM_SWD_LAYERS + 1u); // Include header
-    set(0, std::move(header));
-    header_ = static_cast<ArchivItem_Map_Header*>(get(0));
-    const size_t numNodes = header_->getWidth() * header_->getHeight();
-    for(unsigned i = 0; i < NUM_SWD_LAYERS; ++i)
-        set(i + 1, std::make_unique<libsiedler2::ArchivItem_Raw>(std::vector<uint8_t>(numNodes)));
+    }
+    numNodes_ = static_cast<unsigned>(header_->getWidth()) * header_->getHeight();
+    layerMask_ = (1u << NUM_SWD_LAYERS) - 1u;
+    layerData_ = CopyOnWrite<std::vector<uint8_t>>(std::vector<uint8_t>(size_t(numNodes_) * getNumLayers(layerMask_)));
 }
 
 const libsiedler2::ArchivItem_Map_Header& ArchivItem_Map::getHeader() const
@@ -208,25 +384,61 @@ const libsiedler2::ArchivItem_Map_Header& ArchivItem_Map::getHeader() const
     return *header_;
 }
 
-const std::vector<uint8_t>& ArchivItem_Map::getLayer(MapLayer type) const
+span<const uint8_t> ArchivItem_Map::getLayer(MapLayer type) const
 {
-    const auto* item = static_cast<const ArchivItem_Raw*>(get(static_cast<size_t>(type) + 1)); // 0 = header
-    if(!item)
+    if(!hasLayer(type))
         throw std::range_error("Layer not found");
-    return item->getData(); //-V522
+    const size_t offset = static_cast<size_t>(getLayerIndex(layerMask_, type)) * numNodes_;
+    return span<const uint8_t>(layerData_.get().data() + offset, numNodes_);
 }
 
-std::vector<uint8_t>& ArchivItem_Map::getLayer(MapLayer type)
+span<uint8_t> ArchivItem_Map::getLayer(MapLayer type)
 {
-    auto* item = static_cast<ArchivItem_Raw*>(get(static_cast<size_t>(type) + 1)); // 0 = header
-    if(!item)
+    if(!hasLayer(type))
         throw std::range_error("Layer not found");
-    return item->getData(); //-V522
+    const size_t offset = static_cast<size_t>(getLayerIndex(layerMask_, type)) * numNodes_;
+    return span<uint8_t>(layerData_.getMutable().data() + offset, numNodes_);
 }
 
 bool ArchivItem_Map::hasLayer(MapLayer type) const
 {
-    return get(static_cast<size_t>(type) + 1) != nullptr;
+    return static_cast<unsigned>(type) < NUM_SWD_LAYERS && (layerMask_ & getLayerBit(type)) != 0u;
+}
+
+ArchivItem_Map::ConstNodeRef ArchivItem_Map::getNodeRef(unsigned idx) const
+{
+    assert(idx < numNodes_);
+    return ConstNodeRef(layerData_.get().data() + idx, numNodes_, layerMask_);
+}
+
+ArchivItem_Map::NodeRef ArchivItem_Map::getNodeRef(unsigned idx)
+{
+    assert(idx < numNodes_);
+    return NodeRef(layerData_.getMutable().data() + idx, numNodes_, layerMask_);
+}
+
+ArchivItem_Map::NodeData ArchivItem_Map::getNode(unsigned idx) const
+{
+    NodeData result{};
+    const ConstNodeRef node = getNodeRef(idx);
+    for(unsigned i = 0; i < NUM_SWD_LAYERS; ++i)
+    {
+        const auto type = static_cast<MapLayer>(i);
+        if(node.hasLayer(type))
+            result[type] = node[type];
+    }
+    return result;
+}
+
+void ArchivItem_Map::setNode(unsigned idx, const NodeData& node)
+{
+    const NodeRef nodeRef = getNodeRef(idx);
+    for(unsigned i = 0; i < NUM_SWD_LAYERS; ++i)
+    {
+        const auto type = static_cast<MapLayer>(i);
+        if(nodeRef.hasLayer(type))
+            nodeRef[type] = node[type];
+    }
 }
 
 uint8_t ArchivItem_Map::getMapDataAt(MapLayer type, unsigned idx) const
@@ -7,9 +7,13 @@
 #include "ErrorCodes.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include "libendian/EndianOStreamAdapter.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 /** @var TRANSPARENT_INDEX
  *
@@ -167,3 +171,89 @@ void libsiedler2::ArchivItem_Palette::setDefaultTransparentIdx()
     // (black as transparent color in bmps might be confusing)
     transparentIdx = lookupOrDef(TRANSPARENT_COLOR, DEFAULT_TRANSPARENT_IDX);
 }
+
+size_t libsiedler2::ArchivItem_Palette::getHash() const
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037u;
+    const auto addByte = [&hash](uint8_t value) {
+        hash ^= value;
+        hash *= 1099511628211u;
+    };
+    for(const ColorRGB& clr : colors)
+    {
+        addByte(clr.r);
+        addByte(clr.g);
+        addByte(clr.b);
+    }
+    addByte(static_cast<uint8_t>(transparentIdx));
+    addByte(static_cast<uint8_t>(transparentIdx >> 8));
+    return static_cast<size_t>(hash);
+}
+
+namespace libsiedler2 {
+namespace {
+    /// Process wide table of all palettes currently shared between items
+    class PaletteCache
+    {
+    public:
+        template<class T_Creator>
+        std::shared_ptr<const ArchivItem_Palette> get(const ArchivItem_Palette& palette, T_Creator&& createPalette)
+        {
+            const size_t hash = palette.getHash();
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto range = palettes_.equal_range(hash);
+            for(auto it = range.first; it != range.second; ++it)
+            {
+                auto existing = it->second.lock();
+                if(existing && *existing == palette && existing->getName() == palette.getName())
+                    return existing;
+            }
+            removeExpired();
+            std::shared_ptr<const ArchivItem_Palette> result = createPalette();
+            palettes_.emplace(hash, result);
+            return result;
+        }
+
+    private:
+        void removeExpired()
+        {
+            if(palettes_.size() < purgeSize_)
+                return;
+            for(auto it = palettes_.begin(); it != palettes_.end();)
+            {
+                if(it->second.expired())
+                    it = palettes_.erase(it);
+                else
+                    ++it;
+            }
+            purgeSize_ = std::max<size_t>(64, palettes_.size() * 2);
+        }
+
+        std::mutex mutex_;
+        std::unordered_multimap<size_t, std::weak_ptr<const ArchivItem_Palette>> palettes_;
+        size_t purgeSize_ = 64;
+    };
+
+    PaletteCache& getPaletteCache()
+    {
+        static PaletteCache cache;
+        return cache;
+    }
+} // namespace
+
+std::shared_ptr<const ArchivItem_Palette> internPalette(const ArchivItem_Palette& palette)
+{
+    return getPaletteCache().get(palette, [&palette]() { return std::make_shared<ArchivItem_Palette>(palette); });
+}
+
+std::shared_ptr<const ArchivItem_Palette> internPalette(std::unique_ptr<ArchivItem_Palette> palette)
+{
+    if(!palette)
+        return nullptr;
+    const ArchivItem_Palette& pal = *palette;
+    return getPaletteCache().get(pal, [&palette]() {
+        return std::shared_ptr<const ArchivItem_Palette>(std::move(palette));
+    });
+}
+} // namespace libsiedler2
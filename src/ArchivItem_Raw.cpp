@@ -43,8 +43,9 @@ int ArchivItem_Raw::load(std::istream& file, uint32_t length)
             return ErrorCode::UNEXPECTED_EOF;
     }
 
-    data.resize(length);
-    fs >> data;
+    std::vector<uint8_t> newData(length);
+    fs >> newData;
+    data = CopyOnWrite<std::vector<uint8_t>>(std::move(newData));
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
@@ -66,10 +67,10 @@ int ArchivItem_Raw::write(std::ostream& file, bool with_length) const
     if(with_length)
     {
         // Convert to uint32_t first
-        fs << static_cast<uint32_t>(data.size());
+        fs << static_cast<uint32_t>(data.get().size());
     }
 
-    fs << data;
+    fs << data.get();
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
@@ -79,7 +80,7 @@ int ArchivItem_Raw::write(std::ostream& file, bool with_length) const
  */
 const std::vector<uint8_t>& ArchivItem_Raw::getData() const
 {
-    return data;
+    return data.get();
 }
 
 /**
@@ -87,7 +88,7 @@ const std::vector<uint8_t>& ArchivItem_Raw::getData() const
  */
 std::vector<uint8_t>& ArchivItem_Raw::getData()
 {
-    return data;
+    return data.getMutable();
 }
 
 /**
@@ -95,6 +96,6 @@ std::vector<uint8_t>& ArchivItem_Raw::getData()
  */
 void ArchivItem_Raw::clear()
 {
-    data.clear();
+    data.reset();
 }
 } // namespace libsiedler2
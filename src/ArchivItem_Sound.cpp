@@ -4,9 +4,12 @@
 
 #include "ArchivItem_Sound.h"
 #include "IAllocator.h"
+#include "SharedBytes.h"
 #include "fileFormatHelpers.h"
 #include "libsiedler2.h"
 #include "libendian/EndianIStreamAdapter.h"
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 #include <iostream>
 
 namespace libsiedler2 {
@@ -19,14 +22,11 @@ ArchivItem_Sound::ArchivItem_Sound(SoundType soundType) : ArchivItem(BobType::So
 
 ArchivItem_Sound::~ArchivItem_Sound() = default;
 
-/**
- *  liefert den Typ des Sounds.
- *
- *  @return Der eingestellte Typ
- */
-SoundType ArchivItem_Sound::getType() const
+int ArchivItem_Sound::loadShared(const SharedBytes& source)
 {
-    return soundType_;
+    boost::iostreams::stream<boost::iostreams::array_source> file(reinterpret_cast<const char*>(source.data()),
+                                                                  source.size());
+    return load(file, static_cast<uint32_t>(source.size()));
 }
 
 std::unique_ptr<ArchivItem_Sound> ArchivItem_Sound::findSubType(std::istream& file)
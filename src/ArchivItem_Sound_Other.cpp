@@ -7,6 +7,7 @@
 #include "libendian/EndianIStreamAdapter.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <iostream>
+#include <stdexcept>
 
 namespace libsiedler2 {
 /** @class baseArchivItem_Sound_Other
@@ -14,7 +15,12 @@ namespace libsiedler2 {
  *  Klasse für Other-Sounds.
  */
 
-ArchivItem_Sound_Other::ArchivItem_Sound_Other(SoundType sndType) : ArchivItem_Sound(sndType) {}
+ArchivItem_Sound_Other::ArchivItem_Sound_Other(SoundType sndType) : ArchivItem_Sound(sndType)
+{
+    // Those types have their own classes and item_cast relies on that
+    if(sndType == SoundType::Wave || sndType == SoundType::Midi || sndType == SoundType::XMidi)
+        throw std::invalid_argument("Sound type requires its own class");
+}
 
 /**
  *  lädt die Daten aus einer Datei.
@@ -31,14 +37,23 @@ int ArchivItem_Sound_Other::load(std::istream& file, uint32_t length)
     if(length == 0)
         return ErrorCode::WRONG_HEADER;
 
-    data.resize(length);
+    std::vector<uint8_t> newData(length);
     libendian::EndianIStreamAdapter<false, std::istream&> fs(file);
 
-    fs >> data;
+    fs >> newData;
+    data = SharedBytes(std::move(newData));
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
 
+int ArchivItem_Sound_Other::loadShared(const SharedBytes& source)
+{
+    if(source.empty())
+        return ErrorCode::WRONG_HEADER;
+    data = source;
+    return ErrorCode::NONE;
+}
+
 /**
  *  schreibt die Daten in eine Datei.
  *
@@ -52,7 +67,7 @@ int ArchivItem_Sound_Other::write(std::ostream& file) const
         return ErrorCode::FILE_NOT_ACCESSIBLE;
 
     libendian::EndianOStreamAdapter<false, std::ostream&> fs(file);
-    fs << data;
+    fs.write(data.data(), data.size());
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
@@ -62,6 +77,6 @@ int ArchivItem_Sound_Other::write(std::ostream& file) const
  */
 void ArchivItem_Sound_Other::clear()
 {
-    data.resize(0);
+    data = SharedBytes();
 }
 } // namespace libsiedler2
@@ -3,14 +3,113 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "ArchivItem_Sound_Wave.h"
+#include "Archiv.h"
 #include "ErrorCodes.h"
+#include "PcmConversion.h"
 #include "WAV_Header.h"
 #include "fileFormatHelpers.h"
+#include "itemCast.h"
+#include "parallelFor.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include "libendian/EndianOStreamAdapter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <memory>
 
 namespace libsiedler2 {
+
+namespace {
+    bool isSupportedPcm(const WAV_Header& header)
+    {
+        return header.fmtTag == 1u && (header.bitsPerSample == 8u || header.bitsPerSample == 16u)
+               && (header.numChannels == 1u || header.numChannels == 2u) && header.samplesPerSec > 0u;
+    }
+
+    /// Decode the samples into one float buffer per target channel. Stereo is mixed down to mono if required
+    std::vector<std::vector<float>> decodeChannels(const WAV_Header& header, span<const uint8_t> data,
+                                                   uint16_t numChannels)
+    {
+        const unsigned bytesPerSample = header.bitsPerSample / 8u;
+        const unsigned numSrcChannels = header.numChannels;
+        const size_t numFrames = data.size() / (bytesPerSample * numSrcChannels);
+        std::vector<std::vector<float>> channels(numSrcChannels, std::vector<float>(numFrames));
+        for(unsigned c = 0; c < numSrcChannels; c++)
+        {
+            float* out = channels[c].data();
+            if(bytesPerSample == 1u)
+            {
+                // Unsigned, 128 is silence
+                const uint8_t* in = &data[c];
+                for(size_t i = 0; i < numFrames; i++)
+                    out[i] = (static_cast<int>(in[i * numSrcChannels]) - 128) * (1.f / 128.f);
+            } else
+            {
+                // Signed little endian
+                const uint8_t* in = &data[c * 2u];
+                for(size_t i = 0; i < numFrames; i++)
+                {
+                    const size_t pos = i * numSrcChannels * 2u;
+                    const auto sample = static_cast<int16_t>(in[pos] | (in[pos + 1] << 8));
+                    out[i] = sample * (1.f / 32768.f);
+                }
+            }
+        }
+        if(numSrcChannels == 2u && numChannels == 1u)
+        {
+            for(size_t i = 0; i < numFrames; i++)
+                channels[0][i] = (channels[0][i] + channels[1][i]) * 0.5f;
+            channels.pop_back();
+        }
+        return channels;
+    }
+
+    /// Convert to interleaved floats. The resampler must match the rates or be nullptr if they are equal
+    int convertToFloat(const ArchivItem_Sound_Wave& sound, const PcmFormat& format,
+                       const PolyphaseResampler* resampler, std::vector<float>& samples)
+    {
+        samples.clear();
+        if(!isSupportedPcm(sound.getHeader()) || (format.numChannels != 1u && format.numChannels != 2u))
+            return ErrorCode::UNSUPPORTED_FORMAT;
+        std::vector<std::vector<float>> channels =
+          decodeChannels(sound.getHeader(), sound.getData(), format.numChannels);
+        if(resampler)
+        {
+            std::vector<float> resampled;
+            for(std::vector<float>& channel : channels)
+            {
+                resampled.clear();
+                resampler->process(channel, resampled);
+                channel.swap(resampled);
+            }
+        }
+        const size_t numFrames = channels[0].size();
+        samples.resize(numFrames * format.numChannels);
+        if(format.numChannels == 1u)
+            std::copy(channels[0].begin(), channels[0].end(), samples.begin());
+        else
+        {
+            // Mono is duplicated to both channels
+            const std::vector<float>& left = channels.front();
+            const std::vector<float>& right = channels.back();
+            for(size_t i = 0; i < numFrames; i++)
+            {
+                samples[i * 2u] = left[i];
+                samples[i * 2u + 1u] = right[i];
+            }
+        }
+        return ErrorCode::NONE;
+    }
+
+    std::unique_ptr<PolyphaseResampler> createResampler(uint32_t inRate, uint32_t outRate)
+    {
+        if(inRate == outRate)
+            return nullptr;
+        return std::make_unique<PolyphaseResampler>(inRate, outRate);
+    }
+} // namespace
 /** @class baseArchivItem_Sound_Wave
  *
  *  Klasse für WAVE-Sounds.
@@ -51,29 +150,56 @@ int ArchivItem_Sound_Wave::load(std::istream& file, uint32_t length)
             return ErrorCode::WRONG_HEADER;
         length -= sizeof(header);
     } else
-    {
-        setChunkId(header.RIFF_ID, "RIFF");
-        header.fileSize = length + sizeof(header);
-        setChunkId(header.WAVE_ID, "WAVE");
-        setChunkId(header.fmt_ID, "fmt ");
-        // Hard coded guesses for the format
-        header.fmtSize = 16;
-        header.fmtTag = 1;
-        header.numChannels = 1;
-        header.samplesPerSec = 11025;
-        header.bytesPerSec = 11025;
-        header.frameSize = 1;
-        header.bitsPerSample = 8;
-        setChunkId(header.data_ID, "data");
-        header.dataSize = length;
-    }
+        setHeaderlessFormat(length);
 
-    data.resize(length);
-    fs >> data;
+    std::vector<uint8_t> newData(length);
+    fs >> newData;
+    data = SharedBytes(std::move(newData));
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
 
+int ArchivItem_Sound_Wave::loadShared(const SharedBytes& source)
+{
+    const auto length = static_cast<uint32_t>(source.size());
+    // Same detection as in load
+    bool hasHeader = false;
+    if(length >= sizeof(header))
+    {
+        std::array<char, 4> headerId;
+        std::memcpy(headerId.data(), source.data(), headerId.size());
+        hasHeader = isChunk(headerId, "FORM") || isChunk(headerId, "RIFF");
+    }
+    if(hasHeader)
+    {
+        std::memcpy(&header, source.data(), sizeof(header));
+        data = source.subView(sizeof(header), length - sizeof(header));
+    } else
+    {
+        setHeaderlessFormat(length);
+        data = source;
+    }
+    return ErrorCode::NONE;
+}
+
+void ArchivItem_Sound_Wave::setHeaderlessFormat(uint32_t length)
+{
+    setChunkId(header.RIFF_ID, "RIFF");
+    header.fileSize = length + sizeof(header);
+    setChunkId(header.WAVE_ID, "WAVE");
+    setChunkId(header.fmt_ID, "fmt ");
+    // Hard coded guesses for the format
+    header.fmtSize = 16;
+    header.fmtTag = 1;
+    header.numChannels = 1;
+    header.samplesPerSec = 11025;
+    header.bytesPerSec = 11025;
+    header.frameSize = 1;
+    header.bitsPerSample = 8;
+    setChunkId(header.data_ID, "data");
+    header.dataSize = length;
+}
+
 /**
  *  schreibt die Wave-Daten in eine Datei.
  *
@@ -92,7 +218,7 @@ int ArchivItem_Sound_Wave::write(std::ostream& file, bool stripheader) const
     if(!stripheader)
         fs.writeRaw(&header, 1);
 
-    fs << data;
+    fs.write(data.data(), data.size());
 
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
@@ -102,6 +228,60 @@ int ArchivItem_Sound_Wave::write(std::ostream& file, bool stripheader) const
  */
 void ArchivItem_Sound_Wave::clear()
 {
-    data.clear();
+    data = SharedBytes();
+}
+
+int ArchivItem_Sound_Wave::convert(const PcmFormat& format, std::vector<float>& samples) const
+{
+    if(!isSupportedPcm(header) || format.sampleRate == 0u)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+    const auto resampler = createResampler(header.samplesPerSec, format.sampleRate);
+    return convertToFloat(*this, format, resampler.get(), samples);
 }
+
+int ArchivItem_Sound_Wave::convert(const PcmFormat& format, std::vector<int16_t>& samples) const
+{
+    std::vector<float> floatSamples;
+    const int ec = convert(format, floatSamples);
+    samples.resize(floatSamples.size());
+    convertToInt16(floatSamples, samples.data());
+    return ec;
+}
+
+int convertAllWaves(const Archiv& archiv, const PcmFormat& format, std::vector<std::vector<float>>& buffers,
+                    unsigned numThreads)
+{
+    buffers.clear();
+    buffers.resize(archiv.size());
+    if(format.sampleRate == 0u)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+
+    // Filters are shared by all sounds with the same rate
+    std::vector<size_t> waveIndices;
+    std::map<uint32_t, std::unique_ptr<PolyphaseResampler>> resamplers;
+    for(size_t i = 0; i < archiv.size(); i++)
+    {
+        const auto* wave = item_cast<ArchivItem_Sound_Wave>(archiv[i]);
+        if(!wave)
+            continue;
+        waveIndices.push_back(i);
+        const uint32_t rate = wave->getHeader().samplesPerSec;
+        if(isSupportedPcm(wave->getHeader()) && !resamplers.count(rate))
+            resamplers[rate] = createResampler(rate, format.sampleRate);
+    }
+
+    std::atomic<int> firstError(ErrorCode::NONE);
+    parallelFor(waveIndices.size(), numThreads, [&](size_t i) {
+        const size_t idx = waveIndices[i];
+        const auto& wave = *item_cast<ArchivItem_Sound_Wave>(archiv[idx]);
+        const auto itResampler = resamplers.find(wave.getHeader().samplesPerSec);
+        const PolyphaseResampler* resampler = itResampler != resamplers.end() ? itResampler->second.get() : nullptr;
+        const int ec = convertToFloat(wave, format, resampler, buffers[idx]);
+        int expected = ErrorCode::NONE;
+        if(ec != ErrorCode::NONE)
+            firstError.compare_exchange_strong(expected, ec);
+    });
+    return firstError;
+}
+
 } // namespace libsiedler2
@@ -3,13 +3,20 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "ArchivItem_Sound_XMidi.h"
+#include "Archiv.h"
 #include "ErrorCodes.h"
 #include "XMIDI_TrackConverter.h"
 #include "fileFormatHelpers.h"
+#include "itemCast.h"
+#include "parallelFor.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include "libendian/EndianOStreamAdapter.h"
+#include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace libsiedler2 {
 
@@ -18,8 +25,43 @@ namespace libsiedler2 {
  *  Klasse für XMIDI-Sounds.
  */
 
+namespace {
+    using TrackRef = std::pair<const ArchivItem_Sound_XMidi*, uint16_t>;
+
+    void collectTracks(const ArchivItem_Sound_XMidi& xmidi, std::vector<TrackRef>& tracks)
+    {
+        for(uint16_t i = 0; i < xmidi.getNumTracks(); i++)
+            tracks.emplace_back(&xmidi, i);
+    }
+
+    void collectTracks(const Archiv& archiv, std::vector<TrackRef>& tracks)
+    {
+        for(const auto& item : archiv)
+        {
+            if(const auto* xmidi = item_cast<ArchivItem_Sound_XMidi>(item.get()))
+                collectTracks(*xmidi, tracks);
+            else if(const auto* subArchiv = item_cast<Archiv>(item.get()))
+                collectTracks(*subArchiv, tracks);
+        }
+    }
+
+    /// Convert all tracks in parallel. Rethrows the first error after all threads are done
+    void convertTracks(const std::vector<TrackRef>& tracks, unsigned numThreads)
+    {
+        parallelFor(tracks.size(), numThreads,
+                    [&tracks](size_t i) { tracks[i].first->getMidiTrack(tracks[i].second); });
+    }
+} // namespace
+
 ArchivItem_Sound_XMidi::ArchivItem_Sound_XMidi() : ArchivItem_Sound(SoundType::XMidi), numTracks(0), ppqs(60) {}
 
+ArchivItem_Sound_XMidi::ArchivItem_Sound_XMidi(const ArchivItem_Sound_XMidi& other)
+    : ArchivItem_Sound(other), numTracks(other.numTracks), ppqs(other.ppqs), tracklist(other.tracklist)
+{
+    std::lock_guard<std::mutex> lock(other.midiMutex_);
+    midiTracklist = other.midiTracklist;
+}
+
 int ArchivItem_Sound_XMidi::load(std::istream& file, uint32_t length)
 {
     if(!file)
@@ -187,29 +229,39 @@ int ArchivItem_Sound_XMidi::write(std::ostream& file) const
     return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
 
-bool ArchivItem_Sound_XMidi::isTrackConverted(uint16_t track) const
+bool ArchivItem_Sound_XMidi::isTrackConverted(uint16_t track, const std::unique_lock<std::mutex>& lock) const
 {
+    assert(lock.owns_lock() && lock.mutex() == &midiMutex_);
+    (void)lock;
     return track < midiTracklist.size() && !midiTracklist[track].getData().empty();
 }
 
-const MIDI_Track& ArchivItem_Sound_XMidi::getMidiTrack(uint16_t trackIdx)
+const MIDI_Track& ArchivItem_Sound_XMidi::getMidiTrack(uint16_t trackIdx) const
 {
-    if(!isTrackConverted(trackIdx))
-        midiTracklist[trackIdx] = const_cast<const ArchivItem_Sound_XMidi*>(this)->getMidiTrack(trackIdx);
-    return midiTracklist[trackIdx];
-}
-
-MIDI_Track ArchivItem_Sound_XMidi::getMidiTrack(uint16_t trackIdx) const
-{
-    if(isTrackConverted(trackIdx))
-        return midiTracklist[trackIdx];
     const XMIDI_Track* origTrack = getTrack(trackIdx);
     if(!origTrack)
         throw std::out_of_range("Invalid XMidi track index");
+    std::unique_lock<std::mutex> lock(midiMutex_);
+    if(isTrackConverted(trackIdx, lock))
+        return midiTracklist[trackIdx];
+    // Convert without holding the lock so other tracks can be converted concurrently
+    lock.unlock();
     XMIDI_TrackConverter converter(*origTrack);
     if(!converter.Convert())
         throw std::runtime_error("Invalid XMIDI track detected");
-    return converter.CreateMidiTrack();
+    MIDI_Track midiTrack = converter.CreateMidiTrack();
+    lock.lock();
+    // Another thread might have been faster. Keep its result as references to it might already be in use
+    if(!isTrackConverted(trackIdx, lock))
+        midiTracklist[trackIdx] = std::move(midiTrack);
+    return midiTracklist[trackIdx];
+}
+
+void ArchivItem_Sound_XMidi::convertAllTracks(unsigned numThreads) const
+{
+    std::vector<TrackRef> tracks;
+    collectTracks(*this, tracks);
+    convertTracks(tracks, numThreads);
 }
 
 void ArchivItem_Sound_XMidi::addTrack(const XMIDI_Track& track)
@@ -219,4 +271,11 @@ void ArchivItem_Sound_XMidi::addTrack(const XMIDI_Track& track)
     tracklist[numTracks++] = track;
 }
 
+void convertAllXMidiTracks(const Archiv& archiv, unsigned numThreads)
+{
+    std::vector<TrackRef> tracks;
+    collectTracks(archiv, tracks);
+    convertTracks(tracks, numThreads);
+}
+
 } // namespace libsiedler2
@@ -5,7 +5,6 @@
 #include "ArchivItem_Text.h"
 #include "ErrorCodes.h"
 #include "oem.h"
-#include <boost/algorithm/string/replace.hpp>
 #include <cassert>
 #include <iostream>
 #include <limits>
@@ -75,19 +74,14 @@ std::string libsiedler2::ArchivItem_Text::getFileText(bool conversion) const
     if(!conversion)
         return text_;
 
-    const std::string convertedText = boost::replace_all_copy(text_, "\n", "@@");
-    assert(convertedText.find('\r') == std::string::npos);
-
-    return AnsiToOem(convertedText);
+    assert(text_.find('\r') == std::string::npos);
+    return AnsiTextToOem(text_);
 }
 
 void libsiedler2::ArchivItem_Text::setText(const std::string& text, bool convertFromOem)
 {
     if(convertFromOem)
-    {
-        text_ = OemToAnsi(text);
-        boost::replace_all(text_, "@@", "\n");
-    } else
-        text_ = boost::replace_all_copy(text, "\r\n", "\n");
-    boost::replace_all(text_, "\r", "\n");
+        text_ = OemTextToAnsi(text);
+    else
+        text_ = normalizeLineBreaks(text);
 }
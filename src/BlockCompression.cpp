@@ -0,0 +1,158 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "BlockCompression.h"
+#include "ErrorCodes.h"
+#include <algorithm>
+#include <cstring>
+
+/* Format: Sequence of
+ *  - Token: Upper 4 bits: Number of literals, lower 4 bits: Match length - minMatchLen
+ *  - If number of literals is 15: Extra bytes added to the length, continued while a byte is 255
+ *  - Literals
+ *  - Only if not at the end of the block:
+ *    - 2 byte offset (little endian) of the match relative to the current position
+ *    - If match length nibble is 15: Extra bytes like for the number of literals
+ * The last sequence consists of literals only.
+ */
+
+namespace libsiedler2 {
+
+namespace {
+    constexpr unsigned minMatchLen = 4;
+    constexpr unsigned maxOffset = 0xFFFF;
+    constexpr unsigned hashBits = 14;
+    constexpr unsigned lengthMask = 0x0F;
+
+    uint32_t read32(const uint8_t* data)
+    {
+        uint32_t result;
+        std::memcpy(&result, data, sizeof(result));
+        return result;
+    }
+
+    unsigned getHash(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - hashBits); }
+
+    void writeLength(std::vector<uint8_t>& out, size_t length)
+    {
+        for(; length >= 0xFF; length -= 0xFF)
+            out.push_back(0xFF);
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t numLiterals, size_t offset,
+                       size_t matchLen)
+    {
+        const size_t matchLenCode = matchLen ? matchLen - minMatchLen : 0u;
+        out.push_back(static_cast<uint8_t>((std::min<size_t>(numLiterals, lengthMask) << 4)
+                                           | std::min<size_t>(matchLenCode, lengthMask)));
+        if(numLiterals >= lengthMask)
+            writeLength(out, numLiterals - lengthMask);
+        out.insert(out.end(), literals, literals + numLiterals);
+        if(!matchLen)
+            return;
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if(matchLenCode >= lengthMask)
+            writeLength(out, matchLenCode - lengthMask);
+    }
+
+    bool readLength(const uint8_t*& in, const uint8_t* inEnd, size_t& length)
+    {
+        uint8_t value;
+        do
+        {
+            if(in == inEnd)
+                return false;
+            value = *in++;
+            length += value;
+        } while(value == 0xFF);
+        return true;
+    }
+} // namespace
+
+std::vector<uint8_t> compressBlock(span<const uint8_t> data)
+{
+    std::vector<uint8_t> result;
+    result.reserve(data.size() / 4u + 16u);
+    const uint8_t* const src = data.data();
+    const size_t size = data.size();
+    size_t literalStart = 0;
+    if(size >= minMatchLen)
+    {
+        // Last position of each hashed 4 byte sequence + 1 (0 = none)
+        std::vector<uint32_t> lastPos(size_t(1) << hashBits, 0u);
+        const size_t lastMatchStart = size - minMatchLen;
+        size_t pos = 0;
+        while(pos <= lastMatchStart)
+        {
+            const uint32_t sequence = read32(src + pos);
+            uint32_t& entry = lastPos[getHash(sequence)];
+            const size_t candidate = entry;
+            entry = static_cast<uint32_t>(pos + 1u);
+            if(candidate == 0u || pos + 1u - candidate > maxOffset || read32(src + candidate - 1u) != sequence)
+            {
+                ++pos;
+                continue;
+            }
+            const size_t matchPos = candidate - 1u;
+            size_t matchLen = minMatchLen;
+            while(pos + matchLen < size && src[matchPos + matchLen] == src[pos + matchLen])
+                ++matchLen;
+            writeSequence(result, src + literalStart, pos - literalStart, pos - matchPos, matchLen);
+            pos += matchLen;
+            literalStart = pos;
+        }
+    }
+    writeSequence(result, src + literalStart, size - literalStart, 0, 0);
+    return result;
+}
+
+int decompressBlock(span<const uint8_t> compressed, span<uint8_t> output)
+{
+    const uint8_t* in = compressed.data();
+    const uint8_t* const inEnd = in + compressed.size();
+    uint8_t* out = output.data();
+    uint8_t* const outEnd = out + output.size();
+    while(in < inEnd)
+    {
+        const uint8_t token = *in++;
+        size_t numLiterals = token >> 4;
+        if(numLiterals == lengthMask && !readLength(in, inEnd, numLiterals))
+            return ErrorCode::UNEXPECTED_EOF;
+        if(numLiterals > static_cast<size_t>(inEnd - in) || numLiterals > static_cast<size_t>(outEnd - out))
+            return ErrorCode::WRONG_FORMAT;
+        std::memcpy(out, in, numLiterals);
+        in += numLiterals;
+        out += numLiterals;
+        if(in == inEnd)
+            break;
+
+        if(inEnd - in < 2)
+            return ErrorCode::UNEXPECTED_EOF;
+        const size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        size_t matchLen = token & lengthMask;
+        if(matchLen == lengthMask && !readLength(in, inEnd, matchLen))
+            return ErrorCode::UNEXPECTED_EOF;
+        matchLen += minMatchLen;
+        if(offset == 0u || offset > static_cast<size_t>(out - output.data())
+           || matchLen > static_cast<size_t>(outEnd - out))
+            return ErrorCode::WRONG_FORMAT;
+        const uint8_t* match = out - offset;
+        if(offset >= matchLen)
+        {
+            std::memcpy(out, match, matchLen);
+            out += matchLen;
+        } else
+        {
+            // Overlapping: Repeats the last offset bytes
+            for(size_t i = 0; i < matchLen; i++)
+                *out++ = *match++;
+        }
+    }
+    return (out == outEnd) ? ErrorCode::NONE : ErrorCode::UNEXPECTED_EOF;
+}
+
+} // namespace libsiedler2
@@ -0,0 +1,231 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "BobCompositor.h"
+#include "ArchivItem_Bitmap_Player.h"
+#include "ArchivItem_Bob.h"
+#include "ErrorCodes.h"
+#include "parallelFor.h"
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <unordered_set>
+
+namespace libsiedler2 {
+
+namespace {
+    /// Links form an array [overlay][animStep=8][fat=2][direction=6]
+    constexpr unsigned NUM_LINKS_PER_OVERLAY = 8 * 2 * 6;
+} // namespace
+
+BobCompositor::BobCompositor(const ArchivItem_Bob& bob, const ArchivItem_Palette& palette, size_t memoryBudget)
+    : bob_(bob), palette_(palette), memoryBudget_(memoryBudget)
+{}
+
+uint64_t BobCompositor::toId(const Key& key)
+{
+    return (static_cast<uint64_t>(key.plClrStartIdx) << 32) | (static_cast<uint64_t>(key.overlayIdx) << 16)
+           | (static_cast<uint64_t>(key.animationstep) << 4) | (static_cast<uint64_t>(key.direction) << 1)
+           | static_cast<uint64_t>(key.fat);
+}
+
+int BobCompositor::compose(const Key& key, Sprite& sprite) const
+{
+    if(key.animationstep >= 8u || static_cast<unsigned>(key.direction) >= 6u)
+        return ErrorCode::WRONG_ARCHIVE;
+    std::vector<unsigned> layers{ArchivItem_Bob::getBodyIdx(key.fat, key.direction, key.animationstep)};
+    if(key.overlayIdx != NO_OVERLAY)
+    {
+        if(key.overlayIdx >= bob_.getNumLinks() / NUM_LINKS_PER_OVERLAY)
+            return ErrorCode::WRONG_ARCHIVE;
+        layers.push_back(bob_.getOverlayIdx(key.overlayIdx, key.fat, key.direction, key.animationstep));
+    }
+
+    // Area covered by all layers relative to the draw position
+    int left = std::numeric_limits<int>::max(), top = std::numeric_limits<int>::max();
+    int right = std::numeric_limits<int>::min(), bottom = std::numeric_limits<int>::min();
+    for(unsigned idx : layers)
+    {
+        if(!bob_.hasImage(idx))
+            return ErrorCode::WRONG_ARCHIVE;
+        uint16_t width, height;
+        int16_t nx, ny;
+        bob_.getImageInfo(idx, width, height, nx, ny);
+        left = std::min(left, -nx);
+        top = std::min(top, -ny);
+        right = std::max(right, width - nx);
+        bottom = std::max(bottom, height - ny);
+    }
+    const auto width = static_cast<uint16_t>(right - left), height = static_cast<uint16_t>(bottom - top);
+
+    const bool separatePlayerClrs = key.plClrStartIdx == SEPARATE_PLAYER_CLRS;
+    PixelBufferBGRA canvas(width, height);
+    PixelBufferPaletted playerColors;
+    if(separatePlayerClrs)
+        playerColors = PixelBufferPaletted(width, height, ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX);
+    PixelBufferBGRA layer(width, height);
+    PixelBufferPaletted layerPlayerColors;
+    for(unsigned idx : layers)
+    {
+        uint16_t layerWidth, layerHeight;
+        int16_t nx, ny;
+        bob_.getImageInfo(idx, layerWidth, layerHeight, nx, ny);
+        const auto toX = static_cast<uint16_t>(-nx - left), toY = static_cast<uint16_t>(-ny - top);
+        std::fill(layer.getPixels().begin(), layer.getPixels().end(), ColorBGRA());
+        if(int ec = bob_.printImage(idx, layer.getPixelPtr(), width, height, TextureFormat::BGRA, &palette_,
+                                    separatePlayerClrs ? 128 : key.plClrStartIdx, toX, toY))
+            return ec;
+        if(separatePlayerClrs)
+        {
+            layerPlayerColors =
+              PixelBufferPaletted(width, height, ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX);
+            if(int ec = bob_.printImage(idx, layerPlayerColors.getPixelPtr(), width, height, TextureFormat::Paletted,
+                                        &palette_, 0, toX, toY, true))
+                return ec;
+        }
+        // Each layer replaces the pixels below it
+        for(uint32_t i = 0; i < canvas.getNumPixels(); i++)
+        {
+            if(layer.get(i).getAlpha() == 0)
+                continue;
+            canvas.set(i, layer.get(i));
+            if(separatePlayerClrs)
+                playerColors.set(i, layerPlayerColors.get(i));
+        }
+    }
+
+    // Trim to the visible area
+    uint16_t minX = width, minY = height, maxX = 0, maxY = 0;
+    for(uint16_t y = 0; y < height; y++)
+    {
+        for(uint16_t x = 0; x < width; x++)
+        {
+            if(canvas.get(x, y).getAlpha() == 0)
+                continue;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max<uint16_t>(maxX, x + 1u);
+            maxY = std::max<uint16_t>(maxY, y + 1u);
+        }
+    }
+    if(minX >= maxX)
+        minX = maxX = minY = maxY = 0;
+
+    sprite.pixels = PixelBufferBGRA(maxX - minX, maxY - minY);
+    sprite.playerColors = separatePlayerClrs && minX < maxX ?
+                            PixelBufferPaletted(maxX - minX, maxY - minY,
+                                                ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX) :
+                            PixelBufferPaletted();
+    for(uint16_t y = minY; y < maxY; y++)
+    {
+        for(uint16_t x = minX; x < maxX; x++)
+        {
+            sprite.pixels.set(x - minX, y - minY, canvas.get(x, y));
+            if(sprite.hasPlayerColors())
+                sprite.playerColors.set(x - minX, y - minY, playerColors.get(x, y));
+        }
+    }
+    sprite.nx = static_cast<int16_t>(-(left + minX));
+    sprite.ny = static_cast<int16_t>(-(top + minY));
+    return ErrorCode::NONE;
+}
+
+const BobCompositor::Sprite* BobCompositor::get(const Key& key)
+{
+    const uint64_t id = toId(key);
+    const auto it = spriteMap_.find(id);
+    if(it != spriteMap_.end())
+    {
+        // Mark as most recently used
+        sprites_.splice(sprites_.begin(), sprites_, it->second);
+        return &it->second->sprite;
+    }
+    Sprite sprite;
+    if(compose(key, sprite) != ErrorCode::NONE)
+        return nullptr;
+    return insert(id, std::move(sprite));
+}
+
+const BobCompositor::Sprite* BobCompositor::insert(uint64_t id, Sprite&& sprite)
+{
+    const size_t size = sprite.getMemorySize();
+    // A sprite larger than the budget is still returned and removed on the next insert
+    evict(memoryBudget_ > size ? memoryBudget_ - size : 0u);
+    sprites_.push_front(CacheEntry{id, std::move(sprite)});
+    spriteMap_[id] = sprites_.begin();
+    memoryUsage_ += size;
+    return &sprites_.front().sprite;
+}
+
+void BobCompositor::evict(size_t budget)
+{
+    while(memoryUsage_ > budget && !sprites_.empty())
+    {
+        memoryUsage_ -= sprites_.back().sprite.getMemorySize();
+        spriteMap_.erase(sprites_.back().key);
+        sprites_.pop_back();
+    }
+}
+
+int BobCompositor::warmUp(const std::vector<Key>& keys, unsigned numThreads)
+{
+    std::vector<Key> missingKeys;
+    std::vector<uint64_t> ids;
+    std::unordered_set<uint64_t> usedIds;
+    for(const Key& key : keys)
+    {
+        const uint64_t id = toId(key);
+        if(!spriteMap_.count(id) && usedIds.insert(id).second)
+        {
+            missingKeys.push_back(key);
+            ids.push_back(id);
+        }
+    }
+
+    // Compose in chunks and stop once the sprites of the first keys fill the budget, as the ones of the later keys
+    // would be evicted right away. So at most one chunk of sprites exceeds the budget.
+    if(numThreads == 0u)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunkSize = size_t(numThreads) * 4u;
+    std::vector<Sprite> sprites;
+    std::vector<int> errors;
+    size_t composedSize = 0;
+    while(sprites.size() < missingKeys.size() && composedSize < memoryBudget_)
+    {
+        const size_t start = sprites.size();
+        const size_t end = std::min(start + chunkSize, missingKeys.size());
+        sprites.resize(end);
+        errors.resize(end, ErrorCode::NONE);
+        parallelFor(end - start, numThreads,
+                    [&](size_t i) { errors[start + i] = compose(missingKeys[start + i], sprites[start + i]); });
+        for(size_t i = start; i < end; i++)
+            composedSize += sprites[i].getMemorySize();
+    }
+
+    // Add in reverse order so the first keys are the most recently used ones and evicted last
+    int firstError = ErrorCode::NONE;
+    for(size_t i = sprites.size(); i-- > 0u;)
+    {
+        if(errors[i] == ErrorCode::NONE)
+            insert(ids[i], std::move(sprites[i]));
+        else
+            firstError = errors[i];
+    }
+    return firstError;
+}
+
+void BobCompositor::clear()
+{
+    sprites_.clear();
+    spriteMap_.clear();
+    memoryUsage_ = 0;
+}
+
+void BobCompositor::setMemoryBudget(size_t memoryBudget)
+{
+    memoryBudget_ = memoryBudget;
+    evict(memoryBudget_);
+}
+
+} // namespace libsiedler2
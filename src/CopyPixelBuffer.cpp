@@ -23,25 +23,31 @@ void clipValues(uint16_t& offset, uint16_t& size, const uint16_t maxSize)
     }
 }
 
-bool isTransparent(const PixelBufferBGRARef&, const uint32_t* pixelPtr)
+template<typename T>
+bool isTransparent(const PixelBufferRefBase<T>&, const uint32_t* pixelPtr)
 {
     return ColorBGRA::fromBGRA(pixelPtr).getAlpha() == 0;
 }
-bool isTransparent(const PixelBufferPalettedRef& buffer, const uint8_t* pixelPtr)
+template<typename T>
+bool isTransparent(const PixelBufferPalettedRefBase<T>& buffer, const uint8_t* pixelPtr)
 {
     return buffer.getPalette().isTransparent(*pixelPtr);
 }
 
-template<class T_Buf, typename T>
-void copyPixel(const T_Buf&, const T_Buf&, const T* srcPtr, T* dstPtr)
+template<class T_Src, class T_Dst, typename T>
+void copyPixel(const T_Src&, const T_Dst&, const T* srcPtr, T* dstPtr)
 {
     *dstPtr = *srcPtr;
 }
-void copyPixel(const PixelBufferPalettedRef& src, const PixelBufferBGRARef&, const uint8_t* srcPtr, uint32_t* dstPtr)
+template<typename T_Src, typename T_Dst>
+void copyPixel(const PixelBufferPalettedRefBase<T_Src>& src, const PixelBufferRefBase<T_Dst>&, const uint8_t* srcPtr,
+               uint32_t* dstPtr)
 {
     ColorBGRA(src.getPalette().get(*srcPtr)).toBGRA(dstPtr);
 }
-void copyPixel(const PixelBufferBGRARef&, const PixelBufferPalettedRef& dst, const uint32_t* srcPtr, uint8_t* dstPtr)
+template<typename T_Src, typename T_Dst>
+void copyPixel(const PixelBufferRefBase<T_Src>&, const PixelBufferPalettedRefBase<T_Dst>& dst, const uint32_t* srcPtr,
+               uint8_t* dstPtr)
 {
     *dstPtr = dst.getPalette().lookup(ColorBGRA::fromBGRA(srcPtr));
 }
@@ -89,4 +95,8 @@ template void CopyPixelBuffer(const PixelBufferPalettedRef&, PixelBufferPaletted
 template void CopyPixelBuffer(const PixelBufferBGRARef&, PixelBufferPalettedRef&, Rect, Rect);
 template void CopyPixelBuffer(const PixelBufferPalettedRef&, PixelBufferBGRARef&, Rect, Rect);
 template void CopyPixelBuffer(const PixelBufferBGRARef&, PixelBufferBGRARef&, Rect, Rect);
+template void CopyPixelBuffer(const PixelBufferPalettedConstRef&, PixelBufferPalettedRef&, Rect, Rect);
+template void CopyPixelBuffer(const PixelBufferBGRAConstRef&, PixelBufferPalettedRef&, Rect, Rect);
+template void CopyPixelBuffer(const PixelBufferPalettedConstRef&, PixelBufferBGRARef&, Rect, Rect);
+template void CopyPixelBuffer(const PixelBufferBGRAConstRef&, PixelBufferBGRARef&, Rect, Rect);
 } // namespace libsiedler2
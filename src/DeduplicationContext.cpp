@@ -0,0 +1,127 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DeduplicationContext.h"
+#include "Archiv.h"
+#include "ArchivItem_BitmapBase.h"
+#include "ArchivItem_Bitmap_Player.h"
+#include "ArchivItem_Bob.h"
+#include "ArchivItem_Font.h"
+#include "itemCast.h"
+#include <cstring>
+
+namespace libsiedler2 {
+
+uint64_t DeduplicationContext::getHash(const std::vector<uint8_t>& data)
+{
+    // Multiplicative hash processing 8 bytes at a time. Collisions are resolved by comparing the data
+    constexpr uint64_t prime = 0x9E3779B97F4A7C15u;
+    uint64_t hash = data.size() * prime;
+    const uint8_t* ptr = data.data();
+    const uint8_t* const end = ptr + data.size();
+    for(; end - ptr >= 8; ptr += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, ptr, sizeof(word));
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    uint64_t lastWord = 0;
+    if(ptr != end)
+        std::memcpy(&lastWord, ptr, end - ptr);
+    hash = (hash ^ lastWord) * prime;
+    return hash ^ (hash >> 32);
+}
+
+namespace {
+    const std::vector<uint8_t>& getBytes(const std::vector<uint8_t>& data) { return data; }
+    const std::vector<uint8_t>& getBytes(const PixelBufferPaletted& data) { return data.getPixels(); }
+    bool isEqual(const std::vector<uint8_t>& lhs, const std::vector<uint8_t>& rhs) { return lhs == rhs; }
+    bool isEqual(const PixelBufferPaletted& lhs, const PixelBufferPaletted& rhs)
+    {
+        return lhs.getWidth() == rhs.getWidth() && lhs.getHeight() == rhs.getHeight()
+               && lhs.getPixels() == rhs.getPixels();
+    }
+} // namespace
+
+template<class T>
+bool DeduplicationContext::shareBuffer(CopyOnWrite<T>& buffer, BufferMap<T>& buffers)
+{
+    const std::vector<uint8_t>& data = getBytes(buffer.get());
+    if(data.empty())
+        return false;
+    const uint64_t hash = getHash(data);
+    const auto range = buffers.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(it->second.isSharedWith(buffer))
+            return false;
+        if(isEqual(it->second.get(), buffer.get()))
+        {
+            stats_.bytesSaved += data.size();
+            buffer = it->second;
+            return true;
+        }
+    }
+    buffers.emplace(hash, buffer);
+    ++stats_.numUniqueBuffers;
+    return false;
+}
+
+void DeduplicationContext::deduplicate(ArchivItem_BitmapBase& bitmap)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.numBitmaps;
+    bool isShared = shareBuffer(bitmap.pxlData_, buffers_);
+    if(auto* playerBmp = item_cast<ArchivItem_Bitmap_Player>(&bitmap))
+        isShared |= shareBuffer(playerBmp->tex_pdata, playerBuffers_);
+    if(isShared)
+        ++stats_.numShared;
+}
+
+void DeduplicationContext::deduplicate(ArchivItem& item)
+{
+    if(auto* bmp = item_cast<ArchivItem_BitmapBase>(&item))
+        deduplicate(*bmp);
+    else if(auto* bob = item_cast<ArchivItem_Bob>(&item))
+    {
+        // Images not yet decoded are skipped. They are only stored compressed, shared by all copies of the bob
+        for(unsigned i = 0; i < bob->size(); i++)
+        {
+            if(ArchivItem* image = bob->get(i))
+                deduplicate(*image);
+        }
+    } else if(auto* archive = item_cast<Archiv>(&item))
+        deduplicate(*archive);
+    else if(auto* font = item_cast<ArchivItem_Font>(&item))
+    {
+        for(const auto& glyph : font->getGlyphs())
+            deduplicate(*glyph.item);
+    }
+}
+
+void DeduplicationContext::deduplicate(Archiv& archive)
+{
+    for(size_t i = 0; i < archive.size(); i++)
+    {
+        if(ArchivItem* item = archive[i])
+            deduplicate(*item);
+    }
+}
+
+DeduplicationContext::Statistics DeduplicationContext::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DeduplicationContext::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.clear();
+    playerBuffers_.clear();
+    stats_ = Statistics();
+}
+
+} // namespace libsiedler2
@@ -0,0 +1,293 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "FontAtlas.h"
+#include "ArchivItem_Bitmap.h"
+#include "ArchivItem_Bitmap_Player.h"
+#include "ArchivItem_Font.h"
+#include "ErrorCodes.h"
+#include "itemCast.h"
+#include "oem.h"
+#include <algorithm>
+#include <string>
+
+namespace libsiedler2 {
+
+namespace {
+    constexpr uint32_t INVALID_CODEPOINT = 0xFFFFFFFF;
+
+    /// Decode the UTF-8 sequence at @p pos and advance it. Invalid sequences return INVALID_CODEPOINT (1 byte consumed)
+    uint32_t decodeUtf8(const uint8_t*& pos, const uint8_t* end)
+    {
+        const uint8_t c = *pos++;
+        if(c < 0x80)
+            return c;
+        unsigned numCont;
+        uint32_t codepoint;
+        if((c & 0xE0) == 0xC0)
+        {
+            numCont = 1;
+            codepoint = c & 0x1F;
+        } else if((c & 0xF0) == 0xE0)
+        {
+            numCont = 2;
+            codepoint = c & 0x0F;
+        } else if((c & 0xF8) == 0xF0)
+        {
+            numCont = 3;
+            codepoint = c & 0x07;
+        } else
+            return INVALID_CODEPOINT;
+        if(static_cast<size_t>(end - pos) < numCont)
+            return INVALID_CODEPOINT;
+        for(unsigned i = 0; i < numCont; i++)
+        {
+            if((pos[i] & 0xC0) != 0x80)
+                return INVALID_CODEPOINT;
+            codepoint = (codepoint << 6) | (pos[i] & 0x3F);
+        }
+        pos += numCont;
+        return codepoint;
+    }
+
+    /// Return the codepoint of the glyph at the given index of the font
+    uint32_t getCodepoint(const ArchivItem_Font& font, size_t idx)
+    {
+        if(font.isUnicode || idx < 0x80)
+            return static_cast<uint32_t>(idx);
+        const std::string utf8 = OemToUtf8(std::string(1, static_cast<char>(idx)));
+        const auto* pos = reinterpret_cast<const uint8_t*>(utf8.data());
+        return decodeUtf8(pos, pos + utf8.size());
+    }
+
+} // namespace
+
+FontAtlas::FontAtlas()
+{
+    clear();
+}
+
+void FontAtlas::clear()
+{
+    format_ = TextureFormat::BGRA;
+    width_ = height_ = 0;
+    lineHeight_ = 0;
+    pixels_.clear();
+    playerColors_.clear();
+    glyphs_.assign(1, Glyph{});
+    asciiGlyphs_.fill(0);
+    pageIdx_.clear();
+    pages_.assign(1, Page{});
+}
+
+void FontAtlas::addCodepoint(uint32_t codepoint, uint16_t glyphIdx)
+{
+    const unsigned page = codepoint >> 8;
+    if(page >= pageIdx_.size())
+        pageIdx_.resize(page + 1u, 0);
+    if(pageIdx_[page] == 0)
+    {
+        pageIdx_[page] = static_cast<uint16_t>(pages_.size());
+        pages_.push_back(Page{});
+    }
+    pages_[pageIdx_[page]][codepoint & 0xFF] = glyphIdx;
+    if(codepoint < asciiGlyphs_.size())
+        asciiGlyphs_[codepoint] = glyphIdx;
+}
+
+int FontAtlas::create(const ArchivItem_Font& font, TextureFormat format, const ArchivItem_Palette* palette,
+                      uint16_t maxWidth, uint8_t plClrStartIdx)
+{
+    clear();
+    lineHeight_ = font.getDy();
+
+    struct Entry
+    {
+        uint32_t codepoint;
+        const ArchivItem_BitmapBase* bmp;
+    };
+    std::vector<Entry> entries;
+    for(const ArchivItem_Font::Glyph& fontGlyph : font.getGlyphs())
+    {
+        const auto* bmp = item_cast<ArchivItem_BitmapBase>(fontGlyph.item.get());
+        const uint32_t codepoint = getCodepoint(font, fontGlyph.codepoint);
+        if(!bmp || codepoint == INVALID_CODEPOINT || codepoint > 0x10FFFF)
+            continue;
+        if(bmp->getWidth() + 2u > maxWidth)
+            return ErrorCode::WRONG_FORMAT;
+        entries.push_back(Entry{codepoint, bmp});
+    }
+    if(entries.size() >= 0xFFFF)
+        return ErrorCode::WRONG_FORMAT;
+    if(format == TextureFormat::Original)
+        format = entries.empty() ? TextureFormat::BGRA : entries.front().bmp->getFormat();
+    format_ = format;
+
+    // Shelf packing of the glyphs sorted by height with 1px transparent border to avoid bleeding when filtering
+    std::vector<const Entry*> sortedEntries(entries.size());
+    std::transform(entries.begin(), entries.end(), sortedEntries.begin(), [](const Entry& entry) { return &entry; });
+    std::stable_sort(sortedEntries.begin(), sortedEntries.end(), [](const Entry* lhs, const Entry* rhs) {
+        return lhs->bmp->getHeight() > rhs->bmp->getHeight();
+    });
+    glyphs_.resize(entries.size() + 1u);
+    uint16_t curX = 1, curY = 1, shelfHeight = 0, usedWidth = 0;
+    for(const Entry* entry : sortedEntries)
+    {
+        const uint16_t w = entry->bmp->getWidth(), h = entry->bmp->getHeight();
+        if(curX + w + 1u > maxWidth)
+        {
+            curX = 1;
+            curY += shelfHeight + 1u;
+            shelfHeight = 0;
+        }
+        // Keep the original order of the glyphs
+        Glyph& glyph = glyphs_[entry - entries.data() + 1u];
+        glyph.texX = curX;
+        glyph.texY = curY;
+        glyph.width = w;
+        glyph.height = h;
+        glyph.offsetX = static_cast<int16_t>(-entry->bmp->getNx());
+        glyph.offsetY = static_cast<int16_t>(-entry->bmp->getNy());
+        glyph.advance = static_cast<uint16_t>(w + font.getDx());
+        curX += w + 1u;
+        shelfHeight = std::max(shelfHeight, h);
+        usedWidth = std::max(usedWidth, curX);
+        // Start of the next shelf and the atlas height must fit into 16 bit
+        if(curY + shelfHeight + 1u > 0xFFFFu)
+        {
+            clear();
+            return ErrorCode::WRONG_FORMAT;
+        }
+    }
+    if(!entries.empty())
+    {
+        width_ = usedWidth;
+        height_ = curY + shelfHeight + 1u;
+    }
+
+    const size_t bbp = ArchivItem_BitmapBase::getBBP(format_);
+    const uint8_t transparentClr = format_ == TextureFormat::Paletted ? ArchivItem_Palette::DEFAULT_TRANSPARENT_IDX : 0;
+    pixels_.assign(static_cast<size_t>(width_) * height_ * bbp, transparentClr);
+    for(unsigned i = 0; i < entries.size(); i++)
+    {
+        const Glyph& glyph = glyphs_[i + 1u];
+        const ArchivItem_Palette* curPalette = palette ? palette : entries[i].bmp->getPalette();
+        int ec;
+        if(const auto* playerBmp = dynamic_cast<const ArchivItem_Bitmap_Player*>(entries[i].bmp))
+        {
+            ec = playerBmp->print(pixels_.data(), width_, height_, format_, curPalette, plClrStartIdx, glyph.texX,
+                                  glyph.texY);
+            for(uint16_t y = 0; y < glyph.height && !ec; y++)
+            {
+                for(uint16_t x = 0; x < glyph.width; x++)
+                {
+                    if(!playerBmp->isPlayerColor(x, y))
+                        continue;
+                    if(!hasPlayerColors())
+                        playerColors_ = PixelBufferPaletted(width_, height_,
+                                                            ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX);
+                    playerColors_.set(glyph.texX + x, glyph.texY + y, playerBmp->getPlayerColorIdx(x, y));
+                }
+            }
+        } else if(const auto* bmp = dynamic_cast<const baseArchivItem_Bitmap*>(entries[i].bmp))
+            ec = bmp->print(pixels_.data(), width_, height_, format_, curPalette, glyph.texX, glyph.texY);
+        else
+            ec = ErrorCode::WRONG_FORMAT;
+        if(ec)
+        {
+            clear();
+            return ec;
+        }
+        addCodepoint(entries[i].codepoint, static_cast<uint16_t>(i + 1u));
+    }
+
+    // Unknown chars are drawn as '?' if the font has it
+    if(getGlyph('?'))
+        glyphs_[0] = *getGlyph('?');
+    return ErrorCode::NONE;
+}
+
+template<class T_GlyphFunc, class T_NewLineFunc>
+void FontAtlas::forEachGlyph(std::string_view text, const T_GlyphFunc& glyphFunc,
+                             const T_NewLineFunc& newLineFunc) const
+{
+    const auto* pos = reinterpret_cast<const uint8_t*>(text.data());
+    const auto* const end = pos + text.size();
+    while(pos < end)
+    {
+        const uint8_t c = *pos;
+        if(c < 0x80)
+        {
+            // Fast path for ASCII
+            ++pos;
+            if(c == '\n')
+                newLineFunc();
+            else
+                glyphFunc(asciiGlyphs_[c]);
+        } else
+        {
+            const uint32_t codepoint = decodeUtf8(pos, end);
+            glyphFunc(codepoint == INVALID_CODEPOINT ? uint16_t(0) : getGlyphIdx(codepoint));
+        }
+    }
+}
+
+uint16_t FontAtlas::getGlyphIdx(uint32_t codepoint) const
+{
+    const unsigned page = codepoint >> 8;
+    return page < pageIdx_.size() ? pages_[pageIdx_[page]][codepoint & 0xFF] : 0;
+}
+
+const FontAtlas::Glyph* FontAtlas::getGlyph(uint32_t codepoint) const
+{
+    const uint16_t idx = getGlyphIdx(codepoint);
+    return idx ? &glyphs_[idx] : nullptr;
+}
+
+FontAtlas::TextExtent FontAtlas::measure(std::string_view text) const
+{
+    TextExtent result{0, 0, 1};
+    unsigned lineWidth = 0;
+    forEachGlyph(
+      text, [this, &lineWidth](uint16_t glyphIdx) { lineWidth += glyphs_[glyphIdx].advance; },
+      [&]() {
+          result.width = std::max(result.width, lineWidth);
+          lineWidth = 0;
+          ++result.numLines;
+      });
+    result.width = std::max(result.width, lineWidth);
+    result.height = result.numLines * lineHeight_;
+    return result;
+}
+
+FontAtlas::TextExtent FontAtlas::layout(std::string_view text, std::vector<GlyphQuad>& quads) const
+{
+    quads.clear();
+    // Most chars are drawn
+    quads.reserve(text.size());
+    TextExtent result{0, 0, 1};
+    int32_t curX = 0, curY = 0;
+    forEachGlyph(
+      text,
+      [this, &curX, &curY, &quads](uint16_t glyphIdx) {
+          const Glyph& glyph = glyphs_[glyphIdx];
+          if(glyph.width && glyph.height)
+          {
+              quads.push_back(GlyphQuad{curX + glyph.offsetX, curY + glyph.offsetY, glyph.texX, glyph.texY,
+                                        glyph.width, glyph.height});
+          }
+          curX += glyph.advance;
+      },
+      [&]() {
+          result.width = std::max(result.width, static_cast<unsigned>(curX));
+          curX = 0;
+          curY += lineHeight_;
+          ++result.numLines;
+      });
+    result.width = std::max(result.width, static_cast<unsigned>(curX));
+    result.height = result.numLines * lineHeight_;
+    return result;
+}
+
+} // namespace libsiedler2
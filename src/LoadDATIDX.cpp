@@ -7,9 +7,12 @@
 #include "ErrorCodes.h"
 #include "GetIStreamSize.h"
 #include "OpenMemoryStream.h"
+#include "libsiedler2.h"
 #include "prototypen.h"
 #include "libendian/EndianIStreamAdapter.h"
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <string_view>
 
 namespace bfs = boost::filesystem;
 
@@ -45,6 +48,7 @@ int libsiedler2::loader::LoadDATIDX(const boost::filesystem::path& filepath, Arc
         return ec;
 
     libendian::EndianIStreamAdapter<false, MMStream&> dat(mmapStream);
+    const SharedBytes fileData = getSoundDataMapping() ? getMappedData(mmapStream) : SharedBytes();
     libendian::EndianIStreamAdapter<false, MMStream&> idx(mmapStreamIdx);
 
     // Anzahl einlesen
@@ -90,12 +94,12 @@ int libsiedler2::loader::LoadDATIDX(const boost::filesystem::path& filepath, Arc
 
         // Daten von Item auswerten
         std::unique_ptr<ArchivItem> item;
-        if(int ec = LoadType(bobtype, dat.getStream(), item, palette))
+        if(int ec = LoadType(bobtype, dat.getStream(), item, palette, fileData.empty() ? nullptr : &fileData))
             return ec;
 
-        // Name setzen
+        // Name setzen (without the NULL padding)
         if(item)
-            item->setName(std::string(name.begin(), name.end()));
+            item->setName(std::string_view(name.data(), std::find(name.begin(), name.end(), '\0') - name.begin()));
         items.set(i, std::move(item));
     }
 
@@ -10,6 +10,7 @@
 #include "libsiedler2.h"
 #include "prototypen.h"
 #include <memory>
+#include <string_view>
 
 /**
  *  lädt eine INI-File in ein Archiv.
@@ -25,11 +26,14 @@ int libsiedler2::loader::LoadINI(const boost::filesystem::path& filepath, Archiv
     if(int ec = openMemoryStream(filepath, ini))
         return ec;
 
-    while(!ini.eof())
+    // Parse the mapped file in place
+    const SharedBytes data = getMappedData(ini);
+    std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+    while(!text.empty())
     {
         auto item = getAllocator().create<ArchivItem_Ini>(BobType::Ini);
 
-        if(int ec = item->load(ini))
+        if(int ec = item->load(text))
             return ec;
 
         items.push(std::move(item));
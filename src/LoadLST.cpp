@@ -6,6 +6,7 @@
 #include "ArchivItem.h"
 #include "ErrorCodes.h"
 #include "OpenMemoryStream.h"
+#include "libsiedler2.h"
 #include "prototypen.h"
 #include "libendian/EndianIStreamAdapter.h"
 
@@ -26,6 +27,7 @@ int libsiedler2::loader::LoadLST(const boost::filesystem::path& filepath, Archiv
         return ec;
 
     libendian::EndianIStreamAdapter<false, MMStream&> lst(mmapStream);
+    const SharedBytes fileData = getSoundDataMapping() ? getMappedData(mmapStream) : SharedBytes();
 
     uint16_t header;
     uint32_t count;
@@ -72,7 +74,7 @@ int libsiedler2::loader::LoadLST(const boost::filesystem::path& filepath, Archiv
 
         // Daten von Item auswerten
         std::unique_ptr<ArchivItem> item;
-        if(int ec = LoadType(bobtype, lst.getStream(), item, palette))
+        if(int ec = LoadType(bobtype, lst.getStream(), item, palette, fileData.empty() ? nullptr : &fileData))
             return ec;
         items.push(std::move(item));
     }
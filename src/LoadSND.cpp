@@ -7,6 +7,7 @@
 #include "ErrorCodes.h"
 #include "GetIStreamSize.h"
 #include "OpenMemoryStream.h"
+#include "libsiedler2.h"
 #include "prototypen.h"
 
 /**
@@ -28,9 +29,16 @@ int libsiedler2::loader::LoadSND(const boost::filesystem::path& filepath, Archiv
     if(!sound)
         return ErrorCode::WRONG_HEADER;
 
-    size_t size = getIStreamSize(snd);
-    if(int ec = sound->load(snd, static_cast<uint32_t>(size)))
-        return ec;
+    if(getSoundDataMapping())
+    {
+        if(int ec = sound->loadShared(getMappedData(snd)))
+            return ec;
+    } else
+    {
+        size_t size = getIStreamSize(snd);
+        if(int ec = sound->load(snd, static_cast<uint32_t>(size)))
+            return ec;
+    }
 
     items.clear();
     items.push(std::move(sound));
@@ -0,0 +1,35 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Archiv.h"
+#include "ArchivItem_Map.h"
+#include "ErrorCodes.h"
+#include "IAllocator.h"
+#include "OpenMemoryStream.h"
+#include "libsiedler2.h"
+#include "prototypen.h"
+
+/**
+ *  load a compressed map file into an archive.
+ *
+ *  @param[in]  filepath    Path to the SWZ file
+ *  @param[out] items   Archive to fill
+ *
+ *  @return Null on success, an ErrorCode otherwise
+ */
+int libsiedler2::loader::LoadSWZ(const boost::filesystem::path& filepath, Archiv& items)
+{
+    MMStream map;
+    if(int ec = openMemoryStream(filepath, map))
+        return ec;
+
+    auto item = getAllocator().create<ArchivItem_Map>(BobType::Map);
+    if(int ec = item->loadCompressed(map)) //-V522
+        return ec;
+
+    items.clear();
+    items.push(std::move(item));
+
+    return ErrorCode::NONE;
+}
@@ -13,8 +13,10 @@
 #include "ArchivItem_PaletteAnimation.h"
 #include "ArchivItem_Sound.h"
 #include "ArchivItem_Text.h"
+#include "DeduplicationContext.h"
 #include "ErrorCodes.h"
 #include "IAllocator.h"
+#include "SharedBytes.h"
 #include "libsiedler2.h"
 #include "prototypen.h"
 #include "libendian/EndianIStreamAdapter.h"
@@ -31,7 +33,7 @@
  *  @return Null bei Erfolg, ein Wert ungleich Null bei Fehler
  */
 int libsiedler2::loader::LoadType(BobType bobtype, std::istream& lst, std::unique_ptr<ArchivItem>& item,
-                                  const ArchivItem_Palette* palette)
+                                  const ArchivItem_Palette* palette, const SharedBytes* fileData)
 {
     if(!lst)
         return ErrorCode::FILE_NOT_ACCESSIBLE;
@@ -49,7 +51,16 @@ int libsiedler2::loader::LoadType(BobType bobtype, std::istream& lst, std::uniqu
                 auto nitem = ArchivItem_Sound::findSubType(lst);
                 if(!nitem)
                     return ErrorCode::WRONG_HEADER;
-                if(int ec = nitem->load(lst, length))
+                if(fileData)
+                {
+                    // Reference the data instead of reading it
+                    const long pos = fs.getPosition();
+                    if(!lst || pos < 0 || length > fileData->size() - static_cast<size_t>(pos))
+                        return ErrorCode::UNEXPECTED_EOF;
+                    if(int ec = nitem->loadShared(fileData->subView(pos, length)))
+                        return ec;
+                    fs.setPosition(pos + length);
+                } else if(int ec = nitem->load(lst, length))
                     return ec;
                 item = std::move(nitem);
             }
@@ -144,5 +155,11 @@ int libsiedler2::loader::LoadType(BobType bobtype, std::istream& lst, std::uniqu
         return ErrorCode::CUSTOM;
     }
 
+    if(item)
+    {
+        if(DeduplicationContext* dedupCtx = getDeduplicationContext())
+            dedupCtx->deduplicate(*item);
+    }
+
     return ErrorCode::NONE;
 }
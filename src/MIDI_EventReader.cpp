@@ -0,0 +1,165 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "MIDI_EventReader.h"
+#include "MIDI_Track.h"
+#include "XMIDI_TrackConverter.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace libsiedler2 {
+
+MIDI_EventReader::MIDI_EventReader(const MIDI_Track& track)
+{
+    const std::vector<uint8_t>& trackData = track.getData();
+    if(trackData.size() < 8u || !std::equal(trackData.begin(), trackData.begin() + 4, "MTrk"))
+        throw std::runtime_error("Invalid MIDI track header");
+    const uint32_t length = (trackData[4] << 24) | (trackData[5] << 16) | (trackData[6] << 8) | trackData[7];
+    if(length > trackData.size() - 8u)
+        throw std::runtime_error("MIDI track length exceeds data");
+    data_ = span<const uint8_t>(trackData.data() + 8, length);
+}
+
+MIDI_EventReader::MIDI_EventReader(const XMIDI_Track& track) : converter_(std::make_unique<XMIDI_TrackConverter>(track))
+{
+    converter_->Convert();
+}
+
+MIDI_EventReader::MIDI_EventReader(MIDI_EventReader&&) noexcept = default;
+MIDI_EventReader& MIDI_EventReader::operator=(MIDI_EventReader&&) noexcept = default;
+MIDI_EventReader::~MIDI_EventReader() = default;
+
+bool MIDI_EventReader::next(Event& event)
+{
+    if(done_)
+        return false;
+    if(converter_)
+        return nextXMidiEvent(event);
+    else
+        return nextMidiEvent(event);
+}
+
+bool MIDI_EventReader::nextMidiEvent(Event& event)
+{
+    // Tracks without an end-of-track event end at the last event
+    if(pos_ >= data_.size())
+    {
+        setEndOfTrack(event, curTime_);
+        return true;
+    }
+    curTime_ += readVLQ();
+    event = Event();
+    event.time = curTime_;
+
+    uint8_t status = readByte();
+    bool hasStatus = true;
+    if(status < 0x80)
+    {
+        if(!runningStatus_)
+            throw std::runtime_error("MIDI event without status");
+        status = runningStatus_;
+        hasStatus = false;
+    }
+    event.status = status;
+
+    switch(status >> 4)
+    {
+        // 2 bytes data: Note off, Note on, Aftertouch, Controller and Pitch Wheel
+        case 0x8:
+        case 0x9:
+        case 0xA:
+        case 0xB:
+        case 0xE:
+            event.data[0] = hasStatus ? readByte() : data_[pos_ - 1u];
+            event.data[1] = readByte();
+            runningStatus_ = status;
+            break;
+        // 1 byte data: Program Change and Channel Pressure
+        case 0xC:
+        case 0xD:
+            event.data[0] = hasStatus ? readByte() : data_[pos_ - 1u];
+            runningStatus_ = status;
+            break;
+        // SysEx and meta events cancel the running status
+        default:
+            if(status != 0xF0 && status != 0xF7 && status != 0xFF)
+                throw std::runtime_error("Invalid MIDI status");
+            runningStatus_ = 0;
+            if(status == 0xFF)
+                event.data[0] = readByte();
+            event.payload = readPayload();
+            if(event.isEndOfTrack())
+                done_ = true;
+            break;
+    }
+    return true;
+}
+
+bool MIDI_EventReader::nextXMidiEvent(Event& event)
+{
+    // Same as XMIDI_TrackConverter::CreateMidiTrack: Events after the first end-of-track event are dropped
+    // and the end-of-track event is not before the last event
+    const auto& events = converter_->events;
+    if(curEvent_ >= events.size())
+    {
+        setEndOfTrack(event, curTime_);
+        return true;
+    }
+    const XMIDI_TrackConverter::MIDI_Event& curEvent = events[curEvent_++];
+    if(curEvent.status == 0xFF && curEvent.data[0] == 0x2F)
+    {
+        setEndOfTrack(event, std::max(curTime_, static_cast<uint32_t>(curEvent.time)));
+        return true;
+    }
+    curTime_ = static_cast<uint32_t>(curEvent.time);
+    event.time = curTime_;
+    event.status = curEvent.status;
+    event.data = curEvent.data;
+    if(curEvent.status >= 0xF0)
+        event.payload = span<const uint8_t>(converter_->sysexData.data() + curEvent.bufferOffset, curEvent.bufferSize);
+    else
+        event.payload = span<const uint8_t>();
+    return true;
+}
+
+void MIDI_EventReader::setEndOfTrack(Event& event, uint32_t time)
+{
+    event = Event();
+    event.time = time;
+    event.status = 0xFF;
+    event.data[0] = 0x2F;
+    done_ = true;
+}
+
+uint8_t MIDI_EventReader::readByte()
+{
+    if(pos_ >= data_.size())
+        throw std::runtime_error("MIDI event exceeds track");
+    return data_[pos_++];
+}
+
+uint32_t MIDI_EventReader::readVLQ()
+{
+    uint32_t value = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        const uint8_t curByte = readByte();
+        value = (value << 7) | (curByte & 0x7F);
+        if(!(curByte & 0x80))
+            return value;
+    }
+    throw std::runtime_error("Could not get VLQ");
+}
+
+span<const uint8_t> MIDI_EventReader::readPayload()
+{
+    const uint32_t len = readVLQ();
+    if(len > data_.size() - pos_)
+        throw std::runtime_error("MIDI event exceeds track");
+    const span<const uint8_t> result = data_.subspan(pos_, len);
+    pos_ += len;
+    return result;
+}
+
+} // namespace libsiedler2
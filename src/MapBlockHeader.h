@@ -0,0 +1,58 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ErrorCodes.h"
+#include <cassert>
+#include <cstdint>
+
+namespace libsiedler2 {
+
+/// Header in front of each layer block of a map file
+struct MapBlockHeader
+{                     //-V802
+    uint16_t id;      // Must be 0x2710
+    uint32_t unknown; // Always 0
+    uint16_t w, h;
+    uint16_t multiplier; // Not sure, always 1
+    uint32_t blockLength;
+};
+
+/// Read the header of a layer block for a map of the given size and validate it. Returns an ErrorCode.
+/// @param[out] hasData True if the block contains data, false for unused blocks
+template<class T_Stream>
+int readMapBlockHeader(T_Stream& fs, uint16_t w, uint16_t h, bool& hasData)
+{
+    MapBlockHeader bHeader;
+    fs >> bHeader.id >> bHeader.unknown >> bHeader.w >> bHeader.h >> bHeader.multiplier >> bHeader.blockLength;
+    // Header id must match
+    if(!fs || bHeader.id != 0x2710 || bHeader.unknown != 0)
+    {
+        return ErrorCode::WRONG_FORMAT;
+    }
+    // Multiplier of 0 means unused block and implies no data
+    if(bHeader.multiplier == 0)
+    {
+        assert(bHeader.blockLength == 0);
+        hasData = false;
+        return ErrorCode::NONE;
+    }
+    // Blocksize must match extents
+    if(bHeader.blockLength != static_cast<uint32_t>(w) * h)
+    {
+        assert(false);
+        return ErrorCode::WRONG_FORMAT;
+    }
+    // If there is data, size must match
+    if(bHeader.w != w || bHeader.h != h)
+    {
+        assert(false);
+        return ErrorCode::WRONG_FORMAT;
+    }
+    hasData = true;
+    return ErrorCode::NONE;
+}
+
+} // namespace libsiedler2
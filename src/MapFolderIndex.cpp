@@ -0,0 +1,185 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "MapFolderIndex.h"
+#include "ErrorCodes.h"
+#include "fileFormatHelpers.h"
+#include "parallelFor.h"
+#include "s25util/strAlgos.h"
+#include "libendian/EndianIStreamAdapter.h"
+#include "libendian/EndianOStreamAdapter.h"
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace bfs = boost::filesystem;
+
+namespace libsiedler2 {
+
+namespace {
+    const char INDEX_ID[9] = "MAPINDEX";
+    constexpr uint16_t INDEX_VERSION = 1;
+
+    /// Write the string with a 16 bit length. Returns false if it is too long
+    template<class T_Stream>
+    bool writeString(T_Stream& fs, const std::string& str)
+    {
+        if(str.size() > std::numeric_limits<uint16_t>::max())
+            return false;
+        fs << static_cast<uint16_t>(str.size());
+        fs.writeRaw(str.data(), str.size());
+        return true;
+    }
+
+    template<class T_Stream>
+    bool readString(T_Stream& fs, std::string& str)
+    {
+        uint16_t len;
+        if(!(fs >> len))
+            return false;
+        str.resize(len);
+        return !!fs.readRaw(&str[0], len);
+    }
+
+    bool isMapFile(const bfs::path& filePath)
+    {
+        const std::string extension = s25util::toLower(filePath.extension().string());
+        return extension == ".swd" || extension == ".wld";
+    }
+} // namespace
+
+int MapFolderIndex::readMapInfo(const boost::filesystem::path& filePath, MapInfo& info)
+{
+    // Only the header is read, so a buffered stream is cheaper than mapping the whole file
+    boost::nowide::ifstream file(filePath, std::ios_base::binary);
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    ArchivItem_Map_Header header;
+    if(int ec = header.load(file))
+        return ec;
+    info.name = header.getName();
+    info.author = header.getAuthor();
+    info.width = header.getWidth();
+    info.height = header.getHeight();
+    info.gfxSet = header.getGfxSet();
+    info.numPlayers = header.getNumPlayers();
+    for(unsigned i = 0; i < ArchivItem_Map_Header::maxPlayers; i++)
+        header.getPlayerHQ(i, info.hqX[i], info.hqY[i]);
+    return ErrorCode::NONE;
+}
+
+int MapFolderIndex::scan(const boost::filesystem::path& folderPath, unsigned numThreads)
+{
+    boost::system::error_code ec;
+    bfs::directory_iterator itDir(folderPath, ec);
+    if(ec)
+        return ErrorCode::FILE_NOT_FOUND;
+
+    std::unordered_map<std::string, const MapInfo*> oldMaps;
+    for(const MapInfo& info : maps_)
+        oldMaps.emplace(info.filePath.string(), &info);
+
+    std::vector<MapInfo> newMaps;
+    std::vector<size_t> outdatedMaps;
+    for(; itDir != bfs::directory_iterator(); itDir.increment(ec))
+    {
+        if(ec)
+            return ErrorCode::FILE_NOT_ACCESSIBLE;
+        const bfs::path& curPath = itDir->path();
+        if(!isMapFile(curPath) || !bfs::is_regular_file(itDir->status()))
+            continue;
+        MapInfo info;
+        info.filePath = curPath;
+        info.fileSize = bfs::file_size(curPath, ec);
+        if(!ec)
+            info.lastWriteTime = bfs::last_write_time(curPath, ec);
+        if(ec)
+            continue; // Removed while iterating
+        const auto itOld = oldMaps.find(curPath.string());
+        if(itOld != oldMaps.end() && itOld->second->fileSize == info.fileSize
+           && itOld->second->lastWriteTime == info.lastWriteTime)
+            newMaps.push_back(*itOld->second);
+        else
+        {
+            outdatedMaps.push_back(newMaps.size());
+            newMaps.push_back(std::move(info));
+        }
+    }
+
+    parallelFor(outdatedMaps.size(), numThreads, [&](size_t i) {
+        MapInfo& info = newMaps[outdatedMaps[i]];
+        info.errorCode = readMapInfo(info.filePath, info);
+    });
+
+    std::sort(newMaps.begin(), newMaps.end(),
+              [](const MapInfo& lhs, const MapInfo& rhs) { return lhs.filePath < rhs.filePath; });
+    maps_ = std::move(newMaps);
+    numHeadersRead_ = outdatedMaps.size();
+    return ErrorCode::NONE;
+}
+
+int MapFolderIndex::load(const boost::filesystem::path& indexFilePath)
+{
+    libendian::EndianIStreamAdapter<false, boost::nowide::ifstream> fs(indexFilePath, std::ios_base::binary);
+    if(!fs)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+
+    std::array<char, 8> id;
+    uint16_t version;
+    uint32_t numMaps;
+    if(!(fs >> id >> version >> numMaps) || !isChunk(id, INDEX_ID))
+        return ErrorCode::WRONG_HEADER;
+    if(version != INDEX_VERSION)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+
+    // Entries are added as they are read, as the count is not validated
+    std::vector<MapInfo> maps;
+    for(uint32_t i = 0; i < numMaps; i++)
+    {
+        MapInfo info;
+        std::string filePath;
+        uint64_t fileSize;
+        int64_t lastWriteTime;
+        int32_t errorCode;
+        if(!readString(fs, filePath) || !(fs >> fileSize >> lastWriteTime >> errorCode))
+            return ErrorCode::UNEXPECTED_EOF;
+        info.filePath = filePath;
+        info.fileSize = fileSize;
+        info.lastWriteTime = static_cast<std::time_t>(lastWriteTime);
+        info.errorCode = errorCode;
+        if(!readString(fs, info.name) || !readString(fs, info.author))
+            return ErrorCode::UNEXPECTED_EOF;
+        if(!(fs >> info.width >> info.height >> info.gfxSet >> info.numPlayers >> info.hqX >> info.hqY))
+            return ErrorCode::UNEXPECTED_EOF;
+        maps.push_back(std::move(info));
+    }
+    maps_ = std::move(maps);
+    return ErrorCode::NONE;
+}
+
+int MapFolderIndex::write(const boost::filesystem::path& indexFilePath) const
+{
+    libendian::EndianOStreamAdapter<false, boost::nowide::ofstream> fs(indexFilePath, std::ios_base::binary);
+    if(!fs)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+
+    std::array<char, 8> id;
+    setChunkId(id, INDEX_ID);
+    fs << id << INDEX_VERSION << static_cast<uint32_t>(maps_.size());
+    for(const MapInfo& info : maps_)
+    {
+        if(!writeString(fs, info.filePath.string()))
+            return ErrorCode::WRONG_FORMAT;
+        fs << static_cast<uint64_t>(info.fileSize) << static_cast<int64_t>(info.lastWriteTime)
+           << static_cast<int32_t>(info.errorCode);
+        if(!writeString(fs, info.name) || !writeString(fs, info.author))
+            return ErrorCode::WRONG_FORMAT;
+        fs << info.width << info.height << info.gfxSet << info.numPlayers << info.hqX << info.hqY;
+    }
+    return (!fs) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
+}
+
+} // namespace libsiedler2
@@ -0,0 +1,261 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "MapStatistics.h"
+#include "ArchivItem_Map_Header.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace libsiedler2 {
+
+namespace {
+    /// The lower bits of a resource value are the amount, the upper ones the type
+    constexpr uint8_t resourceAmountMask = 0x07;
+    constexpr uint8_t resourceTypeMask = static_cast<uint8_t>(~resourceAmountMask);
+    /// Object types for trees are OT_TreeOrPalm..OT_TreeLast
+    constexpr uint8_t OT_TreeLast = 0xC7;
+
+    unsigned wrap(int value, unsigned size)
+    {
+        const int result = value % static_cast<int>(size);
+        return static_cast<unsigned>(result < 0 ? result + static_cast<int>(size) : result);
+    }
+} // namespace
+
+LayerHistogram computeHistogram(span<const uint8_t> layer)
+{
+    // Consecutive nodes often have the same value. Incrementing the same counter over and over would stall on
+    // the previous increment, so spread the values over multiple histograms which are merged at the end
+    constexpr unsigned numPartials = 4;
+    std::array<LayerHistogram, numPartials> partials{};
+    const size_t numFullBlocks = layer.size() / numPartials * numPartials;
+    const uint8_t* data = layer.data();
+    for(size_t i = 0; i < numFullBlocks; i += numPartials)
+    {
+        for(unsigned j = 0; j < numPartials; j++)
+            ++partials[j][data[i + j]];
+    }
+    for(size_t i = numFullBlocks; i < layer.size(); i++)
+        ++partials[0][data[i]];
+
+    LayerHistogram result = partials[0];
+    for(unsigned j = 1; j < numPartials; j++)
+    {
+        for(unsigned i = 0; i < result.size(); i++)
+            result[i] += partials[j][i];
+    }
+    return result;
+}
+
+uint32_t countMasked(span<const uint8_t> layer, uint8_t mask, uint8_t maskedValue)
+{
+    // Branchless, so the compiler can vectorize it
+    uint32_t result = 0;
+    for(const uint8_t value : layer)
+        result += static_cast<uint32_t>((value & mask) == maskedValue);
+    return result;
+}
+
+LayerWeights getRangeWeights(uint8_t first, uint8_t last)
+{
+    LayerWeights result{};
+    for(unsigned i = first; i <= last; i++)
+        result[i] = 1;
+    return result;
+}
+
+LayerWeights getResourceWeights(Resource resource)
+{
+    LayerWeights result{};
+    const unsigned first = resource & resourceTypeMask;
+    for(unsigned amount = 0; amount <= resourceAmountMask; amount++)
+        result[first + amount] = static_cast<uint8_t>(amount);
+    return result;
+}
+
+SummedAreaTable::SummedAreaTable(const ArchivItem_Map& map, MapLayer layer, const LayerWeights& weights)
+    : width_(map.getHeader().getWidth()), height_(map.getHeader().getHeight())
+{
+    const span<const uint8_t> values = map.getLayer(layer);
+    const unsigned tableWidth = width_ + 1u;
+    table_.resize(size_t(tableWidth) * (height_ + 1u));
+    for(unsigned y = 0; y < height_; y++)
+    {
+        const uint8_t* row = &values[y * width_];
+        const uint32_t* prevSums = &table_[y * tableWidth];
+        uint32_t* sums = &table_[(y + 1) * tableWidth];
+        uint32_t rowSum = 0;
+        for(unsigned x = 0; x < width_; x++)
+        {
+            rowSum += weights[row[x]];
+            sums[x + 1] = prevSums[x + 1] + rowSum;
+        }
+    }
+}
+
+uint32_t SummedAreaTable::getSumNoWrap(unsigned x0, unsigned y0, unsigned x1, unsigned y1) const
+{
+    assert(x0 <= x1 && x1 <= width_ && y0 <= y1 && y1 <= height_);
+    const unsigned tableWidth = width_ + 1u;
+    return table_[y1 * tableWidth + x1] - table_[y0 * tableWidth + x1] - table_[y1 * tableWidth + x0]
+           + table_[y0 * tableWidth + x0];
+}
+
+uint32_t SummedAreaTable::getSum(int x, int y, unsigned width, unsigned height) const
+{
+    if(table_.empty() || width == 0u || height == 0u)
+        return 0;
+    if(width > width_ || height > height_)
+        throw std::range_error("Region is bigger than the map");
+    const unsigned x0 = wrap(x, width_);
+    const unsigned y0 = wrap(y, height_);
+    // Split regions crossing the border into 2 parts per dimension
+    const unsigned widthLeft = std::min<unsigned>(width, width_ - x0);
+    const unsigned heightTop = std::min<unsigned>(height, height_ - y0);
+    const unsigned widthWrapped = width - widthLeft;
+    const unsigned heightWrapped = height - heightTop;
+
+    uint32_t result = getSumNoWrap(x0, y0, x0 + widthLeft, y0 + heightTop);
+    if(widthWrapped > 0u)
+        result += getSumNoWrap(0, y0, widthWrapped, y0 + heightTop);
+    if(heightWrapped > 0u)
+    {
+        result += getSumNoWrap(x0, 0, x0 + widthLeft, heightWrapped);
+        if(widthWrapped > 0u)
+            result += getSumNoWrap(0, 0, widthWrapped, heightWrapped);
+    }
+    return result;
+}
+
+uint32_t SummedAreaTable::getHexSum(unsigned x, unsigned y, unsigned radius) const
+{
+    if(table_.empty())
+        return 0;
+    if(2 * radius >= width_ || 2 * radius >= height_)
+        throw std::range_error("Radius is too big for the map");
+    // Odd rows are shifted half a node to the right.
+    // So the first node of a row dy rows away is at x - radius + (|dy| + own shift - shift of row) / 2
+    const int rowShift = static_cast<int>(y & 1u);
+    uint32_t result = 0;
+    for(int dy = -static_cast<int>(radius); dy <= static_cast<int>(radius); dy++)
+    {
+        const unsigned curY = wrap(static_cast<int>(y) + dy, height_);
+        const int absDy = std::abs(dy);
+        const int curRowShift = static_cast<int>(curY & 1u);
+        const int firstX = static_cast<int>(x) - static_cast<int>(radius) + (absDy + rowShift - curRowShift) / 2;
+        result += getSum(firstX, static_cast<int>(curY), 2 * radius + 1 - absDy, 1);
+    }
+    return result;
+}
+
+MapStatistics::MapStatistics(const ArchivItem_Map& map)
+{
+    for(unsigned i = 0; i < ArchivItem_Map::NUM_SWD_LAYERS; i++)
+    {
+        const auto type = static_cast<MapLayer>(i);
+        if(map.hasLayer(type))
+        {
+            histograms_[i] = computeHistogram(map.getLayer(type));
+            layerMask_ |= 1u << i;
+        }
+    }
+}
+
+bool MapStatistics::hasHistogram(MapLayer type) const
+{
+    return static_cast<unsigned>(type) < histograms_.size() && (layerMask_ & (1u << static_cast<unsigned>(type)));
+}
+
+const LayerHistogram& MapStatistics::getHistogram(MapLayer type) const
+{
+    if(!hasHistogram(type))
+        throw std::range_error("Layer not found");
+    return histograms_[static_cast<unsigned>(type)];
+}
+
+uint32_t MapStatistics::getSumInRange(MapLayer type, uint8_t first, uint8_t last) const
+{
+    if(!hasHistogram(type))
+        return 0;
+    const LayerHistogram& histogram = getHistogram(type);
+    uint32_t result = 0;
+    for(unsigned i = first; i <= last; i++)
+        result += histogram[i];
+    return result;
+}
+
+uint32_t MapStatistics::getNumResourceNodes(Resource resource) const
+{
+    const uint8_t first = resource & resourceTypeMask;
+    // Nodes with an amount of 0 don't contain the resource
+    return getSumInRange(MapLayer::Resources, first + 1u, first + resourceAmountMask);
+}
+
+uint32_t MapStatistics::getResourceAmount(Resource resource) const
+{
+    if(!hasHistogram(MapLayer::Resources))
+        return 0;
+    const LayerHistogram& histogram = getHistogram(MapLayer::Resources);
+    const LayerWeights weights = getResourceWeights(resource);
+    uint32_t result = 0;
+    for(unsigned i = 0; i < histogram.size(); i++)
+        result += histogram[i] * weights[i];
+    return result;
+}
+
+uint32_t MapStatistics::getNumTrees() const
+{
+    return getSumInRange(MapLayer::ObjectType, OT_TreeOrPalm, OT_TreeLast);
+}
+
+uint32_t MapStatistics::getNumStones() const
+{
+    return getSumInRange(MapLayer::ObjectType, OT_Stone1, OT_Stone2);
+}
+
+uint32_t PlayerRegionSummary::getResourceAmount(Resource resource) const
+{
+    for(unsigned i = 0; i < resources.size(); i++)
+    {
+        if((resources[i] & resourceTypeMask) == (resource & resourceTypeMask))
+            return resourceAmounts[i];
+    }
+    return 0;
+}
+
+std::vector<PlayerRegionSummary> computePlayerRegionSummaries(const ArchivItem_Map& map, unsigned radius)
+{
+    const ArchivItem_Map_Header& header = map.getHeader();
+    std::vector<PlayerRegionSummary> result;
+    for(unsigned i = 0; i < std::min<unsigned>(header.getNumPlayers(), ArchivItem_Map_Header::maxPlayers); i++)
+    {
+        PlayerRegionSummary summary{};
+        summary.player = static_cast<uint8_t>(i);
+        header.getPlayerHQ(i, summary.hqX, summary.hqY);
+        // Unused HQ positions are 0xFFFF
+        if(summary.hqX < header.getWidth() && summary.hqY < header.getHeight())
+            result.push_back(summary);
+    }
+    if(result.empty())
+        return result;
+
+    const SummedAreaTable trees(map, MapLayer::ObjectType, getRangeWeights(OT_TreeOrPalm, OT_TreeLast));
+    const SummedAreaTable stones(map, MapLayer::ObjectType, getRangeWeights(OT_Stone1, OT_Stone2));
+    for(PlayerRegionSummary& summary : result)
+    {
+        summary.numTrees = trees.getHexSum(summary.hqX, summary.hqY, radius);
+        summary.numStones = stones.getHexSum(summary.hqX, summary.hqY, radius);
+    }
+    for(unsigned i = 0; i < PlayerRegionSummary::resources.size(); i++)
+    {
+        const SummedAreaTable amounts(map, MapLayer::Resources, getResourceWeights(PlayerRegionSummary::resources[i]));
+        for(PlayerRegionSummary& summary : result)
+            summary.resourceAmounts[i] = amounts.getHexSum(summary.hqX, summary.hqY, radius);
+    }
+    return result;
+}
+
+} // namespace libsiedler2
@@ -0,0 +1,176 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "MapView.h"
+#include "ArchivItem_Map_Header.h"
+#include "ErrorCodes.h"
+#include "IAllocator.h"
+#include "MapBlockHeader.h"
+#include "libsiedler2.h"
+#include "libendian/EndianIStreamAdapter.h"
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace bfs = boost::filesystem;
+
+namespace libsiedler2 {
+
+MapView::MapView() : numNodes_(0), layers_() {}
+
+MapView::~MapView() = default;
+MapView::MapView(MapView&&) noexcept = default;
+MapView& MapView::operator=(MapView&&) noexcept = default;
+
+int MapView::open(const boost::filesystem::path& filepath)
+{
+    close();
+    if(filepath.empty())
+        return ErrorCode::INVALID_BUFFER;
+    if(!bfs::exists(filepath))
+        return ErrorCode::FILE_NOT_FOUND;
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(filepath);
+    } catch(std::exception& e)
+    {
+        std::cerr << "Could not open " << filepath << ": " << e.what() << std::endl;
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    }
+    if(!file.is_open())
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    if(int ec = open(span<const uint8_t>(reinterpret_cast<const uint8_t*>(file.data()), file.size())))
+        return ec;
+    file_ = std::move(file);
+    return ErrorCode::NONE;
+}
+
+int MapView::open(span<const uint8_t> data)
+{
+    close();
+    if(data.empty())
+        return ErrorCode::UNEXPECTED_EOF;
+
+    boost::iostreams::stream<boost::iostreams::array_source> file(reinterpret_cast<const char*>(data.data()),
+                                                                  data.size());
+    auto header = std::make_unique<ArchivItem_Map_Header>();
+    if(int ec = header->load(file))
+        return ec;
+
+    const uint16_t w = header->getWidth();
+    const uint16_t h = header->getHeight();
+    const unsigned numNodes = static_cast<unsigned>(w) * static_cast<unsigned>(h);
+    decltype(layers_) layers{};
+    std::vector<uint8_t> fixedFirstLayer;
+
+    libendian::EndianIStreamAdapter<false, std::istream&> fs(file);
+    for(uint32_t i = 0; i < ArchivItem_Map::NUM_SWD_LAYERS; ++i)
+    {
+        bool hasData;
+        if(int ec = readMapBlockHeader(fs, w, h, hasData))
+            return ec;
+        if(!hasData)
+            continue;
+
+        const size_t offset = static_cast<size_t>(fs.getPosition());
+        // Maps with the extra word bug have the last 2 bytes of the first block inside the header.
+        // So the block is 2 bytes shorter and the following ones start 2 bytes earlier.
+        const bool hasExtraWord = i == 0 && header->hasExtraWord() && numNodes >= 3u;
+        const size_t blockSize = hasExtraWord ? numNodes - 2u : numNodes;
+        if(offset + blockSize > data.size())
+            return ErrorCode::UNEXPECTED_EOF;
+        layers[i] = &data[offset];
+        if(hasExtraWord)
+        {
+            // The mapping is read-only, so patch a copy: Replace last 2 bytes by 3rd last one
+            fixedFirstLayer.assign(layers[i], layers[i] + blockSize);
+            fixedFirstLayer.resize(numNodes, fixedFirstLayer.back());
+            layers[i] = fixedFirstLayer.data();
+        }
+        fs.setPositionRel(static_cast<long>(blockSize));
+    }
+
+    std::vector<ArchivItem_Map::ExtraAnimalInfo> extraInfo;
+    while(true)
+    {
+        ArchivItem_Map::ExtraAnimalInfo info;
+        fs >> info.id;
+        if(!fs || info.id == 0xFF)
+            break;
+        fs >> info.x >> info.y;
+        extraInfo.push_back(info);
+    }
+    if(!fs)
+        return ErrorCode::UNEXPECTED_EOF;
+
+    header_ = std::move(header);
+    numNodes_ = numNodes;
+    layers_ = layers;
+    fixedFirstLayer_ = std::move(fixedFirstLayer);
+    extraInfo_ = std::move(extraInfo);
+    return ErrorCode::NONE;
+}
+
+void MapView::close()
+{
+    header_.reset();
+    numNodes_ = 0;
+    layers_.fill(nullptr);
+    fixedFirstLayer_.clear();
+    extraInfo_.clear();
+    file_.close();
+}
+
+const ArchivItem_Map_Header& MapView::getHeader() const
+{
+    assert(header_);
+    return *header_;
+}
+
+bool MapView::hasLayer(MapLayer type) const
+{
+    return static_cast<unsigned>(type) < layers_.size() && layers_[static_cast<unsigned>(type)] != nullptr;
+}
+
+span<const uint8_t> MapView::getLayer(MapLayer type) const
+{
+    if(!hasLayer(type))
+        throw std::range_error("Layer not found");
+    return span<const uint8_t>(layers_[static_cast<unsigned>(type)], numNodes_);
+}
+
+std::unique_ptr<ArchivItem_Map> MapView::materialize() const
+{
+    if(!header_)
+        return nullptr;
+    auto map = getAllocator().create<ArchivItem_Map>(BobType::Map);
+    if(!map)
+        return nullptr;
+    map->header_ = libsiedler2::clone(header_);
+    map->numNodes_ = numNodes_;
+    map->layerMask_ = 0;
+    for(unsigned i = 0; i < layers_.size(); i++)
+    {
+        if(layers_[i])
+            map->layerMask_ |= 1u << i;
+    }
+    // Only present layers are stored, in ascending order
+    std::vector<uint8_t> layerData;
+    layerData.reserve(size_t(numNodes_) * ArchivItem_Map::getNumLayers(map->layerMask_));
+    for(const uint8_t* layer : layers_)
+    {
+        if(layer)
+            layerData.insert(layerData.end(), layer, layer + numNodes_);
+    }
+    map->layerData_ = CopyOnWrite<std::vector<uint8_t>>(std::move(layerData));
+    map->extraInfo = extraInfo_;
+    return map;
+}
+
+} // namespace libsiedler2
@@ -0,0 +1,158 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Minimap.h"
+#include "ArchivItem_Map.h"
+#include "ArchivItem_Map_Header.h"
+#include "ErrorCodes.h"
+#include "PixelBufferBGRA.h"
+#include "parallelFor.h"
+#include <algorithm>
+#include <thread>
+
+namespace libsiedler2 {
+
+namespace {
+    /// Shadow value of a node with normal brightness
+    constexpr int normalShadow = 0x40;
+
+    bool isTree(uint8_t objType) { return objType >= 0xC4 && objType <= 0xC7; }
+    bool isGranite(uint8_t objType) { return objType == 0xCC || objType == 0xCD; }
+
+    uint8_t clampChannel(int value) { return static_cast<uint8_t>(std::min(std::max(value, 0), 0xFF)); }
+
+    /// Renders a range of rows. All per-node data is read directly from the layers
+    class MinimapRenderer
+    {
+    public:
+        MinimapRenderer(const ArchivItem_Map& map, PixelBufferBGRA& buffer, const MinimapOptions& options);
+        void renderRows(unsigned firstRow, unsigned lastRow) const;
+
+    private:
+        uint8_t getShadow(unsigned rowIdx, unsigned x) const;
+
+        PixelBufferBGRA& buffer_;
+        const MinimapOptions& options_;
+        const unsigned mapWidth_, mapHeight_;
+        span<const uint8_t> terrain1_, terrain2_, altitude_, shadows_, objTypes_;
+        /// Source column for each output column in even and odd rows
+        std::vector<unsigned> evenCols_, oddCols_;
+    };
+
+    MinimapRenderer::MinimapRenderer(const ArchivItem_Map& map, PixelBufferBGRA& buffer, const MinimapOptions& options)
+        : buffer_(buffer), options_(options), mapWidth_(map.getHeader().getWidth()),
+          mapHeight_(map.getHeader().getHeight()), terrain1_(map.getLayer(MapLayer::Terrain1)),
+          terrain2_(map.getLayer(MapLayer::Terrain2))
+    {
+        if(options.shadeAltitude)
+        {
+            if(map.hasLayer(MapLayer::Shadows))
+                shadows_ = map.getLayer(MapLayer::Shadows);
+            else if(map.hasLayer(MapLayer::Altitude))
+                altitude_ = map.getLayer(MapLayer::Altitude);
+        }
+        if(options.drawObjects && map.hasLayer(MapLayer::ObjectType))
+            objTypes_ = map.getLayer(MapLayer::ObjectType);
+
+        const unsigned outWidth = buffer.getWidth();
+        evenCols_.resize(outWidth);
+        oddCols_.resize(outWidth);
+        for(unsigned x = 0; x < outWidth; x++)
+        {
+            // Center of the pixel in half nodes. Nodes of odd rows are half a node to the right
+            const unsigned pos = ((2 * x + 1) * mapWidth_) / outWidth;
+            evenCols_[x] = pos / 2;
+            oddCols_[x] = pos > 0u ? (pos - 1) / 2 : 0u;
+        }
+    }
+
+    uint8_t MinimapRenderer::getShadow(unsigned rowIdx, unsigned x) const
+    {
+        if(!shadows_.empty())
+            return shadows_[rowIdx + x];
+        if(altitude_.empty())
+            return normalShadow;
+        // Light comes from the west: Rising terrain gets brighter
+        const unsigned westX = (x == 0u) ? mapWidth_ - 1u : x - 1u;
+        const int slope = altitude_[rowIdx + x] - altitude_[rowIdx + westX];
+        return clampChannel(normalShadow + slope * 8);
+    }
+
+    void MinimapRenderer::renderRows(unsigned firstRow, unsigned lastRow) const
+    {
+        const unsigned outWidth = buffer_.getWidth();
+        const unsigned outHeight = buffer_.getHeight();
+        std::vector<ColorBGRA>& pixels = buffer_.getPixels();
+        for(unsigned y = firstRow; y < lastRow; y++)
+        {
+            const unsigned mapY = ((2 * y + 1) * mapHeight_) / (2 * outHeight);
+            const unsigned rowIdx = mapY * mapWidth_;
+            const std::vector<unsigned>& cols = (mapY & 1u) ? oddCols_ : evenCols_;
+            ColorBGRA* outRow = &pixels[y * outWidth];
+            for(unsigned x = 0; x < outWidth; x++)
+            {
+                const unsigned idx = rowIdx + cols[x];
+                const ColorBGRA& clr1 = options_.terrainColors[terrain1_[idx] % MinimapOptions::numTerrains];
+                const ColorBGRA& clr2 = options_.terrainColors[terrain2_[idx] % MinimapOptions::numTerrains];
+                std::array<int, 3> clr;
+                for(unsigned i = 0; i < clr.size(); i++)
+                    clr[i] = (clr1.value[i] + clr2.value[i] + 1) / 2;
+                if(!objTypes_.empty())
+                {
+                    const uint8_t objType = objTypes_[idx];
+                    if(isTree(objType))
+                        std::copy_n(options_.treeColor.value.begin(), clr.size(), clr.begin());
+                    else if(isGranite(objType))
+                        std::copy_n(options_.graniteColor.value.begin(), clr.size(), clr.begin());
+                }
+                const int shading = getShadow(rowIdx, cols[x]) - normalShadow;
+                if(!options_.owners.empty())
+                {
+                    const uint8_t owner = options_.owners[idx];
+                    if(owner > 0u && owner <= options_.playerColors.size())
+                    {
+                        const ColorBGRA& playerClr = options_.playerColors[owner - 1u];
+                        for(unsigned i = 0; i < clr.size(); i++)
+                        {
+                            clr[i] = (clr[i] * static_cast<int>(256 - options_.ownerAlpha)
+                                      + playerClr.value[i] * static_cast<int>(options_.ownerAlpha))
+                                     >> 8;
+                        }
+                    }
+                }
+                outRow[x] = ColorBGRA(clampChannel(clr[0] + shading), clampChannel(clr[1] + shading),
+                                      clampChannel(clr[2] + shading), 0xFF);
+            }
+        }
+    }
+} // namespace
+
+int renderMinimap(const ArchivItem_Map& map, PixelBufferBGRA& buffer, const MinimapOptions& options)
+{
+    if(buffer.getNumPixels() == 0u)
+        return ErrorCode::INVALID_BUFFER;
+    if(map.getNumNodes() == 0u || !map.hasLayer(MapLayer::Terrain1) || !map.hasLayer(MapLayer::Terrain2))
+        return ErrorCode::WRONG_FORMAT;
+    if(!options.owners.empty() && options.owners.size() != map.getNumNodes())
+        return ErrorCode::INVALID_BUFFER;
+    if(options.ownerAlpha > 256u)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+
+    const MinimapRenderer renderer(map, buffer, options);
+    unsigned numThreads = options.numThreads ? options.numThreads : std::thread::hardware_concurrency();
+    // Don't bother starting threads for only a few rows each
+    constexpr unsigned minRowsPerThread = 16;
+    const unsigned numRows = buffer.getHeight();
+    numThreads = std::max(1u, std::min(numThreads, numRows / minRowsPerThread));
+    const unsigned rowsPerThread = (numRows + numThreads - 1u) / numThreads;
+    const unsigned numChunks = (numRows + rowsPerThread - 1u) / rowsPerThread;
+
+    parallelFor(numChunks, numThreads, [&](size_t chunk) {
+        const unsigned firstRow = static_cast<unsigned>(chunk) * rowsPerThread;
+        renderer.renderRows(firstRow, std::min(firstRow + rowsPerThread, numRows));
+    });
+    return ErrorCode::NONE;
+}
+
+} // namespace libsiedler2
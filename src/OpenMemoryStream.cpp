@@ -6,6 +6,7 @@
 #include "ErrorCodes.h"
 #include <boost/filesystem/operations.hpp>
 #include <iostream>
+#include <memory>
 
 namespace bfs = boost::filesystem;
 
@@ -29,4 +30,14 @@ int openMemoryStream(const boost::filesystem::path& filepath, MMStream& stream)
 
     return (!stream) ? ErrorCode::FILE_NOT_ACCESSIBLE : ErrorCode::NONE;
 }
+
+SharedBytes getMappedData(MMStream& stream)
+{
+    // Copies of the device share the mapping. Closing the stream would unmap it for all of them,
+    // so let the last reference unmap it instead
+    stream.set_auto_close(false);
+    auto mapping = std::make_shared<const boost::iostreams::mapped_file_source>(*stream);
+    const span<const uint8_t> data(reinterpret_cast<const uint8_t*>(mapping->data()), mapping->size());
+    return SharedBytes(std::move(mapping), data);
+}
 } // namespace libsiedler2
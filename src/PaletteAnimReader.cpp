@@ -8,6 +8,7 @@
 #include "ErrorCodes.h"
 #include "FileError.h"
 #include "IAllocator.h"
+#include "itemCast.h"
 #include "libsiedler2.h"
 #include "loadMapping.h"
 #include "prototypen.h"
@@ -116,7 +117,7 @@ int WritePaletteAnim(const boost::filesystem::path& filepath, const Archiv& item
         if(items[idx]->getBobType() != BobType::PaletteAnim)
             continue;
         fs << idx << '\t';
-        if(int ec = dynamic_cast<const ArchivItem_PaletteAnimation*>(items[idx])->writeToTxt(fs))
+        if(int ec = item_cast<ArchivItem_PaletteAnimation>(items[idx])->writeToTxt(fs))
             return ec;
     }
     return ErrorCode::NONE;
@@ -0,0 +1,119 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "PcmConversion.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace libsiedler2 {
+
+namespace {
+    /// Taps are processed in blocks of this many independent sums which map to SIMD registers
+    constexpr unsigned NUM_LANES = 8;
+    constexpr double PI = 3.14159265358979323846;
+
+    double sinc(double x)
+    {
+        if(std::abs(x) < 1e-9)
+            return 1.;
+        return std::sin(PI * x) / (PI * x);
+    }
+
+    /// Blackman window for x in [-1, 1]
+    double window(double x)
+    {
+        if(std::abs(x) >= 1.)
+            return 0.;
+        return 0.42 + 0.5 * std::cos(PI * x) + 0.08 * std::cos(2. * PI * x);
+    }
+} // namespace
+
+void convertToInt16(span<const float> in, int16_t* out)
+{
+    for(size_t i = 0; i < in.size(); i++)
+    {
+        // Resampling may overshoot slightly
+        const float value = std::round(in[i] * 32768.f);
+        out[i] = static_cast<int16_t>(std::max(-32768.f, std::min(value, 32767.f)));
+    }
+}
+
+PolyphaseResampler::PolyphaseResampler(uint32_t inRate, uint32_t outRate, unsigned halfWidth)
+{
+    if(inRate == 0u || outRate == 0u || halfWidth == 0u)
+        throw std::invalid_argument("Invalid resampling parameters");
+    const uint32_t divisor = std::gcd(inRate, outRate);
+    upFactor_ = outRate / divisor;
+    downFactor_ = inRate / divisor;
+
+    // When downsampling the cutoff is lowered to the output nyquist frequency and the filter widened accordingly
+    const double cutoff = std::min(1., static_cast<double>(outRate) / inRate);
+    // Number of taps is a multiple of the lane count
+    auto scaledHalfWidth = static_cast<unsigned>(std::ceil(halfWidth / cutoff));
+    scaledHalfWidth = (scaledHalfWidth + NUM_LANES / 2u - 1u) / (NUM_LANES / 2u) * (NUM_LANES / 2u);
+    numTaps_ = 2u * scaledHalfWidth;
+
+    coefficients_.resize(static_cast<size_t>(upFactor_) * numTaps_);
+    for(uint32_t phase = 0; phase < upFactor_; phase++)
+    {
+        float* taps = &coefficients_[static_cast<size_t>(phase) * numTaps_];
+        // Tap k is applied to the input sample at distance d before the output position
+        const double fraction = static_cast<double>(phase) / upFactor_;
+        double sum = 0.;
+        for(unsigned k = 0; k < numTaps_; k++)
+        {
+            const double d = static_cast<double>(scaledHalfWidth) - 1. - k + fraction;
+            const double value = cutoff * sinc(cutoff * d) * window(d / scaledHalfWidth);
+            taps[k] = static_cast<float>(value);
+            sum += value;
+        }
+        // Unity gain for constant signals
+        for(unsigned k = 0; k < numTaps_; k++)
+            taps[k] = static_cast<float>(taps[k] / sum);
+    }
+}
+
+size_t PolyphaseResampler::getOutputSize(size_t inputSize) const
+{
+    return (inputSize * upFactor_ + downFactor_ - 1u) / downFactor_;
+}
+
+void PolyphaseResampler::process(span<const float> input, std::vector<float>& output) const
+{
+    const size_t outputSize = getOutputSize(input.size());
+    if(outputSize == 0u)
+        return;
+    // Zero padding at both sides so the inner loop does not need bounds checks
+    const unsigned halfTaps = numTaps_ / 2u;
+    std::vector<float> padded(input.size() + numTaps_, 0.f);
+    std::copy(input.begin(), input.end(), padded.begin() + halfTaps);
+
+    const size_t outOffset = output.size();
+    output.resize(outOffset + outputSize);
+    float* out = &output[outOffset];
+    uint64_t inPos = 0;
+    uint32_t phase = 0;
+    for(size_t i = 0; i < outputSize; i++)
+    {
+        // Taps cover the input samples [inPos - halfTaps + 1, inPos + halfTaps]
+        const float* samples = &padded[inPos + 1u];
+        const float* taps = &coefficients_[static_cast<size_t>(phase) * numTaps_];
+        std::array<float, NUM_LANES> sums{};
+        for(unsigned k = 0; k < numTaps_; k += NUM_LANES)
+        {
+            for(unsigned lane = 0; lane < NUM_LANES; lane++)
+                sums[lane] += samples[k + lane] * taps[k + lane];
+        }
+        out[i] = std::accumulate(sums.begin(), sums.end(), 0.f);
+
+        phase += downFactor_;
+        inPos += phase / upFactor_;
+        phase %= upFactor_;
+    }
+}
+
+} // namespace libsiedler2
@@ -0,0 +1,229 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "SoundBank.h"
+#include "Archiv.h"
+#include "ArchivItem_Sound_Wave.h"
+#include "ErrorCodes.h"
+#include "fileFormatHelpers.h"
+#include "libendian/EndianIStreamAdapter.h"
+#include "libendian/EndianOStreamAdapter.h"
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace bfs = boost::filesystem;
+
+namespace libsiedler2 {
+
+namespace {
+    const char BANK_ID[5] = "SBNK";
+    constexpr uint16_t BANK_VERSION = 1;
+    /// Id, version, sample format, number of entries, reserved
+    constexpr size_t HEADER_SIZE = 4 + 2 + 2 + 4 + 4;
+    /// Offset, frames, rate, channels, reserved
+    constexpr size_t ENTRY_SIZE = 4 + 4 + 4 + 2 + 2;
+
+    size_t getSampleSize(SampleFormat sampleFormat)
+    {
+        return sampleFormat == SampleFormat::Int16 ? sizeof(int16_t) : sizeof(float);
+    }
+
+    size_t alignOffset(size_t offset)
+    {
+        return (offset + SoundBank::alignment - 1u) / SoundBank::alignment * SoundBank::alignment;
+    }
+} // namespace
+
+SoundBank::SoundBank() : sampleFormat_(SampleFormat::Int16) {}
+
+SoundBank::~SoundBank() = default;
+SoundBank::SoundBank(SoundBank&&) noexcept = default;
+SoundBank& SoundBank::operator=(SoundBank&&) noexcept = default;
+
+int SoundBank::write(std::ostream& file, const Archiv& archiv, const PcmFormat& format, SampleFormat sampleFormat,
+                     unsigned numThreads)
+{
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    if(sampleFormat != SampleFormat::Int16 && sampleFormat != SampleFormat::Float32)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+
+    std::vector<std::vector<float>> buffers;
+    if(int ec = convertAllWaves(archiv, format, buffers, numThreads))
+        return ec;
+
+    const size_t sampleSize = getSampleSize(sampleFormat);
+    std::vector<Entry> entries(buffers.size());
+    size_t offset = alignOffset(HEADER_SIZE + entries.size() * ENTRY_SIZE);
+    for(size_t i = 0; i < buffers.size(); i++)
+    {
+        if(offset > std::numeric_limits<uint32_t>::max())
+            return ErrorCode::UNSUPPORTED_FORMAT;
+        entries[i].offset = static_cast<uint32_t>(offset);
+        entries[i].numFrames = static_cast<uint32_t>(buffers[i].size() / format.numChannels);
+        entries[i].sampleRate = format.sampleRate;
+        entries[i].numChannels = format.numChannels;
+        offset = alignOffset(offset + buffers[i].size() * sampleSize);
+    }
+
+    libendian::EndianOStreamAdapter<false, std::ostream&> fs(file);
+    std::array<char, 4> id;
+    setChunkId(id, BANK_ID);
+    fs << id << BANK_VERSION << static_cast<uint16_t>(sampleFormat) << static_cast<uint32_t>(entries.size())
+       << uint32_t(0);
+    for(const Entry& entry : entries)
+        fs << entry.offset << entry.numFrames << entry.sampleRate << entry.numChannels << uint16_t(0);
+
+    size_t curPos = HEADER_SIZE + entries.size() * ENTRY_SIZE;
+    const std::array<char, alignment> padding{};
+    std::vector<int16_t> intSamples;
+    std::vector<uint32_t> floatBits;
+    for(size_t i = 0; i < buffers.size(); i++)
+    {
+        fs.write(padding.data(), entries[i].offset - curPos);
+        const std::vector<float>& samples = buffers[i];
+        if(sampleFormat == SampleFormat::Int16)
+        {
+            intSamples.resize(samples.size());
+            convertToInt16(samples, intSamples.data());
+            fs << intSamples;
+        } else
+        {
+            // Written as their bit pattern to get the byte order right
+            floatBits.resize(samples.size());
+            if(!samples.empty())
+                std::memcpy(floatBits.data(), samples.data(), samples.size() * sizeof(float));
+            fs << floatBits;
+        }
+        curPos = entries[i].offset + samples.size() * sampleSize;
+    }
+    return (!file) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
+}
+
+int SoundBank::write(const boost::filesystem::path& filepath, const Archiv& archiv, const PcmFormat& format,
+                     SampleFormat sampleFormat, unsigned numThreads)
+{
+    if(filepath.empty())
+        return ErrorCode::INVALID_BUFFER;
+    boost::nowide::ofstream file(filepath, std::ios_base::binary);
+    if(!file)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    return write(file, archiv, format, sampleFormat, numThreads);
+}
+
+int SoundBank::open(const boost::filesystem::path& filepath)
+{
+    close();
+    if(filepath.empty())
+        return ErrorCode::INVALID_BUFFER;
+    if(!bfs::exists(filepath))
+        return ErrorCode::FILE_NOT_FOUND;
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(filepath);
+    } catch(std::exception& e)
+    {
+        std::cerr << "Could not open " << filepath << ": " << e.what() << std::endl;
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    }
+    if(!file.is_open())
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+    if(int ec = open(span<const uint8_t>(reinterpret_cast<const uint8_t*>(file.data()), file.size())))
+        return ec;
+    file_ = std::move(file);
+    return ErrorCode::NONE;
+}
+
+int SoundBank::open(span<const uint8_t> data)
+{
+    close();
+    // Samples are used in place
+    if(boost::endian::order::native != boost::endian::order::little)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+    if(reinterpret_cast<uintptr_t>(data.data()) % alignment != 0u)
+        return ErrorCode::INVALID_BUFFER;
+    if(data.size() < HEADER_SIZE)
+        return ErrorCode::WRONG_HEADER;
+
+    boost::iostreams::stream<boost::iostreams::array_source> file(reinterpret_cast<const char*>(data.data()),
+                                                                  data.size());
+    libendian::EndianIStreamAdapter<false, std::istream&> fs(file);
+    std::array<char, 4> id;
+    uint16_t version, sampleFormatVal;
+    uint32_t numEntries, reserved;
+    if(!(fs >> id >> version >> sampleFormatVal >> numEntries >> reserved) || !isChunk(id, BANK_ID))
+        return ErrorCode::WRONG_HEADER;
+    if(version != BANK_VERSION)
+        return ErrorCode::WRONG_FORMAT;
+    const auto sampleFormat = static_cast<SampleFormat>(sampleFormatVal);
+    if(sampleFormat != SampleFormat::Int16 && sampleFormat != SampleFormat::Float32)
+        return ErrorCode::UNSUPPORTED_FORMAT;
+    if(numEntries > (data.size() - HEADER_SIZE) / ENTRY_SIZE)
+        return ErrorCode::UNEXPECTED_EOF;
+
+    const size_t sampleSize = getSampleSize(sampleFormat);
+    std::vector<Entry> entries(numEntries);
+    for(Entry& entry : entries)
+    {
+        uint16_t entryReserved;
+        fs >> entry.offset >> entry.numFrames >> entry.sampleRate >> entry.numChannels >> entryReserved;
+        if(entry.offset % alignment != 0u)
+            return ErrorCode::WRONG_FORMAT;
+        const uint64_t numBytes = uint64_t(entry.numFrames) * entry.numChannels * sampleSize;
+        if(entry.offset > data.size() || numBytes > data.size() - entry.offset)
+            return ErrorCode::UNEXPECTED_EOF;
+    }
+    if(!fs)
+        return ErrorCode::UNEXPECTED_EOF;
+
+    data_ = data;
+    sampleFormat_ = sampleFormat;
+    entries_ = std::move(entries);
+    return ErrorCode::NONE;
+}
+
+void SoundBank::close()
+{
+    data_ = span<const uint8_t>();
+    entries_.clear();
+    file_.close();
+}
+
+const SoundBank::Entry& SoundBank::getEntry(size_t idx) const
+{
+    if(idx >= entries_.size())
+        throw std::out_of_range("Invalid sound index");
+    return entries_[idx];
+}
+
+span<const uint8_t> SoundBank::getSampleData(size_t idx, SampleFormat sampleFormat) const
+{
+    const Entry& entry = getEntry(idx);
+    if(sampleFormat != sampleFormat_)
+        throw std::logic_error("Sound bank has a different sample format");
+    return data_.subspan(entry.offset, size_t(entry.numFrames) * entry.numChannels * getSampleSize(sampleFormat));
+}
+
+span<const int16_t> SoundBank::getSamplesInt16(size_t idx) const
+{
+    const span<const uint8_t> samples = getSampleData(idx, SampleFormat::Int16);
+    return span<const int16_t>(reinterpret_cast<const int16_t*>(samples.data()), samples.size() / sizeof(int16_t));
+}
+
+span<const float> SoundBank::getSamplesFloat(size_t idx) const
+{
+    const span<const uint8_t> samples = getSampleData(idx, SampleFormat::Float32);
+    return span<const float>(reinterpret_cast<const float*>(samples.data()), samples.size() / sizeof(float));
+}
+
+} // namespace libsiedler2
@@ -4,8 +4,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "StandardAllocator.h"
-#include "ArchivItem_PaletteAnimation.h"
-#include "archives.h"
+#include "createItem.h"
 
 namespace libsiedler2 {
 
@@ -18,36 +17,9 @@ namespace libsiedler2 {
  */
 std::unique_ptr<ArchivItem> StandardAllocator::create(BobType type, SoundType subtype) const
 {
-    switch(type)
-    {
-        case BobType::Sound:
-        {
-            switch(subtype)
-            {
-                case SoundType::None: return nullptr;
-                case SoundType::Midi: return std::make_unique<ArchivItem_Sound_Midi>();
-                case SoundType::Wave: return std::make_unique<ArchivItem_Sound_Wave>();
-                case SoundType::XMidi: return std::make_unique<ArchivItem_Sound_XMidi>();
-                default: return std::make_unique<ArchivItem_Sound_Other>(subtype);
-            }
-            break;
-        }
-        case BobType::BitmapRLE: return std::make_unique<ArchivItem_Bitmap_RLE>();
-        case BobType::Font: return std::make_unique<ArchivItem_Font>();
-        case BobType::BitmapPlayer: return std::make_unique<ArchivItem_Bitmap_Player>();
-        case BobType::Palette: return std::make_unique<ArchivItem_Palette>();
-        case BobType::Bob: return std::make_unique<ArchivItem_Bob>();
-        case BobType::BitmapShadow: return std::make_unique<ArchivItem_Bitmap_Shadow>();
-        case BobType::Map: return std::make_unique<ArchivItem_Map>();
-        case BobType::Text: return std::make_unique<ArchivItem_Text>();
-        case BobType::Raw: return std::make_unique<ArchivItem_Raw>();
-        case BobType::MapHeader: return std::make_unique<ArchivItem_Map_Header>();
-        case BobType::Ini: return std::make_unique<ArchivItem_Ini>();
-        case BobType::Bitmap: return std::make_unique<ArchivItem_Bitmap_Raw>();
-        case BobType::PaletteAnim: return std::make_unique<ArchivItem_PaletteAnimation>();
-        default: return nullptr;
-    }
-    return nullptr;
+    return createItem(type, subtype, [](auto tag, auto... args) -> std::unique_ptr<ArchivItem> {
+        return std::make_unique<typename decltype(tag)::type>(args...);
+    });
 }
 
 } // namespace libsiedler2
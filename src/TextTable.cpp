@@ -0,0 +1,132 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "TextTable.h"
+#include "Archiv.h"
+#include "ArchivItem_Text.h"
+#include "ErrorCodes.h"
+#include "IAllocator.h"
+#include "OpenMemoryStream.h"
+#include "libsiedler2.h"
+#include "oem.h"
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace libsiedler2 {
+
+namespace {
+    template<typename T>
+    T readLE(const uint8_t* data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+        return boost::endian::little_to_native(value);
+    }
+} // namespace
+
+int TextTable::load(const boost::filesystem::path& filepath, bool conversion)
+{
+    clear();
+    MMStream mmapStream;
+    if(int ec = openMemoryStream(filepath, mmapStream))
+        return ec;
+    const SharedBytes data = getMappedData(mmapStream);
+    return load(data.get(), conversion);
+}
+
+int TextTable::load(span<const uint8_t> data, bool conversion)
+{
+    clear();
+    constexpr size_t headerSize = 2 + 2 + 2 + 4;
+    if(data.size() < 2u || readLE<uint16_t>(data.data()) != 0xFDE7u)
+    {
+        // Plain text, see ArchivItem_Text::load
+        std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+        if(!text.empty() && text.back() == '\0')
+            text.remove_suffix(1);
+        if(conversion)
+            text = text.substr(0, text.find('\26'));
+        buffer_.reserve(text.size() + text.size() / 8u + 1u);
+        addText(text, conversion);
+        return ErrorCode::NONE;
+    }
+
+    if(data.size() < headerSize)
+        return ErrorCode::WRONG_HEADER;
+    const auto count = readLE<uint16_t>(&data[2]);
+    uint32_t dataSize = readLE<uint32_t>(&data[6]);
+    if(dataSize == 0)
+        dataSize = static_cast<uint32_t>(data.size() - headerSize);
+    const size_t offsetsSize = count * sizeof(uint32_t);
+    if(dataSize < offsetsSize)
+        return ErrorCode::WRONG_FORMAT;
+    if(dataSize > data.size() - headerSize)
+        return ErrorCode::UNEXPECTED_EOF;
+
+    // Strings are referenced relative to the start of the offsets
+    const uint8_t* offsets = &data[headerSize];
+    const std::string_view stringData(reinterpret_cast<const char*>(offsets) + offsetsSize, dataSize - offsetsSize);
+    // Most chars are ASCII, converted umlauts need 2 bytes
+    buffer_.reserve(stringData.size() + stringData.size() / 8u);
+    entries_.reserve(count);
+    for(unsigned i = 0; i < count; i++)
+    {
+        const auto itemPos = readLE<uint32_t>(offsets + i * sizeof(uint32_t));
+        if(!itemPos)
+        {
+            entries_.push_back(Entry{NO_TEXT, 0});
+            continue;
+        }
+        if(itemPos < offsetsSize)
+        {
+            clear();
+            return ErrorCode::WRONG_FORMAT;
+        }
+        const std::string_view text = stringData.substr(std::min<size_t>(itemPos - offsetsSize, stringData.size()));
+        // All strings are NULL terminated
+        addText(text.substr(0, text.find('\0')), conversion);
+    }
+    return ErrorCode::NONE;
+}
+
+void TextTable::addText(std::string_view text, bool conversion)
+{
+    const auto offset = static_cast<uint32_t>(buffer_.size());
+    if(conversion)
+        appendOemTextAsUtf8(text, buffer_);
+    else
+        appendAnsiTextAsUtf8(text, buffer_);
+    entries_.push_back(Entry{offset, static_cast<uint32_t>(buffer_.size() - offset)});
+    buffer_.push_back('\0');
+}
+
+void TextTable::clear()
+{
+    buffer_.clear();
+    entries_.clear();
+}
+
+std::string_view TextTable::getText(size_t idx) const
+{
+    if(!hasText(idx))
+        return std::string_view();
+    return std::string_view(buffer_).substr(entries_[idx].offset, entries_[idx].length);
+}
+
+void TextTable::toArchiv(Archiv& items) const
+{
+    items.clear();
+    items.alloc(entries_.size());
+    for(size_t i = 0; i < entries_.size(); i++)
+    {
+        if(!hasText(i))
+            continue;
+        auto item = getAllocator().create<ArchivItem_Text>(BobType::Text);
+        item->setText(Utf8ToAnsi(getText(i)));
+        items.set(i, std::move(item));
+    }
+}
+
+} // namespace libsiedler2
@@ -5,6 +5,7 @@
 #include "Archiv.h"
 #include "ArchivItem_Palette.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include <boost/nowide/fstream.hpp>
 
@@ -21,7 +22,7 @@ int libsiedler2::loader::WriteACT(const boost::filesystem::path& filepath, const
     if(filepath.empty())
         return ErrorCode::INVALID_BUFFER;
 
-    const auto* palette = dynamic_cast<const ArchivItem_Palette*>(items[0]);
+    const auto* palette = item_cast<ArchivItem_Palette>(items[0]);
     if(!palette)
         return ErrorCode::WRONG_ARCHIVE;
 
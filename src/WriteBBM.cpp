@@ -5,6 +5,7 @@
 #include "Archiv.h"
 #include "ArchivItem_Palette.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <boost/nowide/fstream.hpp>
@@ -28,7 +29,7 @@ int libsiedler2::loader::WriteBBM(const boost::filesystem::path& filepath, const
     // Anzahl Paletten in Archiv suchen
     for(size_t i = 0; i < items.size(); ++i)
     {
-        if(dynamic_cast<const ArchivItem_Palette*>(items[i]))
+        if(item_cast<ArchivItem_Palette>(items[i]))
             ++numPalettes; //-V127
     }
 
@@ -45,7 +46,7 @@ int libsiedler2::loader::WriteBBM(const boost::filesystem::path& filepath, const
 
     for(size_t i = 0; i < items.size(); ++i)
     {
-        const auto* palette = dynamic_cast<const ArchivItem_Palette*>(items[i]);
+        const auto* palette = item_cast<ArchivItem_Palette>(items[i]);
         if(palette)
         {
             fs << cmap << uint32_t(256 * 3);
@@ -9,6 +9,7 @@
 #include "BmpHeader.h"
 #include "ErrorCodes.h"
 #include "fileFormatHelpers.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <boost/nowide/fstream.hpp>
@@ -31,7 +32,7 @@ int libsiedler2::loader::WriteBMP(const boost::filesystem::path& filepath, const
     if(filepath.empty())
         return ErrorCode::INVALID_BUFFER;
 
-    const auto* bitmap = dynamic_cast<const ArchivItem_BitmapBase*>(items[0]);
+    const auto* bitmap = item_cast<ArchivItem_BitmapBase>(items[0]);
     if(!bitmap)
         return ErrorCode::WRONG_ARCHIVE;
 
@@ -103,14 +104,14 @@ int libsiedler2::loader::WriteBMP(const boost::filesystem::path& filepath, const
 
     if(bitmap->getBobType() == BobType::BitmapPlayer)
     {
-        const auto* bmpPl = dynamic_cast<const ArchivItem_Bitmap_Player*>(bitmap);
+        const auto* bmpPl = item_cast<ArchivItem_Bitmap_Player>(bitmap);
         if(!bmpPl)
             return ErrorCode::UNSUPPORTED_FORMAT;
         if(int ec = bmpPl->print(&buffer.front(), bmih.width, bmih.height, bufFmt, palette, 128))
             return ec;
     } else
     {
-        const auto* bmpBase = dynamic_cast<const baseArchivItem_Bitmap*>(bitmap);
+        const auto* bmpBase = item_cast<baseArchivItem_Bitmap>(bitmap);
         if(!bmpBase)
             return ErrorCode::UNSUPPORTED_FORMAT;
         if(int ec = bmpBase->print(&buffer.front(), bmih.width, bmih.height, bufFmt, palette))
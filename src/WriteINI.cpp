@@ -5,8 +5,10 @@
 #include "Archiv.h"
 #include "ArchivItem_Ini.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include <boost/nowide/fstream.hpp>
+#include <string>
 
 /**
  *  schreibt ein Archiv in eine INI-File.
@@ -26,19 +28,18 @@ int libsiedler2::loader::WriteINI(const boost::filesystem::path& filepath, const
     if(!fs)
         return ErrorCode::FILE_NOT_ACCESSIBLE;
 
-    bool first = true;
+    // Collect all sections and write them at once
+    std::string buffer;
     for(size_t i = 0; i < items.size(); ++i)
     {
-        const auto* item = dynamic_cast<const ArchivItem_Ini*>(items.get(i));
+        const auto* item = item_cast<ArchivItem_Ini>(items.get(i));
         if(!item)
             return ErrorCode::WRONG_ARCHIVE;
-        if(!first)
-            fs << "\r\n";
-        else
-            first = false;
-        if(int ec = item->write(fs))
-            return ec;
+        if(i > 0)
+            buffer += "\r\n";
+        item->write(buffer);
     }
+    fs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 
-    return ErrorCode::NONE;
+    return (!fs) ? ErrorCode::UNEXPECTED_EOF : ErrorCode::NONE;
 }
@@ -8,6 +8,7 @@
 #include "ArchivItem_PaletteAnimation.h"
 #include "ErrorCodes.h"
 #include "PixelBufferPaletted.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <boost/nowide/fstream.hpp>
@@ -18,7 +19,7 @@ int libsiedler2::loader::WriteLBM(const boost::filesystem::path& filepath, const
     if(filepath.empty())
         return ErrorCode::INVALID_BUFFER;
 
-    const auto* bmp = dynamic_cast<const baseArchivItem_Bitmap*>(items[0]);
+    const auto* bmp = item_cast<baseArchivItem_Bitmap>(items[0]);
     if(!bmp)
         return ErrorCode::WRONG_ARCHIVE;
     if(bmp->getPalette())
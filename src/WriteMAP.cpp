@@ -5,6 +5,7 @@
 #include "Archiv.h"
 #include "ArchivItem_Map.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include <boost/nowide/fstream.hpp>
 
@@ -21,7 +22,7 @@ int libsiedler2::loader::WriteMAP(const boost::filesystem::path& filepath, const
     if(filepath.empty())
         return ErrorCode::INVALID_BUFFER;
 
-    const auto* item = dynamic_cast<const ArchivItem_Map*>(items[0]);
+    const auto* item = item_cast<ArchivItem_Map>(items[0]);
     if(!item)
         return ErrorCode::WRONG_ARCHIVE;
 
@@ -5,6 +5,7 @@
 #include "Archiv.h"
 #include "ArchivItem_Sound.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include <boost/nowide/fstream.hpp>
 
@@ -17,7 +18,7 @@ int libsiedler2::loader::WriteSND(const boost::filesystem::path& filepath, const
     if(items.size() != 1)
         return ErrorCode::WRONG_ARCHIVE;
 
-    const auto* snd = dynamic_cast<const ArchivItem_Sound*>(items[0]);
+    const auto* snd = item_cast<ArchivItem_Sound>(items[0]);
     if(!snd)
         return ErrorCode::WRONG_ARCHIVE;
 
@@ -0,0 +1,34 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Archiv.h"
+#include "ArchivItem_Map.h"
+#include "ErrorCodes.h"
+#include "itemCast.h"
+#include "prototypen.h"
+#include <boost/nowide/fstream.hpp>
+
+/**
+ *  write the map in an archive into a compressed map file.
+ *
+ *  @param[in] filepath    Path to the SWZ file
+ *  @param[in] items   Archive containing the map as the first item
+ *
+ *  @return Null on success, an ErrorCode otherwise
+ */
+int libsiedler2::loader::WriteSWZ(const boost::filesystem::path& filepath, const Archiv& items)
+{
+    if(filepath.empty())
+        return ErrorCode::INVALID_BUFFER;
+
+    const auto* item = item_cast<ArchivItem_Map>(items[0]);
+    if(!item)
+        return ErrorCode::WRONG_ARCHIVE;
+
+    boost::nowide::ofstream fs(filepath, std::ios_base::binary);
+    if(!fs)
+        return ErrorCode::FILE_NOT_ACCESSIBLE;
+
+    return item->writeCompressed(fs);
+}
@@ -5,6 +5,7 @@
 #include "Archiv.h"
 #include "ArchivItem_Text.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <boost/nowide/fstream.hpp>
@@ -29,7 +30,7 @@ int libsiedler2::loader::WriteTXT(const boost::filesystem::path& filepath, const
 
     // All entries have to be texts or empty
     const auto isInvalidEntry = [](const auto& item) {
-        return item && !dynamic_cast<const ArchivItem_Text*>(item.get());
+        return item && !item_cast<ArchivItem_Text>(item.get());
     };
     if(std::find_if(begin(items), end(items), isInvalidEntry) != end(items))
         return ErrorCode::WRONG_ARCHIVE;
@@ -13,6 +13,7 @@
 #include "ArchivItem_PaletteAnimation.h"
 #include "ArchivItem_Sound.h"
 #include "ErrorCodes.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include "libendian/EndianOStreamAdapter.h"
 #include <iostream>
@@ -39,7 +40,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
         {
             case BobType::Sound: // WAVs, MIDIs
             {
-                const auto& i = dynamic_cast<const ArchivItem_Sound&>(item);
+                const auto& i = item_cast<ArchivItem_Sound>(item);
                 libendian::EndianOStreamAdapter<false, std::ostream&> fs(lst);
                 const long sizePos = fs.getPosition();
                 fs << uint32_t(0);
@@ -53,7 +54,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::BitmapRLE: // RLE komprimiertes Bitmap
             {
-                const auto& i = dynamic_cast<const baseArchivItem_Bitmap_RLE&>(item);
+                const auto& i = item_cast<baseArchivItem_Bitmap_RLE>(item);
 
                 if(int ec = i.write(lst, palette))
                     return ec;
@@ -61,7 +62,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::Font: // Font
             {
-                const auto& i = dynamic_cast<const ArchivItem_Font&>(item);
+                const auto& i = item_cast<ArchivItem_Font>(item);
 
                 if(int ec = i.write(lst, palette))
                     return ec;
@@ -69,7 +70,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::BitmapPlayer: // Bitmap mit spezifischer Spielerfarbe
             {
-                const auto& i = dynamic_cast<const ArchivItem_Bitmap_Player&>(item);
+                const auto& i = item_cast<ArchivItem_Bitmap_Player>(item);
 
                 if(int ec = i.write(lst, palette))
                     return ec;
@@ -77,7 +78,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::Palette: // Palette
             {
-                const auto& i = dynamic_cast<const ArchivItem_Palette&>(item);
+                const auto& i = item_cast<ArchivItem_Palette>(item);
 
                 if(int ec = i.write(lst))
                     return ec;
@@ -85,7 +86,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::BitmapShadow: // Schatten
             {
-                const auto& i = dynamic_cast<const baseArchivItem_Bitmap_Shadow&>(item);
+                const auto& i = item_cast<baseArchivItem_Bitmap_Shadow>(item);
 
                 if(int ec = i.write(lst, palette))
                     return ec;
@@ -93,7 +94,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::Bob: // Bobfile
             {
-                const auto& i = dynamic_cast<const ArchivItem_Bob&>(item);
+                const auto& i = item_cast<ArchivItem_Bob>(item);
 
                 if(int ec = i.write(lst, palette))
                     return ec;
@@ -101,7 +102,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::Map: // Mapfile
             {
-                const auto& i = dynamic_cast<const ArchivItem_Map&>(item);
+                const auto& i = item_cast<ArchivItem_Map>(item);
 
                 if(int ec = i.write(lst))
                     return ec;
@@ -109,7 +110,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::Bitmap: // unkomprimiertes Bitmap
             {
-                const auto& i = dynamic_cast<const baseArchivItem_Bitmap_Raw&>(item);
+                const auto& i = item_cast<baseArchivItem_Bitmap_Raw>(item);
 
                 if(int ec = i.write(lst, palette))
                     return ec;
@@ -117,7 +118,7 @@ int libsiedler2::loader::WriteType(BobType bobtype, std::ostream& lst, const Arc
             break;
             case BobType::PaletteAnim:
             {
-                const auto& nitem = dynamic_cast<const ArchivItem_PaletteAnimation&>(item);
+                const auto& nitem = item_cast<ArchivItem_PaletteAnimation>(item);
                 if(int ec = nitem.write(lst)) //-V522
                     return ec;
             }
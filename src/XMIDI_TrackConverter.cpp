@@ -42,29 +42,19 @@ struct LogStatus
 XMIDI_TrackConverter::XMIDI_TrackConverter(const XMIDI_Track& track) : track(track)
 {
     position = 0;
-    curEvent = nullptr;
-    events = nullptr;
-    numEvents = 0,
 
     std::fill(bank127.begin(), bank127.end(), false);
 }
 
-XMIDI_TrackConverter::~XMIDI_TrackConverter()
-{
-    curEvent = events;
-    while(curEvent)
-    {
-        MIDI_Event* next = curEvent->next;
-        delete curEvent;
-        curEvent = next;
-    }
-}
+XMIDI_TrackConverter::~XMIDI_TrackConverter() = default;
 
 bool XMIDI_TrackConverter::Convert()
 {
     // Already done -> Abort
-    if(events)
+    if(!events.empty())
         return false;
+    // Each event takes at least 2 bytes (note on: at least 4 for 2 events), plus the first state events
+    events.reserve(track.getData().size() / 2u + 16u * 4u + 1u);
     ConvertTrackToList();
     return true;
 }
@@ -148,9 +138,12 @@ int XMIDI_TrackConverter::ConvertTrackToList()
         }
         LogStatus("\n");
     }
-    curEvent = events;
 
     ApplyFirstState(fs, retval);
+    // Events are in the order they were created, which is sorted except for note offs.
+    // Events with the same time must stay in creation order.
+    std::stable_sort(events.begin(), events.end(),
+                     [](const MIDI_Event& lhs, const MIDI_Event& rhs) { return lhs.time < rhs.time; });
 
     return retval;
 }
@@ -210,36 +203,36 @@ void XMIDI_TrackConverter::ConvertNote(int time, uint8_t status, int size)
 {
     int data = track.getData()[position++];
 
-    CreateNewEvent(time);
-    curEvent->status = status;
+    MIDI_Event& event = CreateNewEvent(time);
+    event.status = status;
 
-    curEvent->data[0] = data;
-    curEvent->data[1] = track.getData()[position++];
+    event.data[0] = data;
+    event.data[1] = track.getData()[position++];
 
     // Volume modify the note on's, only if converting
-    if((curEvent->status >> 4) == MIDI_STATUS_NOTE_ON && curEvent->data[1])
-        curEvent->data[1] = VolumeCurve[curEvent->data[1]];
+    if((event.status >> 4) == MIDI_STATUS_NOTE_ON && event.data[1])
+        event.data[1] = VolumeCurve[event.data[1]];
 
     if(size == 2)
         return;
 
     // XMI Note On handling
-    curEvent->duration = GetVLQ();
+    const int duration = GetVLQ();
 
-    LogStatus(" note duration ") << curEvent->duration;
-
-    // This is an optimization
-    MIDI_Event* prev = curEvent;
+    LogStatus(" note duration ") << duration;
 
     // Create a note off
-    CreateNewEvent(time + curEvent->duration);
+    MIDI_Event& noteOff = CreateNewEvent(time + duration);
 
-    curEvent->status = status;
-    curEvent->data[0] = data;
-    curEvent->data[1] = 0;
+    noteOff.status = status;
+    noteOff.data[0] = data;
+    noteOff.data[1] = 0;
+}
 
-    // Optimization
-    curEvent = prev;
+void XMIDI_TrackConverter::SetFirstState(int& firstEvent, int time) const
+{
+    if(firstEvent == NO_EVENT || events[firstEvent].time > time)
+        firstEvent = static_cast<int>(events.size()) - 1;
 }
 
 void XMIDI_TrackConverter::ConvertEvent(int time, uint8_t status, int size, first_state& fs)
@@ -254,112 +247,65 @@ void XMIDI_TrackConverter::ConvertEvent(int time, uint8_t status, int size, firs
     else if(curStatus == MIDI_STATUS_PROG_CHANGE && statValue == 9)
         return;
 
-    CreateNewEvent(time);
-    curEvent->status = status;
-    curEvent->data[0] = data;
+    MIDI_Event& event = CreateNewEvent(time);
+    event.status = status;
+    event.data[0] = data;
     LogStatus(" type ") << unsigned(statValue) << ", " << unsigned(data);
 
     // Check for patch change, and update fs if req
     if(curStatus == MIDI_STATUS_PROG_CHANGE)
-    {
-        if(!fs.patch[statValue] || fs.patch[statValue]->time > time)
-            fs.patch[statValue] = curEvent;
-    }
+        SetFirstState(fs.patch[statValue], time);
 
     // Controllers
     else if(curStatus == MIDI_STATUS_CONTROLLER)
     {
         // Volume
-        if(curEvent->data[0] == 7)
-        {
-            if(!fs.vol[statValue] || fs.vol[statValue]->time > time)
-                fs.vol[statValue] = curEvent;
-        }
+        if(event.data[0] == 7)
+            SetFirstState(fs.vol[statValue], time);
         // Pan
-        else if(curEvent->data[0] == 10)
-        {
-            if(!fs.pan[statValue] || fs.pan[statValue]->time > time)
-                fs.pan[statValue] = curEvent;
-        }
+        else if(event.data[0] == 10)
+            SetFirstState(fs.pan[statValue], time);
     }
 
     if(size == 1)
         return;
 
-    curEvent->data[1] = track.getData()[position++];
-    LogStatus(", ") << unsigned(curEvent->data[1]);
+    event.data[1] = track.getData()[position++];
+    LogStatus(", ") << unsigned(event.data[1]);
 
     // Volume modify the volume controller, only if converting
-    if(curStatus == MIDI_STATUS_CONTROLLER && curEvent->data[0] == 7)
-        curEvent->data[1] = VolumeCurve[curEvent->data[1]];
+    if(curStatus == MIDI_STATUS_CONTROLLER && event.data[0] == 7)
+        event.data[1] = VolumeCurve[event.data[1]];
 }
 
 void XMIDI_TrackConverter::ConvertSystemMessage(int time, uint8_t status)
 {
-    CreateNewEvent(time);
-    curEvent->status = status;
+    MIDI_Event& event = CreateNewEvent(time);
+    event.status = status;
 
     // Handling of Meta events
     if(status == 0xFF)
-        curEvent->data[0] = track.getData()[position++];
+        event.data[0] = track.getData()[position++];
 
     uint32_t len = GetVLQ();
     LogStatus(" curStat:") << unsigned(status) << " len: " << len;
 
-    curEvent->buffer.clear();
     if(!len)
         return;
+    if(len > track.getData().size() - position)
+        throw std::runtime_error("System message exceeds track");
 
-    std::copy(track.getData().begin() + position, track.getData().begin() + position + len,
-              std::back_inserter(curEvent->buffer));
+    event.bufferOffset = static_cast<uint32_t>(sysexData.size());
+    event.bufferSize = len;
+    sysexData.insert(sysexData.end(), track.getData().begin() + position, track.getData().begin() + position + len);
     position += len;
 }
 
-void XMIDI_TrackConverter::CreateNewEvent(int time)
+XMIDI_TrackConverter::MIDI_Event& XMIDI_TrackConverter::CreateNewEvent(int time)
 {
-    if(!events)
-    {
-        events = curEvent = new MIDI_Event;
-        if(time > 0)
-            curEvent->time = time;
-        numEvents++;
-        return;
-    }
-
-    if(time < 0 || events->time > time)
-    {
-        auto* event = new MIDI_Event;
-        event->next = events;
-        events = curEvent = event;
-        numEvents++;
-        return;
-    }
-
-    if(!curEvent || curEvent->time > time)
-        curEvent = events;
-
-    while(curEvent->next)
-    {
-        if(curEvent->next->time > time)
-        {
-            auto* event = new MIDI_Event;
-
-            event->next = curEvent->next;
-            curEvent->next = event;
-            curEvent = event;
-            curEvent->time = time;
-            numEvents++;
-            return;
-        }
-
-        curEvent = curEvent->next;
-    }
-
-    curEvent->next = new MIDI_Event;
-    curEvent = curEvent->next;
-    curEvent->time = time;
-
-    numEvents++;
+    // Sorted by time after all events are created
+    events.emplace_back(std::max(time, 0));
+    return events.back();
 }
 
 MIDI_Track XMIDI_TrackConverter::CreateMidiTrack() const
@@ -369,6 +315,9 @@ MIDI_Track XMIDI_TrackConverter::CreateMidiTrack() const
     int lasttime = 0;
     uint8_t last_status = 0;
 
+    // Header, per event at most 4 bytes delta time, 3 bytes data and the payload length, end marker
+    midData.reserve(8u + events.size() * 11u + sysexData.size() + 8u);
+
     // Header schreiben
     midData.push_back('M');
     midData.push_back('T');
@@ -379,25 +328,25 @@ MIDI_Track XMIDI_TrackConverter::CreateMidiTrack() const
     size_t lenPos = midData.size();
     std::fill_n(std::back_inserter(midData), 4, 0);
 
-    for(MIDI_Event* event = events; event; event = event->next)
+    for(const MIDI_Event& event : events)
     {
-        if(event->status == 0xFF && event->data[0] == 0x2f)
+        if(event.status == 0xFF && event.data[0] == 0x2f)
         {
-            lasttime = event->time;
+            lasttime = event.time;
             break;
         }
 
-        uint32_t delta = (event->time - time);
-        time = event->time;
+        uint32_t delta = (event.time - time);
+        time = event.time;
 
         PutVLQ(delta, midData);
 
-        if((event->status != last_status) || (event->status >= 0xF0))
-            midData.push_back(event->status);
+        if((event.status != last_status) || (event.status >= 0xF0))
+            midData.push_back(event.status);
 
-        last_status = event->status;
+        last_status = event.status;
 
-        switch(event->status >> 4)
+        switch(event.status >> 4)
         {
             // 2 bytes data
             // Note off, Note on, Aftertouch, Controller and Pitch Wheel
@@ -406,24 +355,24 @@ MIDI_Track XMIDI_TrackConverter::CreateMidiTrack() const
             case 0xA:
             case 0xB:
             case 0xE:
-                midData.push_back(event->data[0]);
-                midData.push_back(event->data[1]);
+                midData.push_back(event.data[0]);
+                midData.push_back(event.data[1]);
                 break;
 
             // 1 bytes data
             // Program Change and Channel Pressure
             case 0xC:
-            case 0xD: midData.push_back(event->data[0]); break;
+            case 0xD: midData.push_back(event.data[0]); break;
 
             // Variable length
             // SysEx
             case 0xF:
-                if(event->status == 0xFF)
-                    midData.push_back(event->data[0]);
+                if(event.status == 0xFF)
+                    midData.push_back(event.data[0]);
 
-                PutVLQ(static_cast<uint32_t>(event->buffer.size()), midData);
+                PutVLQ(event.bufferSize, midData);
 
-                std::copy(event->buffer.begin(), event->buffer.end(), std::back_inserter(midData));
+                std::copy_n(sysexData.begin() + event.bufferOffset, event.bufferSize, std::back_inserter(midData));
                 break;
         }
     }
@@ -448,89 +397,57 @@ MIDI_Track XMIDI_TrackConverter::CreateMidiTrack() const
 
 void XMIDI_TrackConverter::ApplyFirstState(first_state& fs, int chan_mask)
 {
-    for(uint8_t channel = 0; channel < 16; channel++)
+    std::vector<MIDI_Event> firstEvents;
+    firstEvents.reserve(1u + 16u * 4u);
+    // Tempo of 500.000 ms per quarter note
+    // XMIDI has a fixed rate of 120Hz so PPQN should then be set to 60
+    MIDI_Event& tempo = firstEvents.emplace_back(0, 0xFF);
+    tempo.data[0] = 0x51;
+    tempo.bufferOffset = static_cast<uint32_t>(sysexData.size());
+    tempo.bufferSize = 3;
+    sysexData.push_back(0x07);
+    sysexData.push_back(0xA1);
+    sysexData.push_back(0x20);
+
+    // Channels are ordered from last to first
+    for(int channel = 15; channel >= 0; channel--)
     {
-        MIDI_Event* patch = fs.patch[channel];
-        MIDI_Event* vol = fs.vol[channel];
-        MIDI_Event* pan = fs.pan[channel];
-        MIDI_Event* bank = fs.bank[channel];
-        MIDI_Event* temp;
-
-        if(!patch || !(chan_mask & 1 << channel))
+        if(fs.patch[channel] == NO_EVENT || !(chan_mask & 1 << channel))
             continue;
-
-        // Copy Patch Change Event
-        temp = patch;
-        patch = new MIDI_Event;
-        patch->time = temp->time;
-        patch->status = (uint8_t)(channel | (MIDI_STATUS_PROG_CHANGE << 4));
-        patch->data[0] = temp->data[0];
-
-        // Copy Volume
-        if(vol && (vol->time > patch->time + PATCH_VOL_PAN_BIAS || vol->time < patch->time - PATCH_VOL_PAN_BIAS))
-            vol = nullptr;
-
-        temp = vol;
-        vol = new MIDI_Event;
-        vol->status = (uint8_t)(channel | (MIDI_STATUS_CONTROLLER << 4));
-        vol->data[0] = 7;
-
-        if(!temp)
-            vol->data[1] = VolumeCurve[90];
-        else
-            vol->data[1] = temp->data[1];
+        const MIDI_Event& patch = events[fs.patch[channel]];
+        // Return the event if it is near the patch change, else nullptr
+        const auto getNearPatch = [this, &patch](int eventIdx) -> const MIDI_Event* {
+            if(eventIdx == NO_EVENT)
+                return nullptr;
+            const MIDI_Event& event = events[eventIdx];
+            if(event.time > patch.time + PATCH_VOL_PAN_BIAS || event.time < patch.time - PATCH_VOL_PAN_BIAS)
+                return nullptr;
+            return &event;
+        };
+        const auto controller = static_cast<uint8_t>(channel | (MIDI_STATUS_CONTROLLER << 4));
 
         // Copy Bank
-        if(bank && (bank->time > patch->time + PATCH_VOL_PAN_BIAS || bank->time < patch->time - PATCH_VOL_PAN_BIAS))
-            bank = nullptr;
-
-        temp = bank;
-
-        bank = new MIDI_Event;
-        bank->status = (uint8_t)(channel | (MIDI_STATUS_CONTROLLER << 4));
+        MIDI_Event& bank = firstEvents.emplace_back(0, controller);
+        const MIDI_Event* origBank = getNearPatch(fs.bank[channel]);
+        bank.data[1] = origBank ? origBank->data[1] : 0;
 
-        if(!temp)
-            bank->data[1] = 0;
-        else
-            bank->data[1] = temp->data[1];
+        // Copy Volume
+        MIDI_Event& vol = firstEvents.emplace_back(0, controller);
+        const MIDI_Event* origVol = getNearPatch(fs.vol[channel]);
+        vol.data[0] = 7;
+        vol.data[1] = origVol ? origVol->data[1] : VolumeCurve[90];
 
         // Copy Pan
-        if(pan && (pan->time > patch->time + PATCH_VOL_PAN_BIAS || pan->time < patch->time - PATCH_VOL_PAN_BIAS))
-            pan = nullptr;
-
-        temp = pan;
-        pan = new MIDI_Event;
-        pan->status = (uint8_t)(channel | (MIDI_STATUS_CONTROLLER << 4));
-        pan->data[0] = 10;
-
-        if(!temp)
-            pan->data[1] = 64;
-        else
-            pan->data[1] = temp->data[1];
+        MIDI_Event& pan = firstEvents.emplace_back(0, controller);
+        const MIDI_Event* origPan = getNearPatch(fs.pan[channel]);
+        pan.data[0] = 10;
+        pan.data[1] = origPan ? origPan->data[1] : 64;
 
-        vol->time = 0;
-        pan->time = 0;
-        patch->time = 0;
-        bank->time = 0;
-
-        bank->next = vol;
-        vol->next = pan;
-        pan->next = patch;
-
-        patch->next = events;
-
-        events = bank;
+        // Copy Patch Change Event
+        const auto progChange = static_cast<uint8_t>(channel | (MIDI_STATUS_PROG_CHANGE << 4));
+        MIDI_Event& newPatch = firstEvents.emplace_back(0, progChange);
+        newPatch.data[0] = patch.data[0];
     }
-    // Tempo of 500.000 ms per quarter note
-    // XMIDI has a fixed rate of 120Hz so PPQN should then be set to 60
-    auto* ev = new MIDI_Event;
-    ev->status = 0xFF;
-    ev->data[0] = 0x51;
-    ev->buffer.resize(3);
-    ev->buffer[0] = 0x07;
-    ev->buffer[1] = 0xA1;
-    ev->buffer[2] = 0x20;
-    ev->next = events;
-    events = ev;
+    events.insert(events.begin(), firstEvents.begin(), firstEvents.end());
 }
 } // namespace libsiedler2
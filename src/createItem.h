@@ -0,0 +1,56 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "ArchivItem_PaletteAnimation.h"
+#include "archives.h"
+#include <memory>
+
+namespace libsiedler2 {
+
+template<class T>
+struct ItemTag
+{
+    using type = T;
+};
+
+/// Create the item matching the given type and subtype.
+/// The actual creation is done by calling @p create with an ItemTag<T> of the item type and the ctor arguments
+template<class T_Creator>
+std::unique_ptr<ArchivItem> createItem(BobType type, SoundType subtype, const T_Creator& create)
+{
+    switch(type)
+    {
+        case BobType::Sound:
+        {
+            switch(subtype)
+            {
+                case SoundType::None: return nullptr;
+                case SoundType::Midi: return create(ItemTag<ArchivItem_Sound_Midi>());
+                case SoundType::Wave: return create(ItemTag<ArchivItem_Sound_Wave>());
+                case SoundType::XMidi: return create(ItemTag<ArchivItem_Sound_XMidi>());
+                default: return create(ItemTag<ArchivItem_Sound_Other>(), subtype);
+            }
+            break;
+        }
+        case BobType::BitmapRLE: return create(ItemTag<ArchivItem_Bitmap_RLE>());
+        case BobType::Font: return create(ItemTag<ArchivItem_Font>());
+        case BobType::BitmapPlayer: return create(ItemTag<ArchivItem_Bitmap_Player>());
+        case BobType::Palette: return create(ItemTag<ArchivItem_Palette>());
+        case BobType::Bob: return create(ItemTag<ArchivItem_Bob>());
+        case BobType::BitmapShadow: return create(ItemTag<ArchivItem_Bitmap_Shadow>());
+        case BobType::Map: return create(ItemTag<ArchivItem_Map>());
+        case BobType::Text: return create(ItemTag<ArchivItem_Text>());
+        case BobType::Raw: return create(ItemTag<ArchivItem_Raw>());
+        case BobType::MapHeader: return create(ItemTag<ArchivItem_Map_Header>());
+        case BobType::Ini: return create(ItemTag<ArchivItem_Ini>());
+        case BobType::Bitmap: return create(ItemTag<ArchivItem_Bitmap_Raw>());
+        case BobType::PaletteAnim: return create(ItemTag<ArchivItem_PaletteAnimation>());
+        default: return nullptr;
+    }
+    return nullptr;
+}
+
+} // namespace libsiedler2
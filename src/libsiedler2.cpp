@@ -12,6 +12,7 @@
 #include "ErrorCodes.h"
 #include "PixelBufferBGRA.h"
 #include "StandardAllocator.h"
+#include "itemCast.h"
 #include "prototypen.h"
 #include "s25util/StringConversion.h"
 #include "s25util/Tokenizer.h"
@@ -22,6 +23,7 @@
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 namespace bfs = boost::filesystem;
 using boost::bad_numeric_cast;
@@ -51,6 +53,18 @@ static TextureFormat texturformat;
  *  Der gesetzte Item-Allokator.
  */
 static IAllocator* allocator = nullptr;
+/// Allocator of the innermost AllocatorScope of the current thread
+static thread_local const IAllocator* threadAllocator = nullptr;
+
+/**
+ *  Der Kontext zum Teilen identischer Pixeldaten (optional).
+ */
+static DeduplicationContext* deduplicationContext = nullptr;
+
+/**
+ *  Sollen Sounds auf die gemappte Datei verweisen statt ihre Daten zu kopieren?
+ */
+static bool soundDataMapping = false;
 
 } // namespace libsiedler2
 
@@ -109,7 +123,17 @@ TextureFormat getGlobalTextureFormat()
 
 const IAllocator& getAllocator()
 {
-    return *allocator;
+    return threadAllocator ? *threadAllocator : *allocator;
+}
+
+AllocatorScope::AllocatorScope(const IAllocator& allocator) : prevAllocator_(threadAllocator)
+{
+    threadAllocator = &allocator;
+}
+
+AllocatorScope::~AllocatorScope()
+{
+    threadAllocator = prevAllocator_;
 }
 
 /**
@@ -123,6 +147,28 @@ void setAllocator(IAllocator* newAllocator)
     allocator = newAllocator;
 }
 
+DeduplicationContext* setDeduplicationContext(DeduplicationContext* context)
+{
+    std::swap(deduplicationContext, context);
+    return context;
+}
+
+DeduplicationContext* getDeduplicationContext()
+{
+    return deduplicationContext;
+}
+
+bool setSoundDataMapping(bool enable)
+{
+    std::swap(soundDataMapping, enable);
+    return enable;
+}
+
+bool getSoundDataMapping()
+{
+    return soundDataMapping;
+}
+
 /**
  *  Lädt die Datei im Format ihrer Endung.
  *
@@ -165,6 +211,8 @@ int Load(const boost::filesystem::path& filepath, Archiv& items, const ArchivIte
             ret = loader::LoadLST(filepath, items, palette);
         else if(extension == "swd" || extension == "wld")
             ret = loader::LoadMAP(filepath, items);
+        else if(extension == "swz")
+            ret = loader::LoadSWZ(filepath, items);
         else if(extension == "ger" || extension == "eng")
             ret = loader::LoadTXT(filepath, items, true);
         else if(extension == "ini")
@@ -197,150 +245,177 @@ int Load(const boost::filesystem::path& filepath, Archiv& items, const ArchivIte
     return ret;
 }
 
-int LoadFolder(std::vector<FileEntry> folderInfos, Archiv& items, const ArchivItem_Palette* palette)
-{
-    std::sort(folderInfos.begin(), folderInfos.end());
-    libsiedler2::PixelBufferBGRA buffer(1000, 1000);
-    for(const FileEntry& entry : folderInfos)
+namespace {
+    void setItem(Archiv& items, unsigned nr, std::unique_ptr<ArchivItem> item)
     {
-        // Ignore
-        if(entry.bobtype == BobType::Unset)
-            continue;
-        std::unique_ptr<ArchivItem> newItem;
-        if(entry.bobtype == BobType::Font)
-        {
-            auto font = getAllocator().create<ArchivItem_Font>(BobType::Font);
-            font->isUnicode = s25util::toLower(entry.filePath.extension().string()) == ".fonx";
-            try
-            {
-                font->setDx(numeric_cast<uint8_t>(entry.nx));
-                font->setDy(numeric_cast<uint8_t>(entry.ny));
-            } catch(const bad_numeric_cast&)
-            {
-                return ErrorCode::CUSTOM + 1;
-            }
-            int ec;
-            if(bfs::is_directory(entry.filePath))
-                ec = LoadFolder(ReadFolderInfo(entry.filePath), *font, palette);
-            else
-                ec = Load(entry.filePath, *font, palette);
-            if(ec)
-                return ec;
+        if(nr >= items.size())
+            items.alloc_inc(nr - items.size() + 1);
+        items.set(nr, std::move(item));
+    }
+    void setItem(ArchivItem_Font& font, unsigned nr, std::unique_ptr<ArchivItem> item)
+    {
+        // Fonts grow as required and store only existing glyphs
+        font.set(nr, std::move(item));
+    }
+    void pushItem(Archiv& items, std::unique_ptr<ArchivItem> item) { items.push(std::move(item)); }
+    void pushItem(ArchivItem_Font& font, std::unique_ptr<ArchivItem> item) { font.set(font.size(), std::move(item)); }
 
-            newItem = std::move(font);
-        } else if(entry.bobtype != BobType::None)
+    /// Load the folder into an archive or the glyphs of a font
+    template<class T_Items>
+    int loadFolder(std::vector<FileEntry> folderInfos, T_Items& items, const ArchivItem_Palette* palette)
+    {
+        std::sort(folderInfos.begin(), folderInfos.end());
+        libsiedler2::PixelBufferBGRA buffer(1000, 1000);
+        for(const FileEntry& entry : folderInfos)
         {
-            const ArchivItem_Palette* curPal = palette;
-            if(entry.nr >= 0)
-            {
-                if(static_cast<unsigned>(entry.nr) < items.size() && items[entry.nr]->getBobType() == BobType::Palette)
-                    curPal = static_cast<const ArchivItem_Palette*>(items[entry.nr]);
-            } else if(!items.empty() && items[items.size() - 1u]
-                      && items[items.size() - 1u]->getBobType() == BobType::Palette)
-                curPal = static_cast<const ArchivItem_Palette*>(items[items.size() - 1u]);
-            Archiv tmpItems;
-            if(int ec = Load(entry.filePath, tmpItems, curPal))
-                return ec;
-            if(entry.bobtype == BobType::BitmapPlayer || entry.bobtype == BobType::Bitmap
-               || entry.bobtype == BobType::BitmapRLE || entry.bobtype == BobType::BitmapShadow)
+            // Ignore
+            if(entry.bobtype == BobType::Unset)
+                continue;
+            std::unique_ptr<ArchivItem> newItem;
+            if(entry.bobtype == BobType::Font)
             {
-                if(tmpItems.size() != 1)
-                    return ErrorCode::UNSUPPORTED_FORMAT;
+                auto font = getAllocator().create<ArchivItem_Font>(BobType::Font);
+                font->isUnicode = s25util::toLower(entry.filePath.extension().string()) == ".fonx";
+                try
+                {
+                    font->setDx(numeric_cast<uint8_t>(entry.nx));
+                    font->setDy(numeric_cast<uint8_t>(entry.ny));
+                } catch(const bad_numeric_cast&)
+                {
+                    return ErrorCode::CUSTOM + 1;
+                }
+                int ec;
+                if(bfs::is_directory(entry.filePath))
+                    ec = loadFolder(ReadFolderInfo(entry.filePath), *font, palette);
+                else
+                {
+                    Archiv glyphs;
+                    ec = Load(entry.filePath, glyphs, palette);
+                    for(unsigned i = 0; i < glyphs.size(); i++)
+                    {
+                        if(glyphs[i])
+                            font->set(i, glyphs.release(i));
+                    }
+                }
+                if(ec)
+                    return ec;
 
-                if(entry.bobtype == tmpItems[0]->getBobType())
+                newItem = std::move(font);
+            } else if(entry.bobtype != BobType::None)
+            {
+                const ArchivItem_Palette* curPal = palette;
+                if(entry.nr >= 0)
                 {
-                    // No conversion->Just take it
-                    newItem = tmpItems.release(0);
-                } else
+                    if(static_cast<unsigned>(entry.nr) < items.size() && items[entry.nr]
+                       && items[entry.nr]->getBobType() == BobType::Palette)
+                        curPal = static_cast<const ArchivItem_Palette*>(items[entry.nr]);
+                } else if(items.size() > 0u && items[items.size() - 1u]
+                          && items[items.size() - 1u]->getBobType() == BobType::Palette)
+                    curPal = static_cast<const ArchivItem_Palette*>(items[items.size() - 1u]);
+                Archiv tmpItems;
+                if(int ec = Load(entry.filePath, tmpItems, curPal))
+                    return ec;
+                if(entry.bobtype == BobType::BitmapPlayer || entry.bobtype == BobType::Bitmap
+                   || entry.bobtype == BobType::BitmapRLE || entry.bobtype == BobType::BitmapShadow)
                 {
-                    auto* bmp = dynamic_cast<ArchivItem_BitmapBase*>(tmpItems[0]);
-                    if(!bmp)
+                    if(tmpItems.size() != 1)
                         return ErrorCode::UNSUPPORTED_FORMAT;
-                    auto convertedBmp = getAllocator().create<ArchivItem_BitmapBase>(entry.bobtype);
-                    std::fill(buffer.begin(), buffer.end(), ColorBGRA());
-                    if(bmp->getBobType() == BobType::BitmapPlayer)
+
+                    if(entry.bobtype == tmpItems[0]->getBobType())
                     {
-                        auto* bmpPlayer = dynamic_cast<ArchivItem_Bitmap_Player*>(bmp);
-                        assert(bmpPlayer);
-                        if(int ec = bmpPlayer->print(buffer, curPal))
-                            return ec;
+                        // No conversion->Just take it
+                        newItem = tmpItems.release(0);
                     } else
                     {
-                        auto* bmpBase = dynamic_cast<baseArchivItem_Bitmap*>(bmp);
-                        assert(bmpBase);
-                        if(int ec = bmpBase->print(buffer))
-                            return ec;
-                    }
-
-                    switch(entry.bobtype)
-                    {
-                        case BobType::BitmapRLE:
-                        case BobType::BitmapShadow:
-                        case BobType::Bitmap:
+                        auto* bmp = item_cast<ArchivItem_BitmapBase>(tmpItems[0]);
+                        if(!bmp)
+                            return ErrorCode::UNSUPPORTED_FORMAT;
+                        auto convertedBmp = getAllocator().create<ArchivItem_BitmapBase>(entry.bobtype);
+                        std::fill(buffer.begin(), buffer.end(), ColorBGRA());
+                        if(bmp->getBobType() == BobType::BitmapPlayer)
+                        {
+                            auto* bmpPlayer = item_cast<ArchivItem_Bitmap_Player>(bmp);
+                            assert(bmpPlayer);
+                            if(int ec = bmpPlayer->print(buffer, curPal))
+                                return ec;
+                        } else
                         {
-                            auto* bmpBase = dynamic_cast<baseArchivItem_Bitmap*>(convertedBmp.get());
+                            auto* bmpBase = item_cast<baseArchivItem_Bitmap>(bmp);
                             assert(bmpBase);
-                            if(int ec = bmpBase->create(bmp->getWidth(), bmp->getHeight(), buffer)) //-V522
+                            if(int ec = bmpBase->print(buffer))
                                 return ec;
-                            break;
                         }
-                        case BobType::BitmapPlayer:
+
+                        switch(entry.bobtype)
                         {
-                            auto* bmpPl = dynamic_cast<ArchivItem_Bitmap_Player*>(convertedBmp.get());
-                            assert(bmpPl);
-                            if(int ec = bmpPl->create(bmp->getWidth(), bmp->getHeight(), buffer, curPal)) //-V522
-                                return ec;
+                            case BobType::BitmapRLE:
+                            case BobType::BitmapShadow:
+                            case BobType::Bitmap:
+                            {
+                                auto* bmpBase = item_cast<baseArchivItem_Bitmap>(convertedBmp.get());
+                                assert(bmpBase);
+                                if(int ec = bmpBase->create(bmp->getWidth(), bmp->getHeight(), buffer)) //-V522
+                                    return ec;
+                                break;
+                            }
+                            case BobType::BitmapPlayer:
+                            {
+                                auto* bmpPl = item_cast<ArchivItem_Bitmap_Player>(convertedBmp.get());
+                                assert(bmpPl);
+                                if(int ec = bmpPl->create(bmp->getWidth(), bmp->getHeight(), buffer, curPal)) //-V522
+                                    return ec;
+                            }
+                            break;
+                            default: return ErrorCode::UNSUPPORTED_FORMAT;
                         }
-                        break;
-                        default: return ErrorCode::UNSUPPORTED_FORMAT;
+                        newItem = std::move(convertedBmp);
                     }
-                    newItem = std::move(convertedBmp);
-                }
-                auto* bmp = static_cast<ArchivItem_BitmapBase*>(newItem.get());
-                try
-                {
-                    bmp->setNx(numeric_cast<int16_t>(entry.nx));
-                    bmp->setNy(numeric_cast<int16_t>(entry.ny));
-                } catch(const bad_numeric_cast&)
+                    auto* bmp = static_cast<ArchivItem_BitmapBase*>(newItem.get());
+                    try
+                    {
+                        bmp->setNx(numeric_cast<int16_t>(entry.nx));
+                        bmp->setNy(numeric_cast<int16_t>(entry.ny));
+                    } catch(const bad_numeric_cast&)
+                    {
+                        return ErrorCode::CUSTOM + 1;
+                    }
+                    if(curPal && !bmp->getPalette())
+                        bmp->setPaletteCopy(*curPal);
+                } else if(entry.bobtype == BobType::PaletteAnim)
                 {
-                    return ErrorCode::CUSTOM + 1;
-                }
-                if(curPal && !bmp->getPalette())
-                    bmp->setPaletteCopy(*curPal);
-            } else if(entry.bobtype == BobType::PaletteAnim)
-            {
-                for(unsigned i = 0; i < tmpItems.size(); i++)
+                    for(unsigned i = 0; i < tmpItems.size(); i++)
+                    {
+                        if(!tmpItems[i])
+                            continue;
+                        if(items[i])
+                            return ErrorCode::UNSUPPORTED_FORMAT;
+                        setItem(items, i, tmpItems.release(i));
+                    }
+                    continue;
+                } else
                 {
-                    if(!tmpItems[i])
-                        continue;
-                    if(items[i])
+                    // todo: andere typen als pal und bmp haben evtl mehr items!
+                    if(tmpItems.size() != 1)
                         return ErrorCode::UNSUPPORTED_FORMAT;
-                    if(i >= items.size())
-                        items.alloc_inc(i - items.size() + 1);
-                    items.set(i, tmpItems.release(i));
-                }
-                continue;
-            } else
-            {
-                // todo: andere typen als pal und bmp haben evtl mehr items!
-                if(tmpItems.size() != 1)
-                    return ErrorCode::UNSUPPORTED_FORMAT;
 
-                newItem = tmpItems.release(0);
+                    newItem = tmpItems.release(0);
+                }
             }
+            if(newItem)
+                newItem->setName(entry.name);
+            // had the filename a number? then set it to the corresponding item.
+            if(entry.nr >= 0)
+                setItem(items, entry.nr, std::move(newItem));
+            else
+                pushItem(items, std::move(newItem));
         }
-        if(newItem)
-            newItem->setName(entry.name);
-        // had the filename a number? then set it to the corresponding item.
-        if(entry.nr >= 0)
-        {
-            if(static_cast<unsigned>(entry.nr) >= items.size())
-                items.alloc_inc(entry.nr - items.size() + 1);
-            items.set(entry.nr, std::move(newItem));
-        } else
-            items.push(std::move(newItem));
+        return ErrorCode::NONE;
     }
-    return ErrorCode::NONE;
+} // namespace
+
+int LoadFolder(std::vector<FileEntry> folderInfos, Archiv& items, const ArchivItem_Palette* palette)
+{
+    return loadFolder(std::move(folderInfos), items, palette);
 }
 
 /**
@@ -376,6 +451,8 @@ int Write(const boost::filesystem::path& filepath, const Archiv& items, const Ar
             ret = loader::WriteLST(filepath, items, palette);
         else if(extension == "swd" || extension == "wld")
             ret = loader::WriteMAP(filepath, items);
+        else if(extension == "swz")
+            ret = loader::WriteSWZ(filepath, items);
         else if(extension == "ger" || extension == "eng")
             ret = loader::WriteTXT(filepath, items, true);
         else if(extension == "ini")
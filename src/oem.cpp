@@ -8,44 +8,176 @@
 
 namespace libsiedler2 {
 
-/// Konvertiertabelle von ANSI nach OEM, beginnend bei char 128
-static const std::array<uint8_t, 128> ansi2oem_tab = {
-  /*0080:*/ 0x00, 0x00, 0x00, 0x9F, 0x00, 0x00, 0x00, 0xD8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  /*0090:*/ 0x00, 0x60, 0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  /*00A0:*/ 0xFF, 0xAD, 0x9B, 0x9C, 0x0F, 0x9D, 0x7C, 0x15, 0x22, 0x63, 0xA6, 0xAE, 0xAA, 0x2D, 0x52, 0x00,
-  /*00B0:*/ 0xF8, 0xF1, 0xFD, 0x33, 0x27, 0xE6, 0x14, 0xFA, 0x2C, 0x31, 0xA7, 0xAF, 0xAC, 0xAB, 0x00, 0xA8,
-  /*00C0:*/ 0x41, 0x41, 0x41, 0x41, 0x8E, 0x8F, 0x92, 0x80, 0x45, 0x90, 0x45, 0x45, 0x49, 0x49, 0x49, 0x49,
-  /*00D0:*/ 0x44, 0xA5, 0x4F, 0x4F, 0x4F, 0x4F, 0x99, 0x78, 0x4F, 0x55, 0x55, 0x55, 0x9A, 0x59, 0x00, 0xE1,
-  /*00E0:*/ 0x85, 0xA0, 0x83, 0x61, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
-  /*00F0:*/ 0x64, 0xA4, 0x95, 0xA2, 0x93, 0x6F, 0x94, 0xF6, 0x6F, 0x97, 0xA3, 0x96, 0x81, 0x79, 0x00, 0x98,
-};
+namespace {
+    using CharTable = std::array<uint8_t, 256>;
+
+    /// Konvertiertabelle von ANSI nach OEM, beginnend bei char 128
+    constexpr std::array<uint8_t, 128> ansi2oem_tab = {
+      /*0080:*/ 0x00, 0x00, 0x00, 0x9F, 0x00, 0x00, 0x00, 0xD8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      /*0090:*/ 0x00, 0x60, 0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      /*00A0:*/ 0xFF, 0xAD, 0x9B, 0x9C, 0x0F, 0x9D, 0x7C, 0x15, 0x22, 0x63, 0xA6, 0xAE, 0xAA, 0x2D, 0x52, 0x00,
+      /*00B0:*/ 0xF8, 0xF1, 0xFD, 0x33, 0x27, 0xE6, 0x14, 0xFA, 0x2C, 0x31, 0xA7, 0xAF, 0xAC, 0xAB, 0x00, 0xA8,
+      /*00C0:*/ 0x41, 0x41, 0x41, 0x41, 0x8E, 0x8F, 0x92, 0x80, 0x45, 0x90, 0x45, 0x45, 0x49, 0x49, 0x49, 0x49,
+      /*00D0:*/ 0x44, 0xA5, 0x4F, 0x4F, 0x4F, 0x4F, 0x99, 0x78, 0x4F, 0x55, 0x55, 0x55, 0x9A, 0x59, 0x00, 0xE1,
+      /*00E0:*/ 0x85, 0xA0, 0x83, 0x61, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
+      /*00F0:*/ 0x64, 0xA4, 0x95, 0xA2, 0x93, 0x6F, 0x94, 0xF6, 0x6F, 0x97, 0xA3, 0x96, 0x81, 0x79, 0x00, 0x98,
+    };
+
+    /// Unicode code points of the Windows-1252 chars 0x80-0x9F. Undefined ones map to the C1 control chars
+    constexpr std::array<char16_t, 32> cp1252_tab = {
+      0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160,
+      0x2039, 0x0152, 0x008D, 0x017D, 0x008F, 0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022,
+      0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+    };
+
+    /// Unicode code points of the OEM (code page 437) chars 0x80-0xFF
+    constexpr std::array<char16_t, 128> cp437_tab = {
+      /*0080:*/ 0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7,
+      /*0088:*/ 0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+      /*0090:*/ 0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9,
+      /*0098:*/ 0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+      /*00A0:*/ 0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA,
+      /*00A8:*/ 0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+      /*00B0:*/ 0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+      /*00B8:*/ 0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+      /*00C0:*/ 0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+      /*00C8:*/ 0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+      /*00D0:*/ 0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+      /*00D8:*/ 0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+      /*00E0:*/ 0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4,
+      /*00E8:*/ 0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+      /*00F0:*/ 0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248,
+      /*00F8:*/ 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0,
+    };
+
+    /// Chars up to 128 are kept, all others use the conversion table
+    constexpr CharTable createAnsiToOemTable()
+    {
+        CharTable result{};
+        for(unsigned c = 0; c < 256; c++)
+            result[c] = (c > 128) ? ansi2oem_tab[c & 0x7F] : static_cast<uint8_t>(c);
+        return result;
+    }
+
+    /// Reverse of the ANSI->OEM table. Uses the first ANSI char mapping to an OEM char, or 0 if there is none
+    constexpr CharTable createOemToAnsiTable()
+    {
+        CharTable result{};
+        for(unsigned c = 0; c < 256; c++)
+        {
+            if(c <= 128)
+                result[c] = static_cast<uint8_t>(c);
+            else
+            {
+                for(unsigned i = 0x83; i < 256; ++i)
+                {
+                    if(ansi2oem_tab[i - 0x80] == c)
+                    {
+                        result[c] = static_cast<uint8_t>(i);
+                        break;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    constexpr CharTable ansiToOem = createAnsiToOemTable();
+    constexpr CharTable oemToAnsi = createOemToAnsiTable();
+
+    /// UTF-8 encoding of a char: Number of bytes followed by the bytes
+    using Utf8Char = std::array<char, 4>;
+    using Utf8Table = std::array<Utf8Char, 256>;
+
+    constexpr Utf8Char encodeUtf8(char16_t codePoint)
+    {
+        if(codePoint < 0x80)
+            return {1, static_cast<char>(codePoint)};
+        if(codePoint < 0x800)
+            return {2, static_cast<char>(0xC0 | (codePoint >> 6)), static_cast<char>(0x80 | (codePoint & 0x3F))};
+        return {3, static_cast<char>(0xE0 | (codePoint >> 12)), static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)),
+                static_cast<char>(0x80 | (codePoint & 0x3F))};
+    }
+
+    constexpr char16_t ansiToUnicode(uint8_t c)
+    {
+        return (c >= 0x80 && c < 0xA0) ? cp1252_tab[c - 0x80] : c;
+    }
+
+    constexpr Utf8Table createAnsiToUtf8Table()
+    {
+        Utf8Table result{};
+        for(unsigned c = 0; c < 256; c++)
+            result[c] = encodeUtf8(ansiToUnicode(static_cast<uint8_t>(c)));
+        return result;
+    }
+
+    /// Use the char of the ANSI counterpart, so converting via ANSI gives the same result.
+    /// Chars without one (e.g. box drawing or greek chars) use the code page 437 char
+    constexpr char16_t oemToUnicode(uint8_t c)
+    {
+        return (c < 0x80 || oemToAnsi[c] != 0) ? ansiToUnicode(oemToAnsi[c]) : cp437_tab[c - 0x80];
+    }
+
+    constexpr Utf8Table createOemToUtf8Table()
+    {
+        Utf8Table result{};
+        for(unsigned c = 0; c < 256; c++)
+            result[c] = encodeUtf8(oemToUnicode(static_cast<uint8_t>(c)));
+        return result;
+    }
+
+    constexpr Utf8Table ansiToUtf8 = createAnsiToUtf8Table();
+    constexpr Utf8Table oemToUtf8 = createOemToUtf8Table();
+
+    void appendUtf8(const Utf8Char& encoded, std::string& to)
+    {
+        to.append(&encoded[1], static_cast<size_t>(encoded[0]));
+    }
+
+    /// Return the ANSI char for the unicode code point or '?' if there is none
+    char unicodeToAnsi(uint32_t codePoint)
+    {
+        if(codePoint < 0x80 || (codePoint >= 0xA0 && codePoint < 0x100))
+            return static_cast<char>(codePoint);
+        for(unsigned i = 0; i < cp1252_tab.size(); i++)
+        {
+            if(cp1252_tab[i] == codePoint)
+                return static_cast<char>(0x80 + i);
+        }
+        return '?';
+    }
+
+    std::string convert(std::string_view from, const CharTable& table)
+    {
+        std::string result(from.size(), '\0');
+        for(size_t x = 0; x < from.size(); x++)
+            result[x] = static_cast<char>(table[static_cast<uint8_t>(from[x])]);
+        return result;
+    }
+
+    std::string convert(std::string_view from, const Utf8Table& table)
+    {
+        std::string result;
+        // Most chars are ASCII
+        result.reserve(from.size() + from.size() / 8u);
+        for(const char c : from)
+            appendUtf8(table[static_cast<uint8_t>(c)], result);
+        return result;
+    }
+} // namespace
 
 /** @name AnsiToOem
  *
  *  Wandelt einen String vom ANSI ins OEM Format um.
  *
  *  @param[in]  from   konstanter Quellstring
- *  @param[out] to     Zielstring (ausreichend Speicher muss vorhanden sein)
- *  @param[in]  length Länge des Quellstrings, wenn 0 wird @p strlen(from) verwendet
  *
- *  @return            @p to wird zurückgeliefert
+ *  @return            umgewandelter String
  */
-std::string AnsiToOem(const std::string& from)
+std::string AnsiToOem(std::string_view from)
 {
-    std::string result(from.size(), '\0');
-
-    // und string umwandeln
-    for(uint32_t x = 0; x < from.size(); x++)
-    {
-        auto C = (uint8_t)from[x];
-
-        // ab char 128 nötig
-        if(C > 128)
-            result[x] = (char)ansi2oem_tab[C & 0x7F];
-        else
-            result[x] = from[x];
-    }
-    return result;
+    return convert(from, ansiToOem);
 }
 
 /** @name OemToAnsi
@@ -53,32 +185,149 @@ std::string AnsiToOem(const std::string& from)
  *  Wandelt einen String vom OEM ins ANSI Format um.
  *
  *  @param[in]  from   konstanter Quellstring
- *  @param[out] to     Zielstring (ausreichend Speicher muss vorhanden sein)
- *  @param[in]  length Länge des Quellstrings, wenn 0 wird @p strlen(from) verwendet
  *
- *  @return            @p to wird zurückgeliefert
+ *  @return            umgewandelter String
  */
-std::string OemToAnsi(const std::string& from)
+std::string OemToAnsi(std::string_view from)
 {
-    std::string result(from.size(), '\0');
+    return convert(from, oemToAnsi);
+}
 
-    // und string umwandeln
-    for(uint32_t x = 0; x < from.size(); ++x)
+std::string OemToUtf8(std::string_view from)
+{
+    return convert(from, oemToUtf8);
+}
+
+std::string AnsiToUtf8(std::string_view from)
+{
+    return convert(from, ansiToUtf8);
+}
+
+std::string Utf8ToAnsi(std::string_view from)
+{
+    std::string result;
+    result.reserve(from.size());
+    for(size_t x = 0; x < from.size();)
     {
-        if((uint8_t)from[x] > 128)
+        const auto c = static_cast<uint8_t>(from[x++]);
+        unsigned numFollowing;
+        uint32_t codePoint;
+        if(c < 0x80)
+        {
+            result.push_back(static_cast<char>(c));
+            continue;
+        } else if((c & 0xE0) == 0xC0)
         {
-            for(int i = 0x83; i < 256; ++i)
+            numFollowing = 1;
+            codePoint = c & 0x1F;
+        } else if((c & 0xF0) == 0xE0)
+        {
+            numFollowing = 2;
+            codePoint = c & 0x0F;
+        } else if((c & 0xF8) == 0xF0)
+        {
+            numFollowing = 3;
+            codePoint = c & 0x07;
+        } else
+        {
+            result.push_back('?');
+            continue;
+        }
+        bool valid = true;
+        for(unsigned i = 0; i < numFollowing; i++, x++)
+        {
+            if(x >= from.size() || (static_cast<uint8_t>(from[x]) & 0xC0) != 0x80)
             {
-                if((uint8_t)from[x] == ansi2oem_tab[i - 0x80])
-                {
-                    result[x] = (char)i;
-                    break;
-                }
+                valid = false;
+                break;
             }
-        } else
-            result[x] = from[x];
+            codePoint = (codePoint << 6) | (static_cast<uint8_t>(from[x]) & 0x3F);
+        }
+        result.push_back(valid ? unicodeToAnsi(codePoint) : '?');
+    }
+    return result;
+}
+
+std::string OemTextToAnsi(std::string_view from)
+{
+    std::string result;
+    result.reserve(from.size());
+    for(size_t x = 0; x < from.size(); x++)
+    {
+        const char c = from[x];
+        if(c == '@' && x + 1 < from.size() && from[x + 1] == '@')
+        {
+            result.push_back('\n');
+            ++x;
+        } else if(c == '\r')
+            result.push_back('\n');
+        else
+            result.push_back(static_cast<char>(oemToAnsi[static_cast<uint8_t>(c)]));
+    }
+    return result;
+}
+
+std::string AnsiTextToOem(std::string_view from)
+{
+    std::string result;
+    result.reserve(from.size() + from.size() / 16u);
+    for(const char c : from)
+    {
+        if(c == '\n')
+            result.append("@@");
+        else
+            result.push_back(static_cast<char>(ansiToOem[static_cast<uint8_t>(c)]));
     }
     return result;
 }
 
+std::string normalizeLineBreaks(std::string_view from)
+{
+    std::string result;
+    result.reserve(from.size());
+    for(size_t x = 0; x < from.size(); x++)
+    {
+        if(from[x] != '\r')
+            result.push_back(from[x]);
+        else
+        {
+            result.push_back('\n');
+            if(x + 1 < from.size() && from[x + 1] == '\n')
+                ++x;
+        }
+    }
+    return result;
+}
+
+void appendOemTextAsUtf8(std::string_view from, std::string& to)
+{
+    for(size_t x = 0; x < from.size(); x++)
+    {
+        const char c = from[x];
+        if(c == '@' && x + 1 < from.size() && from[x + 1] == '@')
+        {
+            to.push_back('\n');
+            ++x;
+        } else if(c == '\r')
+            to.push_back('\n');
+        else
+            appendUtf8(oemToUtf8[static_cast<uint8_t>(c)], to);
+    }
+}
+
+void appendAnsiTextAsUtf8(std::string_view from, std::string& to)
+{
+    for(size_t x = 0; x < from.size(); x++)
+    {
+        if(from[x] != '\r')
+            appendUtf8(ansiToUtf8[static_cast<uint8_t>(from[x])], to);
+        else
+        {
+            to.push_back('\n');
+            if(x + 1 < from.size() && from[x + 1] == '\n')
+                ++x;
+        }
+    }
+}
+
 } // namespace libsiedler2
@@ -0,0 +1,61 @@
+// Copyright (C) 2005 - 2025 Settlers Freaks (sf-team at siedler25.org)
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace libsiedler2 {
+
+/// Call func(i) for each i in [0, count) using up to numThreads threads (0 = number of cores).
+/// The calling thread does part of the work. Indices are handed out one by one, so calls may take different times.
+/// If calls throw, the remaining indices are still processed and the first exception is rethrown after all threads
+/// are done. If not all threads can be started, the work is done by the ones running.
+template<class T_Func>
+void parallelFor(size_t count, unsigned numThreads, T_Func&& func)
+{
+    if(numThreads == 0u)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned>(std::min<size_t>(numThreads, count));
+
+    std::atomic<size_t> nextIdx(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    const auto work = [&]() {
+        for(size_t i = nextIdx++; i < count; i = nextIdx++)
+        {
+            try
+            {
+                func(i);
+            } catch(...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    try
+    {
+        threads.reserve(numThreads);
+        for(unsigned i = 1; i < numThreads; i++)
+            threads.emplace_back(work);
+    } catch(const std::system_error&)
+    {}
+    work();
+    for(std::thread& thread : threads)
+        thread.join();
+    if(error)
+        std::rethrow_exception(error);
+}
+
+} // namespace libsiedler2
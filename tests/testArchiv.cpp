@@ -2,15 +2,29 @@
 //
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "LoadPalette.h"
+#include "cmpFiles.h"
 #include "test/config.h"
 #include "libsiedler2/Archiv.h"
+#include "libsiedler2/ArchivItem_Bitmap_Player.h"
+#include "libsiedler2/ArchivItem_Bitmap_RLE.h"
+#include "libsiedler2/ArchivItem_Bob.h"
+#include "libsiedler2/ArchivItem_Font.h"
 #include "libsiedler2/ArchivItem_Raw.h"
+#include "libsiedler2/ArchivItem_Sound_Other.h"
+#include "libsiedler2/ArchivItem_Sound_Wave.h"
 #include "libsiedler2/IAllocator.h"
 #include "libsiedler2/enumTypes.h"
+#include "libsiedler2/itemCast.h"
+#include "libsiedler2/StandardAllocator.h"
 #include "libsiedler2/libsiedler2.h"
 #include <s25util/boostTestHelpers.h>
 #include <boost/test/unit_test.hpp>
+#include <atomic>
 #include <stdexcept>
+#include <thread>
+#include <typeinfo>
+#include <vector>
 
 namespace libsiedler2 {
 // LCOV_EXCL_START
@@ -101,6 +115,38 @@ BOOST_AUTO_TEST_CASE(Find)
     BOOST_TEST_REQUIRE(!archiv.find("NonExistant"));
 }
 
+BOOST_AUTO_TEST_CASE(Names)
+{
+    libsiedler2::ArchivItem_Raw item1, item2;
+    BOOST_TEST(item1.getName() == "untitled");
+    item1.setName(std::string("Foo") + "Bar");
+    item2.setName("FooBar");
+    BOOST_TEST(item1.getName() == "FooBar");
+    // Names are interned -> Same storage
+    BOOST_TEST(static_cast<const void*>(item1.getName().data()) == static_cast<const void*>(item2.getName().data()));
+    const auto item3 = clone(item1);
+    BOOST_TEST(item3->getName() == "FooBar");
+    item1.setName("");
+    BOOST_TEST(item1.getName().empty());
+    BOOST_TEST(item3->getName() == "FooBar");
+    // Names are released when unused and can be interned again
+    item2.setName("");
+    {
+        libsiedler2::ArchivItem_Raw item4;
+        item4.setName("Temporary");
+        BOOST_TEST(item4.getName() == "Temporary");
+    }
+    for(int i = 0; i < 100; i++)
+    {
+        libsiedler2::ArchivItem_Raw item5;
+        item5.setName("Temporary");
+        BOOST_TEST_REQUIRE(item5.getName() == "Temporary");
+        item5.setName("FooBar");
+        BOOST_TEST(static_cast<const void*>(item5.getName().data())
+                   == static_cast<const void*>(item3->getName().data()));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(CreateAllTypesAndCopy)
 {
     using namespace libsiedler2;
@@ -166,6 +212,72 @@ static_assert(!std::is_move_assignable_v<libsiedler2::ArchivItem>, "Should not b
 
 int TestItem::numLiveItems = 0;
 
+namespace {
+/// Subclass of a library type with the same tag but not of the class the loader uses
+struct CustomBitmap : libsiedler2::baseArchivItem_Bitmap_RLE
+{
+    RTTR_CLONEABLE(CustomBitmap)
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ItemCast)
+{
+    using namespace libsiedler2;
+    const auto bmpPlayer = getAllocator().create(BobType::BitmapPlayer);
+    const auto bmpRLE = getAllocator().create(BobType::BitmapRLE);
+    const auto bob = getAllocator().create(BobType::Bob);
+    const auto font = getAllocator().create(BobType::Font);
+    const auto wave = getAllocator().create(BobType::Sound, SoundType::Wave);
+    const auto ogg = getAllocator().create(BobType::Sound, SoundType::OGG);
+    const auto customBmp = std::make_unique<CustomBitmap>();
+    const TestItem testItem;
+
+    const std::vector<const ArchivItem*> items{bmpPlayer.get(), bmpRLE.get(), bob.get(), font.get(), wave.get(),
+                                               ogg.get(), customBmp.get(), &testItem};
+    // Results must match dynamic_cast, also for virtual bases and repeated casts of alternating types
+    for(int i = 0; i < 2; i++)
+    {
+        for(const ArchivItem* item : items)
+        {
+            BOOST_TEST_INFO_SCOPE("Type " << typeid(*item).name());
+            BOOST_TEST(item_cast<ArchivItem>(item) == item);
+            BOOST_TEST(item_cast<ArchivItem_BitmapBase>(item) == dynamic_cast<const ArchivItem_BitmapBase*>(item));
+            BOOST_TEST(item_cast<baseArchivItem_Bitmap>(item) == dynamic_cast<const baseArchivItem_Bitmap*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Bitmap>(item) == dynamic_cast<const ArchivItem_Bitmap*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Bitmap_Player>(item)
+                       == dynamic_cast<const ArchivItem_Bitmap_Player*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Bitmap_RLE>(item) == dynamic_cast<const ArchivItem_Bitmap_RLE*>(item));
+            BOOST_TEST(item_cast<CustomBitmap>(item) == dynamic_cast<const CustomBitmap*>(item));
+            BOOST_TEST(item_cast<libsiedler2::Archiv>(item) == dynamic_cast<const libsiedler2::Archiv*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Bob>(item) == dynamic_cast<const ArchivItem_Bob*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Sound>(item) == dynamic_cast<const ArchivItem_Sound*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Sound_Wave>(item) == dynamic_cast<const ArchivItem_Sound_Wave*>(item));
+            BOOST_TEST(item_cast<ArchivItem_Sound_Other>(item)
+                       == dynamic_cast<const ArchivItem_Sound_Other*>(item));
+            BOOST_TEST(item_cast<TestItem>(item) == dynamic_cast<const TestItem*>(item));
+        }
+    }
+    BOOST_TEST(item_cast<ArchivItem_Bitmap_Player>(static_cast<ArchivItem*>(nullptr)) == nullptr);
+    BOOST_TEST(item_cast<ArchivItem_Bitmap_Player>(bmpPlayer.get()) != nullptr);
+    BOOST_TEST(item_cast<ArchivItem_Font>(bob.get()) == nullptr);
+    // Types with an own class can't be other sounds, so the tag identifies the class
+    BOOST_CHECK_THROW(ArchivItem_Sound_Other(SoundType::Wave), std::invalid_argument);
+    BOOST_CHECK_THROW(ArchivItem_Sound_Other(SoundType::XMidi), std::invalid_argument);
+    // Casting from a derived class
+    const auto* bmpBase = item_cast<ArchivItem_BitmapBase>(bmpPlayer.get());
+    BOOST_TEST(item_cast<ArchivItem_Bitmap_Player>(bmpBase) == bmpPlayer.get());
+    // References
+    BOOST_TEST(&item_cast<ArchivItem_Bob>(*bob) == bob.get());
+    BOOST_CHECK_THROW(item_cast<ArchivItem_Bob>(*font), std::bad_cast);
+    // Owned
+    auto ownedBmp = item_cast<ArchivItem_Bitmap_Player>(getAllocator().create(BobType::BitmapPlayer));
+    BOOST_TEST(ownedBmp);
+    BOOST_TEST(!item_cast<ArchivItem_Bitmap_Player>(getAllocator().create(BobType::Raw)));
+    // Cloning via base classes
+    const auto clonedBmp = clone(bmpBase);
+    BOOST_TEST(dynamic_cast<const ArchivItem_Bitmap_Player*>(clonedBmp.get()));
+}
+
 BOOST_AUTO_TEST_CASE(AllocAndGet)
 {
     libsiedler2::Archiv archiv;
@@ -267,4 +379,45 @@ BOOST_AUTO_TEST_CASE(CopyArchive)
     BOOST_TEST(TestItem::numLiveItems == 0);
 }
 
+namespace {
+/// Allocator counting the created items
+struct CountingAllocator : libsiedler2::StandardAllocator
+{
+    mutable std::atomic<unsigned> numItems{0};
+    std::unique_ptr<libsiedler2::ArchivItem> create(libsiedler2::BobType type,
+                                                    libsiedler2::SoundType subtype) const override
+    {
+        ++numItems;
+        return StandardAllocator::create(type, subtype);
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(AllocatorScopeLoad, LoadPalette)
+{
+    const auto inPath = libsiedler2::test::inputPath / "testFonts.LST";
+    libsiedler2::Archiv archiv;
+    CountingAllocator allocator;
+    {
+        const libsiedler2::AllocatorScope scope(allocator);
+        BOOST_TEST(&libsiedler2::getAllocator() == &allocator);
+        {
+            // Scopes can be nested
+            const libsiedler2::StandardAllocator otherAllocator;
+            const libsiedler2::AllocatorScope innerScope(otherAllocator);
+            BOOST_TEST(&libsiedler2::getAllocator() == &otherAllocator);
+        }
+        BOOST_TEST(&libsiedler2::getAllocator() == &allocator);
+        BOOST_TEST_REQUIRE(libsiedler2::Load(inPath, archiv, palette) == 0);
+    }
+    BOOST_TEST(&libsiedler2::getAllocator() != &allocator);
+    // All fonts and glyphs are created by the allocator of the scope
+    BOOST_TEST(allocator.numItems > 20u);
+    // Other threads are not affected
+    const libsiedler2::AllocatorScope scope(allocator);
+    const libsiedler2::IAllocator* threadAllocator = nullptr;
+    std::thread([&threadAllocator]() { threadAllocator = &libsiedler2::getAllocator(); }).join();
+    BOOST_TEST(threadAllocator != &allocator);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
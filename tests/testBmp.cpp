@@ -10,16 +10,19 @@
 #include "libsiedler2/ArchivItem_Bitmap_Player.h"
 #include "libsiedler2/ArchivItem_Bitmap_Raw.h"
 #include "libsiedler2/ColorBGRA.h"
+#include "libsiedler2/DeduplicationContext.h"
 #include "libsiedler2/ErrorCodes.h"
 #include "libsiedler2/IAllocator.h"
 #include "libsiedler2/PixelBufferBGRA.h"
 #include "libsiedler2/PixelBufferPaletted.h"
+#include "libsiedler2/PixelBufferRef.h"
 #include "libsiedler2/libsiedler2.h"
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <algorithm>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <utility>
 
 namespace {
@@ -497,6 +500,142 @@ BOOST_AUTO_TEST_CASE(PaletteAfterCreateBitmap)
     BOOST_TEST_REQUIRE(!bmpPl.getPalette());
 }
 
+BOOST_AUTO_TEST_CASE(PalettesAreShared)
+{
+    PixelBufferPaletted palBuffer(4, 5);
+    ArchivItem_Bitmap_Raw bmp1, bmp2;
+    BOOST_TEST_REQUIRE(bmp1.create(palBuffer, palette) == 0);
+    BOOST_TEST_REQUIRE(bmp2.create(palBuffer, palette) == 0);
+    // Equal palettes are not duplicated
+    BOOST_TEST(bmp1.getPalette() != palette);
+    BOOST_TEST(bmp1.getPalette() == bmp2.getPalette());
+    const auto bmp3 = clone(bmp1);
+    BOOST_TEST(bmp3->getPalette() == bmp1.getPalette());
+    // Changing the palette of one does not affect the others
+    bmp2.setPaletteCopy(*modPal);
+    BOOST_TEST_REQUIRE(bmp2.getPalette() != bmp1.getPalette());
+    BOOST_TEST(*bmp2.getPalette() == *modPal);
+    BOOST_TEST(*bmp1.getPalette() == *palette);
+    BOOST_TEST(*bmp3->getPalette() == *palette);
+    auto newPal = clone(palette);
+    bmp2.setPalette(std::move(newPal));
+    BOOST_TEST(bmp2.getPalette() == bmp1.getPalette());
+    // Same colors but different name is not the same palette
+    newPal = clone(palette);
+    newPal->setName("OtherName");
+    bmp2.setPaletteCopy(*newPal);
+    BOOST_TEST(bmp2.getPalette() != bmp1.getPalette());
+    BOOST_TEST(bmp2.getPalette()->getName() == "OtherName");
+}
+
+BOOST_AUTO_TEST_CASE(ClonesSharePixelData)
+{
+    PixelBufferPaletted buffer(5, 3, 1);
+    buffer.set(1, 1, 129);
+    ArchivItem_Bitmap_Player bmp;
+    BOOST_TEST_REQUIRE(bmp.create(buffer, palette) == 0);
+    BOOST_TEST(!bmp.isPixelDataShared());
+    BOOST_TEST(!bmp.isPlayerDataShared());
+    const auto bmpCopy = clone(bmp);
+    BOOST_TEST(bmp.isPixelDataShared());
+    BOOST_TEST(bmp.isPlayerDataShared());
+    BOOST_TEST(std::as_const(*bmpCopy).getPixelData().data() == std::as_const(bmp).getPixelData().data());
+
+    // Only the modified copy detaches
+    bmpCopy->setPixel(0, 0, uint8_t(2));
+    BOOST_TEST(!bmpCopy->isPixelDataShared());
+    BOOST_TEST(bmpCopy->isPlayerDataShared());
+    BOOST_TEST(std::as_const(bmp).getPixelData()[0] == 1u);
+    BOOST_TEST(std::as_const(*bmpCopy).getPixelData()[0] == 2u);
+    BOOST_TEST(bmpCopy->getPlayerColorIdx(1, 1) == 1u);
+
+    // Recreating replaces the data of only this instance
+    BOOST_TEST_REQUIRE(bmpCopy->create(PixelBufferPaletted(5, 3, 1), palette) == 0);
+    BOOST_TEST(!bmpCopy->isPlayerColor(1, 1));
+    BOOST_TEST(bmp.isPlayerColor(1, 1));
+    BOOST_TEST(!bmp.isPixelDataShared());
+    BOOST_TEST(!bmp.isPlayerDataShared());
+}
+
+// Const references to possibly shared pixel data can't be used to modify it
+static_assert(std::is_same_v<decltype(std::declval<libsiedler2::PixelBufferPalettedConstRef&>().getPixelPtr(0, 0)),
+                             const uint8_t*>);
+static_assert(std::is_same_v<decltype(std::declval<libsiedler2::PixelBufferBGRAConstRef&>().getPixelPtr()),
+                             const uint8_t*>);
+
+BOOST_AUTO_TEST_CASE(FlipDetachesPixelData)
+{
+    PixelBufferPaletted buffer(2, 2, 1);
+    buffer.set(0, 1, 2);
+    ArchivItem_Bitmap_Raw bmp;
+    BOOST_TEST_REQUIRE(bmp.create(buffer, palette) == 0);
+    const auto bmpCopy = clone(bmp);
+    BOOST_TEST_REQUIRE(bmp.isPixelDataShared());
+
+    bmpCopy->flipVertical();
+    BOOST_TEST(!bmp.isPixelDataShared());
+    BOOST_TEST(!bmpCopy->isPixelDataShared());
+    BOOST_TEST(bmpCopy->getPixelClrIdx(0, 0) == 2u);
+    BOOST_TEST(bmpCopy->getPixelClrIdx(0, 1) == 1u);
+    // Original is unchanged
+    BOOST_TEST(bmp.getPixelClrIdx(0, 0) == 1u);
+    BOOST_TEST(bmp.getPixelClrIdx(0, 1) == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(DeduplicatePixelData)
+{
+    const bfs::path bmpPath = libsiedler2::test::inputPath / "bmpRaw.lst";
+    const bfs::path bmpOutPath = test::outputPath / "bmp.lst";
+    DeduplicationContext ctx;
+    BOOST_TEST(setDeduplicationContext(&ctx) == nullptr);
+    Archiv bmps1, bmps2;
+    BOOST_TEST_REQUIRE(testLoad(0, bmpPath, bmps1, palette));
+    BOOST_TEST_REQUIRE(testLoad(0, bmpPath, bmps2, palette));
+    BOOST_TEST(setDeduplicationContext(nullptr) == &ctx);
+    BOOST_TEST_REQUIRE(bmps1.size() == bmps2.size());
+
+    size_t numBitmaps = 0, numBytes = 0;
+    for(unsigned i = 0; i < bmps1.size(); i++)
+    {
+        const auto* bmp1 = dynamic_cast<const ArchivItem_BitmapBase*>(bmps1[i]);
+        const auto* bmp2 = dynamic_cast<const ArchivItem_BitmapBase*>(bmps2[i]);
+        if(!bmp1)
+            continue;
+        BOOST_TEST_REQUIRE(bmp2);
+        ++numBitmaps;
+        numBytes += bmp1->getPixelData().size();
+        // Same file --> Same buffer
+        BOOST_TEST(bmp1->getPixelData().data() == bmp2->getPixelData().data());
+    }
+    BOOST_TEST_REQUIRE(numBitmaps > 0u);
+    const DeduplicationContext::Statistics stats = ctx.getStatistics();
+    BOOST_TEST(stats.numBitmaps == numBitmaps * 2u);
+    BOOST_TEST(stats.numShared >= numBitmaps);
+    BOOST_TEST(stats.numUniqueBuffers + stats.numShared == stats.numBitmaps);
+    BOOST_TEST(stats.bytesSaved >= numBytes);
+
+    // Modifying one does not change the other
+    auto* bmp1 = dynamic_cast<ArchivItem_Bitmap_Raw*>(bmps1[0]);
+    const auto* bmp2 = dynamic_cast<const ArchivItem_Bitmap_Raw*>(bmps2[0]);
+    BOOST_TEST_REQUIRE(bmp1);
+    BOOST_TEST_REQUIRE(bmp1->isPixelDataShared());
+    const std::vector<uint8_t> origData = bmp2->getPixelData();
+    BOOST_TEST_REQUIRE(bmp1->getFormat() == TextureFormat::Paletted);
+    const uint8_t origClr = origData[0];
+    bmp1->setPixel(0, 0, static_cast<uint8_t>(origClr + 1u));
+    BOOST_TEST(!bmp1->isPixelDataShared());
+    BOOST_TEST(std::as_const(*bmp1).getPixelData()[0] == origClr + 1u);
+    BOOST_TEST(bmp2->getPixelData() == origData, boost::test_tools::per_element());
+
+    // Output is unchanged
+    BOOST_TEST_REQUIRE(Write(bmpOutPath, bmps2, palette) == 0);
+    BOOST_TEST_REQUIRE(testFilesEqual(bmpOutPath, bmpPath));
+
+    ctx.clear();
+    BOOST_TEST(ctx.getStatistics().numBitmaps == 0u);
+    BOOST_TEST(ctx.getStatistics().bytesSaved == 0u);
+}
+
 BOOST_AUTO_TEST_CASE(PaletteUsageForPrint)
 {
     ArchivItem_Bitmap_Raw bmp;
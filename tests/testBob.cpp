@@ -7,11 +7,83 @@
 #include "libsiedler2/Archiv.h"
 #include "libsiedler2/ArchivItem_Bitmap_Player.h"
 #include "libsiedler2/ArchivItem_Bob.h"
+#include "libsiedler2/BobCompositor.h"
+#include "libsiedler2/DeduplicationContext.h"
+#include "libsiedler2/ErrorCodes.h"
 #include "libsiedler2/libsiedler2.h"
+#include "libsiedler2/PixelBufferBGRA.h"
+#include "libsiedler2/PixelBufferPaletted.h"
 #include "libsiedler2/loadMapping.h"
 #include "s25util/StringConversion.h"
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <vector>
+
+namespace {
+/// Writes the little endian data of a BOB file (without the header)
+struct BobWriter
+{
+    std::vector<uint8_t> data;
+
+    void write8(uint8_t value) { data.push_back(value); }
+    void write16(uint16_t value)
+    {
+        write8(static_cast<uint8_t>(value & 0xFF));
+        write8(static_cast<uint8_t>(value >> 8));
+    }
+    void writeColorBlock(const std::vector<uint8_t>& colors)
+    {
+        write16(0x01F5);
+        write16(static_cast<uint16_t>(colors.size()));
+        data.insert(data.end(), colors.begin(), colors.end());
+    }
+    void writeImage(const std::vector<uint16_t>& starts, uint8_t ny)
+    {
+        write16(0x01F4);
+        write8(static_cast<uint8_t>(starts.size()));
+        for(uint16_t start : starts)
+            write16(start);
+        write8(ny);
+    }
+    std::string str() const { return std::string(data.begin(), data.end()); }
+};
+
+/// Each body line: 2 colored, 1 player color, 3 compressed and 26 transparent pixels
+const std::vector<uint8_t> testBodyColors{0x42, 10, 11, 0x81, 2, 0xC3, 12, 0x1A};
+/// Overlays: 1 colored pixel and 31 transparent
+const std::vector<uint8_t> testOverlayColors{0x41, 20, 0x1F};
+
+/// Create the data of a BOB file with 96 bodies of 2 lines and 3 overlays (last one unused) of 3 lines each
+std::string createTestBob(const std::vector<uint8_t>& bodyColors = testBodyColors,
+                          const std::vector<uint8_t>& overlayColors = testOverlayColors)
+{
+    BobWriter writer;
+    writer.writeColorBlock(bodyColors);
+    for(unsigned i = 0; i < 96; i++)
+        writer.writeImage({0, 0}, static_cast<uint8_t>(i % 20));
+    // Overlays of each direction with the color index increased by the direction (if it exists)
+    for(uint8_t dir = 0; dir < 6; dir++)
+    {
+        std::vector<uint8_t> colors = overlayColors;
+        if(colors.size() > 1u)
+            colors[1] += dir;
+        writer.writeColorBlock(colors);
+    }
+    // 3 overlays with the last one being unused
+    writer.write16(3);
+    for(unsigned i = 0; i < 3; i++)
+        writer.writeImage({0, 0, 0}, 7);
+    writer.write16(96);
+    for(uint16_t i = 0; i < 96; i++)
+    {
+        writer.write16(i % 2);
+        writer.write16(0);
+    }
+
+    return writer.str();
+}
+} // namespace
 
 BOOST_FIXTURE_TEST_SUITE(BobFiles, LoadPalette)
 
@@ -28,9 +100,11 @@ BOOST_AUTO_TEST_CASE(LoadBobFile)
     BOOST_TEST(bob.getNumOverlayImgs() == 602u);
     BOOST_TEST(bob.getNumLinks() == 3264u);
     BOOST_TEST(bob.size() == 698u);
+    // Images are decoded on access
+    BOOST_TEST(!bob[0]);
     for(unsigned i = 0; i < bob.size(); i++)
     {
-        const auto* bmp = dynamic_cast<const libsiedler2::ArchivItem_Bitmap_Player*>(bob[i]);
+        const auto* bmp = bob.getImage(i);
         BOOST_TEST_REQUIRE(bmp);
         BOOST_TEST(bmp->getNx() == 16);
         BOOST_TEST(bmp->getWidth() == 32u);
@@ -60,6 +134,218 @@ BOOST_AUTO_TEST_CASE(LoadBobFile)
     BOOST_TEST(bob.getOverlay(13, false, ImgDir::NW, 7) == bob[bob.getOverlayIdx(13 * 96 + 7 * 12 + 4 + 0 * 6)]);
 }
 
+BOOST_AUTO_TEST_CASE(LazyDecoding)
+{
+    std::istringstream file(createTestBob());
+    libsiedler2::ArchivItem_Bob bob;
+    BOOST_TEST_REQUIRE(bob.load(file, palette) == 0);
+    BOOST_TEST_REQUIRE(bob.size() == 99u);
+    BOOST_TEST(bob.getNumOverlayImgs() == 3u);
+    for(unsigned i = 0; i < bob.size(); i++)
+    {
+        BOOST_TEST(!bob[i]);
+        BOOST_TEST(bob.hasImage(i) == (i != 98u));
+    }
+
+    using libsiedler2::ImgDir;
+    const auto* body = bob.getBody(true, ImgDir::SE, 3);
+    BOOST_TEST_REQUIRE(body);
+    BOOST_TEST(body == bob[(6 + 1) * 8 + 3]);
+    BOOST_TEST(body == bob.getImage((6 + 1) * 8 + 3));
+    BOOST_TEST(body->getWidth() == 32u);
+    BOOST_TEST(body->getHeight() == 2u);
+    BOOST_TEST(body->getNx() == 16);
+    BOOST_TEST(body->getNy() == ((6 + 1) * 8 + 3) % 20);
+    BOOST_TEST(body->isPlayerColor(2, 1));
+    BOOST_TEST(body->getPlayerColorIdx(2, 1) == 2u);
+    BOOST_TEST(!body->isPlayerColor(3, 1));
+    // Only the accessed image is decoded
+    BOOST_TEST(!bob[0]);
+
+    // Overlays use the color block of the direction of their first link
+    const auto* overlay = bob.getOverlay(0, false, ImgDir::E, 0);
+    BOOST_TEST_REQUIRE(overlay);
+    BOOST_TEST(overlay == bob[96]);
+    BOOST_TEST(overlay->getHeight() == 3u);
+    BOOST_TEST(overlay->getNy() == 7);
+    overlay = bob.getOverlay(0, false, ImgDir::SE, 0);
+    BOOST_TEST(overlay);
+    BOOST_TEST(overlay == bob[97]);
+    BOOST_TEST(!bob.getImage(98));
+
+    // Direct printing matches printing the decoded image
+    const uint8_t transparentIdx = palette->getTransparentIdx();
+    for(unsigned idx : {0u, 1u, 96u, 97u})
+    {
+        std::istringstream file2(createTestBob());
+        libsiedler2::ArchivItem_Bob bobCopy;
+        BOOST_TEST_REQUIRE(bobCopy.load(file2, palette) == 0);
+        libsiedler2::PixelBufferPaletted bufferPal(40, 10, transparentIdx), expectedPal(40, 10, transparentIdx);
+        libsiedler2::PixelBufferBGRA bufferBGRA(40, 10), expectedBGRA(40, 10);
+        using libsiedler2::TextureFormat;
+        BOOST_TEST_REQUIRE(
+          bobCopy.printImage(idx, bufferPal.getPixelPtr(), 40, 10, TextureFormat::Paletted, nullptr, 64, 5, 3) == 0);
+        BOOST_TEST_REQUIRE(
+          bobCopy.printImage(idx, bufferBGRA.getPixelPtr(), 40, 10, TextureFormat::BGRA, nullptr, 64, 5, 3) == 0);
+        const auto* bmp = bobCopy.getImage(idx);
+        BOOST_TEST_REQUIRE(bmp);
+        BOOST_TEST_REQUIRE(bmp->print(expectedPal, palette, 64, 5, 3) == 0);
+        BOOST_TEST_REQUIRE(bmp->print(expectedBGRA, palette, 64, 5, 3) == 0);
+        BOOST_TEST(bufferPal.getPixels() == expectedPal.getPixels(), boost::test_tools::per_element());
+        BOOST_TEST(bufferBGRA.getPixels() == expectedBGRA.getPixels(), boost::test_tools::per_element());
+    }
+    BOOST_TEST(bob.printImage(98, nullptr, 40, 10, libsiedler2::TextureFormat::Paletted) != 0);
+
+    // Copies share the undecoded data
+    libsiedler2::ArchivItem_Bob bobCopy(bob);
+    BOOST_TEST(bobCopy[(6 + 1) * 8 + 3] != body);
+    BOOST_TEST(!bobCopy[5]);
+    BOOST_TEST(bobCopy.decodeAll() == 0);
+    for(unsigned i = 0; i < 98u; i++)
+        BOOST_TEST(bobCopy[i]);
+    BOOST_TEST(!bobCopy[98]);
+}
+
+BOOST_AUTO_TEST_CASE(RejectTruncatedImages)
+{
+    using libsiedler2::ErrorCode;
+    // Lines start inside the color block but their runs exceed it
+    const std::vector<std::vector<uint8_t>> invalidColors{{0x42, 10}, {0x42, 10, 11}, {0x42, 10, 11, 0x81}};
+    for(const auto& colors : invalidColors)
+    {
+        std::istringstream file(createTestBob(colors));
+        libsiedler2::ArchivItem_Bob bob;
+        BOOST_TEST(bob.load(file, palette) == ErrorCode::UNEXPECTED_EOF);
+        std::istringstream file2(createTestBob(testBodyColors, colors));
+        BOOST_TEST(bob.load(file2, palette) == ErrorCode::UNEXPECTED_EOF);
+    }
+    // Empty color blocks are transparent images
+    std::istringstream file(createTestBob({}, {}));
+    libsiedler2::ArchivItem_Bob bob;
+    BOOST_TEST_REQUIRE(bob.load(file, palette) == 0);
+    BOOST_TEST(bob.decodeAll() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(DeduplicateDecodedImages)
+{
+    std::istringstream file(createTestBob());
+    libsiedler2::ArchivItem_Bob bob;
+    BOOST_TEST_REQUIRE(bob.load(file, palette) == 0);
+    libsiedler2::DeduplicationContext ctx;
+    ctx.deduplicate(static_cast<libsiedler2::ArchivItem&>(bob));
+    BOOST_TEST(ctx.getStatistics().numBitmaps == 0u);
+
+    // All bodies have the same pixels
+    const auto* body1 = bob.getImage(0);
+    const auto* body2 = bob.getImage(1);
+    BOOST_TEST_REQUIRE((body1 && body2));
+    ctx.deduplicate(static_cast<libsiedler2::ArchivItem&>(bob));
+    BOOST_TEST(ctx.getStatistics().numBitmaps == 2u);
+    BOOST_TEST(ctx.getStatistics().numShared == 1u);
+    BOOST_TEST(body1->getPixelData().data() == body2->getPixelData().data());
+}
+
+BOOST_AUTO_TEST_CASE(ComposeBodyAndOverlay)
+{
+    using libsiedler2::BobCompositor;
+    using libsiedler2::ColorBGRA;
+    using libsiedler2::ImgDir;
+    std::istringstream file(createTestBob());
+    libsiedler2::ArchivItem_Bob bob;
+    BOOST_TEST_REQUIRE(bob.load(file, palette) == 0);
+    BobCompositor compositor(bob, *palette, 1024 * 1024);
+
+    // Body only is trimmed to the visible pixels
+    const BobCompositor::Sprite* sprite = compositor.get(BobCompositor::Key{false, ImgDir::E, 0});
+    BOOST_TEST_REQUIRE(sprite);
+    BOOST_TEST(sprite->getWidth() == 6u);
+    BOOST_TEST(sprite->getHeight() == 2u);
+    BOOST_TEST(sprite->nx == 16);
+    BOOST_TEST(sprite->ny == 0);
+    BOOST_TEST(sprite->pixels.get(0, 1) == ColorBGRA(palette->get(10)));
+    BOOST_TEST(sprite->pixels.get(5, 0) == ColorBGRA(palette->get(12)));
+    BOOST_TEST_REQUIRE(sprite->hasPlayerColors());
+    BOOST_TEST(sprite->playerColors.get(2, 0) == 2u);
+    BOOST_TEST(sprite->playerColors.get(3, 0) == libsiedler2::ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX);
+    // Cached
+    BOOST_TEST(compositor.get(BobCompositor::Key{false, ImgDir::E, 0}) == sprite);
+    BOOST_TEST(compositor.getNumSprites() == 1u);
+    BOOST_TEST(compositor.getMemoryUsage() == sprite->getMemorySize());
+
+    // Overlay (ny=7) is above the body (ny=0)
+    sprite = compositor.get(BobCompositor::Key{false, ImgDir::E, 0, 0});
+    BOOST_TEST_REQUIRE(sprite);
+    BOOST_TEST(sprite->getWidth() == 6u);
+    BOOST_TEST(sprite->getHeight() == 9u);
+    BOOST_TEST(sprite->nx == 16);
+    BOOST_TEST(sprite->ny == 7);
+    BOOST_TEST(sprite->pixels.get(0, 0) == ColorBGRA(palette->get(20)));
+    BOOST_TEST(sprite->pixels.get(1, 0).getAlpha() == 0u);
+    BOOST_TEST(sprite->pixels.get(0, 7) == ColorBGRA(palette->get(10)));
+    BOOST_TEST(sprite->playerColors.get(2, 8) == 2u);
+
+    // Baked player color
+    sprite = compositor.get(BobCompositor::Key{false, ImgDir::E, 0, 0, 64});
+    BOOST_TEST_REQUIRE(sprite);
+    BOOST_TEST(!sprite->hasPlayerColors());
+    BOOST_TEST(sprite->pixels.get(2, 8) == ColorBGRA(palette->get(66)));
+    BOOST_TEST(compositor.getNumSprites() == 3u);
+
+    // Invalid overlay and unused overlay image
+    BOOST_TEST(!compositor.get(BobCompositor::Key{false, ImgDir::E, 0, 1}));
+    BOOST_TEST(!compositor.get(BobCompositor::Key{false, ImgDir::E, 8}));
+
+    // Least recently used sprites are removed when exceeding the budget
+    const size_t spriteSize = sprite->getMemorySize();
+    compositor.setMemoryBudget(spriteSize);
+    BOOST_TEST(compositor.getNumSprites() == 1u);
+    BOOST_TEST(compositor.get(BobCompositor::Key{false, ImgDir::E, 0, 0, 64}) == sprite);
+    BOOST_TEST_REQUIRE(compositor.get(BobCompositor::Key{false, ImgDir::SE, 0, 0, 64}));
+    BOOST_TEST(compositor.getNumSprites() == 1u);
+    BOOST_TEST(compositor.getMemoryUsage() <= spriteSize);
+
+    // Parallel creation
+    compositor.clear();
+    compositor.setMemoryBudget(1024 * 1024);
+    std::vector<BobCompositor::Key> keys;
+    for(bool fat : {false, true})
+    {
+        for(unsigned dir = 0; dir < 6; dir++)
+        {
+            for(uint8_t step = 0; step < 8; step++)
+                keys.push_back(BobCompositor::Key{fat, ImgDir(dir), step, 0});
+        }
+    }
+    BOOST_TEST(compositor.warmUp(keys, 4) == 0);
+    BOOST_TEST(compositor.getNumSprites() == keys.size());
+    for(const BobCompositor::Key& key : keys)
+    {
+        BobCompositor::Sprite expected;
+        BOOST_TEST_REQUIRE(compositor.compose(key, expected) == 0);
+        sprite = compositor.get(key);
+        BOOST_TEST_REQUIRE(sprite);
+        BOOST_TEST(sprite->nx == expected.nx);
+        BOOST_TEST(sprite->ny == expected.ny);
+        BOOST_TEST(sprite->pixels.getPixels() == expected.pixels.getPixels());
+    }
+    keys.push_back(BobCompositor::Key{false, ImgDir::E, 0, 1});
+    BOOST_TEST(compositor.warmUp(keys, 4) != 0);
+
+    // With a limited budget the first keys are kept and the others (including the invalid last one) are skipped
+    BobCompositor::Sprite sprite0, sprite1;
+    BOOST_TEST_REQUIRE(compositor.compose(keys[0], sprite0) == 0);
+    BOOST_TEST_REQUIRE(compositor.compose(keys[1], sprite1) == 0);
+    const size_t budget = sprite0.getMemorySize() + sprite1.getMemorySize();
+    compositor.clear();
+    compositor.setMemoryBudget(budget);
+    BOOST_TEST(compositor.warmUp(keys, 1) == 0);
+    BOOST_TEST(compositor.getMemoryUsage() <= budget);
+    BOOST_TEST(compositor.getNumSprites() == 2u);
+    sprite = compositor.get(keys[0]);
+    BOOST_TEST(compositor.get(keys[1]));
+    BOOST_TEST(compositor.get(keys[0]) == sprite);
+}
+
 BOOST_AUTO_TEST_CASE(WriteReadLinks)
 {
     if(!libsiedler2::test::hasS2Data)
@@ -6,10 +6,17 @@
 #include "cmpFiles.h"
 #include "test/config.h"
 #include "libsiedler2/Archiv.h"
+#include "libsiedler2/ArchivItem_Bitmap_Player.h"
 #include "libsiedler2/ArchivItem_Font.h"
+#include "libsiedler2/ErrorCodes.h"
+#include "libsiedler2/FontAtlas.h"
+#include "libsiedler2/PixelBufferPaletted.h"
+#include "libsiedler2/oem.h"
 #include "libsiedler2/libsiedler2.h"
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(Fonts, LoadPalette)
 
@@ -29,4 +36,193 @@ BOOST_AUTO_TEST_CASE(LoadWriteFont)
     BOOST_TEST_REQUIRE(testFilesEqual(outPath, inPath));
 }
 
+BOOST_AUTO_TEST_CASE(GlyphNames)
+{
+    using libsiedler2::ArchivItem_Font;
+    BOOST_TEST(ArchivItem_Font::getGlyphName(0) == "U+0");
+    BOOST_TEST(ArchivItem_Font::getGlyphName(0x41) == "U+41");
+    BOOST_TEST(ArchivItem_Font::getGlyphName(0x9000) == "U+9000");
+    BOOST_TEST(ArchivItem_Font::getGlyphName(0x10FFFF) == "U+10ffff");
+}
+
+BOOST_AUTO_TEST_CASE(SparseGlyphs)
+{
+    using namespace libsiedler2;
+    ArchivItem_Font font;
+    font.isUnicode = true;
+    font.setDx(3);
+    font.setDy(5);
+    BOOST_TEST(font.size() == 0u);
+    BOOST_TEST(!font.get(0x9000));
+    ArchivItem_Bitmap_Player bmp;
+    PixelBufferPaletted buffer(4, 6, 10);
+    BOOST_TEST_REQUIRE(bmp.create(buffer, palette) == 0);
+    font.setC(0x9000, bmp);
+    font.setC('A', bmp);
+    // Only existing glyphs are stored
+    BOOST_TEST(font.size() == 0x9001u);
+    BOOST_TEST(font.getNumGlyphs() == 2u);
+    BOOST_TEST_REQUIRE(font.getGlyphs().size() == 2u);
+    BOOST_TEST(font.getGlyphs()[0].codepoint == 'A');
+    BOOST_TEST(font.getGlyphs()[1].codepoint == 0x9000u);
+    BOOST_TEST(!font.get(0x8FFF));
+    BOOST_TEST(!font.get(0x9001));
+    BOOST_TEST_REQUIRE(font.get(0x9000));
+
+    // Copies are deep
+    const ArchivItem_Font fontCopy(font);
+    BOOST_TEST(fontCopy.getNumGlyphs() == 2u);
+    BOOST_TEST_REQUIRE(fontCopy.get(0x9000));
+    BOOST_TEST(fontCopy.get(0x9000) != font.get(0x9000));
+
+    // Removing a glyph keeps the size
+    BOOST_TEST(font.release('A'));
+    BOOST_TEST(!font.release('A'));
+    BOOST_TEST(font.getNumGlyphs() == 1u);
+    BOOST_TEST(font.size() == 0x9001u);
+
+    // Round trip via LST keeps the sparse layout
+    const boost::filesystem::path outPath = test::outputPath / "sparseFont.lst";
+    Archiv archiv;
+    archiv.pushC(fontCopy);
+    BOOST_TEST_REQUIRE(Write(outPath, archiv, palette) == 0);
+    BOOST_TEST_REQUIRE(Load(outPath, archiv, palette) == 0);
+    const auto* loadedFont = dynamic_cast<const ArchivItem_Font*>(archiv[0]);
+    BOOST_TEST_REQUIRE(loadedFont);
+    BOOST_TEST(loadedFont->isUnicode);
+    BOOST_TEST(loadedFont->getDx() == 3u);
+    BOOST_TEST(loadedFont->getDy() == 5u);
+    BOOST_TEST(loadedFont->size() == 0x9001u);
+    BOOST_TEST(loadedFont->getNumGlyphs() == 2u);
+    const auto* loadedBmp = dynamic_cast<const ArchivItem_Bitmap_Player*>(loadedFont->get(0x9000));
+    BOOST_TEST_REQUIRE(loadedBmp);
+    BOOST_TEST(loadedBmp->getWidth() == 4u);
+    BOOST_TEST(loadedBmp->getHeight() == 6u);
+
+    font.clear();
+    BOOST_TEST(font.size() == 0u);
+    BOOST_TEST(font.getNumGlyphs() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(CreateFontAtlas)
+{
+    const boost::filesystem::path inPath = libsiedler2::test::inputPath / "testFonts.LST";
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(inPath, archiv, palette) == 0);
+    for(unsigned fontIdx : {1, 2})
+    {
+        const auto* font = dynamic_cast<const libsiedler2::ArchivItem_Font*>(archiv[fontIdx]);
+        BOOST_TEST_REQUIRE(font);
+        libsiedler2::FontAtlas atlas;
+        BOOST_TEST_REQUIRE(atlas.create(*font, libsiedler2::TextureFormat::BGRA, palette, 128) == 0);
+        BOOST_TEST(atlas.getLineHeight() == font->getDy());
+        BOOST_TEST(atlas.getWidth() <= 128u);
+
+        const auto* glyph1 = dynamic_cast<const libsiedler2::ArchivItem_Bitmap_Player*>(font->get('*'));
+        const auto* glyph2 = dynamic_cast<const libsiedler2::ArchivItem_Bitmap_Player*>(font->get('/'));
+        BOOST_TEST_REQUIRE((glyph1 && glyph2));
+        const auto* atlasGlyph1 = atlas.getGlyph('*');
+        BOOST_TEST_REQUIRE(atlasGlyph1);
+        BOOST_TEST(atlasGlyph1->width == glyph1->getWidth());
+        BOOST_TEST(atlasGlyph1->height == glyph1->getHeight());
+        BOOST_TEST(!atlas.getGlyph(0x10FFFF));
+
+        // Pixels in the atlas are those of the glyph
+        std::vector<uint8_t> glyphPixels(glyph1->getWidth() * glyph1->getHeight() * 4u);
+        BOOST_TEST_REQUIRE(glyph1->print(glyphPixels.data(), glyph1->getWidth(), glyph1->getHeight(),
+                                         libsiedler2::TextureFormat::BGRA, palette)
+                           == 0);
+        for(unsigned y = 0; y < glyph1->getHeight(); y++)
+        {
+            const auto* atlasRow =
+              &atlas.getPixelData()[((atlasGlyph1->texY + y) * atlas.getWidth() + atlasGlyph1->texX) * 4u];
+            const auto* glyphRow = &glyphPixels[y * glyph1->getWidth() * 4u];
+            BOOST_TEST(std::equal(atlasRow, atlasRow + glyph1->getWidth() * 4u, glyphRow));
+        }
+
+        // Width is the sum of the glyph widths plus dx each
+        const unsigned width12 = glyph1->getWidth() + glyph2->getWidth() + 2u * font->getDx();
+        auto extent = atlas.measure("*/");
+        BOOST_TEST(extent.width == width12);
+        BOOST_TEST(extent.height == font->getDy());
+        extent = atlas.measure("*/*\n/*\n");
+        BOOST_TEST(extent.width == width12 + glyph1->getWidth() + font->getDx());
+        BOOST_TEST(extent.numLines == 3u);
+        BOOST_TEST(extent.height == 3u * font->getDy());
+
+        std::vector<libsiedler2::FontAtlas::GlyphQuad> quads;
+        extent = atlas.layout("*/\n*", quads);
+        BOOST_TEST(extent.width == width12);
+        BOOST_TEST_REQUIRE(quads.size() == 3u);
+        BOOST_TEST(quads[0].x == 0);
+        BOOST_TEST(quads[0].texX == atlasGlyph1->texX);
+        BOOST_TEST(quads[1].x == glyph1->getWidth() + font->getDx());
+        BOOST_TEST(quads[1].width == glyph2->getWidth());
+        BOOST_TEST(quads[2].x == 0);
+        BOOST_TEST(quads[2].y == font->getDy());
+
+        // Non-ASCII chars are found via their unicode codepoint.
+        // Unknown ones are drawn as '?' or skipped if it does not exist
+        BOOST_TEST(!atlas.getGlyph('?'));
+        BOOST_TEST(atlas.measure("*\xE2\x88\x9E?").width == atlasGlyph1->advance);
+        if(font->isUnicode)
+        {
+            const auto* atlasGlyph = atlas.getGlyph(1043);
+            BOOST_TEST_REQUIRE(atlasGlyph);
+            BOOST_TEST(atlasGlyph->width
+                       == dynamic_cast<const libsiedler2::ArchivItem_Bitmap_Player&>(*font->get(1043)).getWidth());
+            BOOST_TEST(atlas.measure("\xD0\x93*").width == atlasGlyph->advance + atlasGlyph1->advance);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FontAtlasPlayerColors)
+{
+    libsiedler2::ArchivItem_Font font;
+    font.alloc(256);
+    libsiedler2::PixelBufferPaletted buffer(3, 2, 42);
+    buffer.set(1, 1, 129);
+    libsiedler2::ArchivItem_Bitmap_Player glyph;
+    BOOST_TEST_REQUIRE(glyph.create(buffer, palette) == 0);
+    font.setC('x', glyph);
+
+    libsiedler2::FontAtlas atlas;
+    BOOST_TEST_REQUIRE(atlas.create(font, libsiedler2::TextureFormat::Paletted, palette) == 0);
+    BOOST_TEST(atlas.getNumGlyphs() == 1u);
+    const auto* atlasGlyph = atlas.getGlyph('x');
+    BOOST_TEST_REQUIRE(atlasGlyph);
+    BOOST_TEST_REQUIRE(atlas.hasPlayerColors());
+    const auto& playerClrs = atlas.getPlayerColors();
+    const auto getPixel = [&atlas](unsigned x, unsigned y) { return atlas.getPixelData()[y * atlas.getWidth() + x]; };
+    BOOST_TEST(playerClrs.get(atlasGlyph->texX + 1, atlasGlyph->texY + 1) == 1u);
+    BOOST_TEST(playerClrs.get(atlasGlyph->texX, atlasGlyph->texY)
+               == libsiedler2::ArchivItem_Bitmap_Player::TRANSPARENT_PLAYER_CLR_IDX);
+    // Default player color and regular pixels
+    BOOST_TEST(getPixel(atlasGlyph->texX + 1, atlasGlyph->texY + 1) == 129u);
+    BOOST_TEST(getPixel(atlasGlyph->texX, atlasGlyph->texY) == 42u);
+    // Border is transparent
+    const uint8_t transparentIdx = libsiedler2::ArchivItem_Palette::DEFAULT_TRANSPARENT_IDX;
+    BOOST_TEST(getPixel(atlasGlyph->texX - 1, atlasGlyph->texY) == transparentIdx);
+}
+
+BOOST_AUTO_TEST_CASE(FontAtlasTooHigh)
+{
+    libsiedler2::ArchivItem_Font font;
+    font.alloc(256);
+    libsiedler2::ArchivItem_Bitmap_Player glyph;
+    BOOST_TEST_REQUIRE(glyph.create(libsiedler2::PixelBufferPaletted(1, 800, 42), palette) == 0);
+    // Each glyph gets its own shelf, so 94 * 801 rows are required
+    for(char c = '!'; c <= '~'; c++)
+        font.setC(c, glyph);
+
+    libsiedler2::FontAtlas atlas;
+    BOOST_TEST(atlas.create(font, libsiedler2::TextureFormat::Paletted, palette, 3)
+               == libsiedler2::ErrorCode::WRONG_FORMAT);
+    BOOST_TEST(atlas.getNumGlyphs() == 0u);
+    BOOST_TEST(atlas.getHeight() == 0u);
+    // Fits if glyphs can be placed next to each other: 31 glyphs per shelf
+    BOOST_TEST(atlas.create(font, libsiedler2::TextureFormat::Paletted, palette, 64) == 0);
+    BOOST_TEST(atlas.getHeight() == 4u * 801u + 1u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
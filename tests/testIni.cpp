@@ -11,6 +11,7 @@
 #include <boost/nowide/fstream.hpp>
 #include <boost/test/unit_test.hpp>
 #include <stdexcept>
+#include <string>
 
 BOOST_AUTO_TEST_SUITE(IniFiles)
 
@@ -55,6 +56,65 @@ BOOST_AUTO_TEST_CASE(GetSetValues)
     BOOST_TEST(ini.getIntValue("int") == 42);
     ini.setValue("int", "1337");
     BOOST_TEST(ini.getIntValue("int") == 1337);
+    ini.setValue("int", " -7 ");
+    BOOST_TEST(ini.getIntValue("int") == -7);
+    ini.setValue("int", "7a");
+    BOOST_CHECK_THROW(ini.getIntValue("int"), std::invalid_argument);
+
+    // Keys stay in insertion order, also after growing the table and replacing values many times
+    BOOST_TEST_REQUIRE(ini.size() == 3u);
+    BOOST_TEST(ini.getKey(0) == "string");
+    BOOST_TEST(ini.getValueAt(0) == "value2");
+    for(int i = 0; i < 100; i++)
+        ini.setValue("key" + std::to_string(i), i);
+    for(int j = 0; j < 20; j++)
+    {
+        for(int i = 0; i < 100; i += 3)
+            ini.setValue("key" + std::to_string(i), std::string(j + 1, 'x'));
+    }
+    BOOST_TEST_REQUIRE(ini.size() == 103u);
+    for(int i = 0; i < 100; i++)
+    {
+        BOOST_TEST(ini.getKey(i + 3) == "key" + std::to_string(i));
+        if(i % 3 == 0)
+            BOOST_TEST(ini.getValue("key" + std::to_string(i)) == std::string(20, 'x'));
+        else
+            BOOST_TEST(ini.getIntValue("key" + std::to_string(i)) == i);
+    }
+    BOOST_TEST(ini.hasValue("key99"));
+    BOOST_TEST(!ini.hasValue("key100"));
+
+    const auto copy = clone(ini);
+    BOOST_TEST(copy->size() == ini.size());
+    BOOST_TEST(copy->getValue("key42") == ini.getValue("key42"));
+    ini.clear();
+    BOOST_TEST(ini.empty());
+    BOOST_TEST(!ini.hasValue("key42"));
+}
+
+BOOST_AUTO_TEST_CASE(SetValuesFromOwnStrings)
+{
+    libsiedler2::ArchivItem_Ini ini;
+    const std::string value(100, 'v');
+    ini.setValue("first", value);
+    // Key and value refer to the internal storage which grows when adding new entries
+    for(int i = 0; i < 50; i++)
+    {
+        ini.setValue("key" + std::to_string(i), ini.getValueAt(0));
+        ini.setValue(ini.getValueAt(ini.size() - 1u).substr(i), ini.getKey(ini.size() - 1u));
+    }
+    BOOST_TEST_REQUIRE(ini.size() == 101u);
+    for(int i = 0; i < 50; i++)
+    {
+        const std::string key = "key" + std::to_string(i);
+        BOOST_TEST(ini.getValue(key) == value);
+        BOOST_TEST(ini.getValue(value.substr(i)) == key);
+    }
+    // Replacing a value by (part of) itself
+    ini.setValue("first", ini.getValueAt(0).substr(50));
+    BOOST_TEST(ini.getValue("first") == value.substr(50));
+    ini.setValue("key0", ini.getKey(0));
+    BOOST_TEST(ini.getValue("key0") == "first");
 }
 
 BOOST_AUTO_TEST_CASE(DefaultValues)
@@ -7,10 +7,24 @@
 #include "libsiedler2/Archiv.h"
 #include "libsiedler2/ArchivItem_Map.h"
 #include "libsiedler2/ArchivItem_Map_Header.h"
+#include "libsiedler2/BlockCompression.h"
+#include "libsiedler2/ErrorCodes.h"
+#include "libsiedler2/MapFolderIndex.h"
+#include "libsiedler2/MapStatistics.h"
+#include "libsiedler2/MapView.h"
+#include "libsiedler2/Minimap.h"
+#include "libsiedler2/PixelBufferBGRA.h"
 #include "libsiedler2/libsiedler2.h"
 #include "s25util/tmpFile.h"
 #include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
 #include <boost/test/unit_test.hpp>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 namespace bfs = boost::filesystem;
 
@@ -97,4 +111,474 @@ BOOST_AUTO_TEST_CASE(CreateAndModifyMap)
     BOOST_TEST(testFilesEqual(tmpMap.filePath, tmpMap2.filePath));
 }
 
+BOOST_AUTO_TEST_CASE(CopiedMapSharesLayers)
+{
+    libsiedler2::ArchivItem_Map map;
+    auto header = std::make_unique<libsiedler2::ArchivItem_Map_Header>();
+    header->setWidth(16);
+    header->setHeight(8);
+    map.init(std::move(header));
+    using libsiedler2::MapLayer;
+    map.setMapDataAt(MapLayer::Terrain1, 5, 3);
+
+    auto mapCopy = clone(map);
+    // Layers are only copied on modification
+    BOOST_TEST(std::as_const(*mapCopy).getLayer(MapLayer::Terrain1).data()
+               == std::as_const(map).getLayer(MapLayer::Terrain1).data());
+    mapCopy->setMapDataAt(MapLayer::Terrain1, 5, 4);
+    BOOST_TEST(std::as_const(*mapCopy).getLayer(MapLayer::Terrain1).data()
+               != std::as_const(map).getLayer(MapLayer::Terrain1).data());
+    BOOST_TEST(map.getMapDataAt(libsiedler2::MapLayer::Terrain1, 5) == 3);
+    BOOST_TEST(mapCopy->getMapDataAt(MapLayer::Terrain1, 5) == 4);
+}
+
+BOOST_AUTO_TEST_CASE(LayerViews)
+{
+    const bfs::path mapPath = libsiedler2::test::inputPath / "map.wld";
+    libsiedler2::Archiv act;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(mapPath, act) == 0);
+    auto* map = dynamic_cast<libsiedler2::ArchivItem_Map*>(act[0]);
+    BOOST_TEST_REQUIRE(map);
+    using libsiedler2::MapLayer;
+    const unsigned numNodes = map->getHeader().getWidth() * map->getHeader().getHeight();
+    BOOST_TEST_REQUIRE(map->getNumNodes() == numNodes);
+    BOOST_TEST(!map->hasLayer(MapLayer::Reservations));
+    BOOST_CHECK_THROW(map->getLayer(MapLayer::Owner), std::range_error);
+
+    // Layers are consecutive
+    const auto altitudes = std::as_const(*map).getLayer(MapLayer::Altitude);
+    const auto terrain1 = std::as_const(*map).getLayer(MapLayer::Terrain1);
+    BOOST_TEST(altitudes.size() == numNodes);
+    BOOST_TEST(terrain1.data() == altitudes.data() + numNodes);
+
+    const unsigned idx = numNodes / 2;
+    libsiedler2::ArchivItem_Map::NodeData node = map->getNode(idx);
+    for(unsigned i = 0; i < libsiedler2::ArchivItem_Map::NUM_SWD_LAYERS; i++)
+    {
+        const auto type = static_cast<MapLayer>(i);
+        if(map->hasLayer(type))
+            BOOST_TEST(node[type] == map->getMapDataAt(type, idx));
+    }
+    node[MapLayer::Altitude] = 42;
+    node[MapLayer::Resources] = 13;
+    map->setNode(idx, node);
+    BOOST_TEST(map->getMapDataAt(MapLayer::Altitude, idx) == 42);
+    BOOST_TEST(map->getMapDataAt(MapLayer::Resources, idx) == 13);
+    BOOST_TEST(map->getMapDataAt(MapLayer::Altitude, idx + 1) == altitudes[idx + 1]);
+
+    // Modifications via the span are visible
+    map->getLayer(MapLayer::Shadows)[3] = 7;
+    BOOST_TEST(map->getMapDataAt(MapLayer::Shadows, 3) == 7);
+
+    // Node references point into the layers
+    const libsiedler2::ArchivItem_Map::NodeRef nodeRef = map->getNodeRef(idx);
+    BOOST_TEST(!nodeRef.hasLayer(MapLayer::Reservations));
+    BOOST_TEST(&nodeRef[MapLayer::Shadows] == &map->getLayer(MapLayer::Shadows)[idx]);
+    nodeRef[MapLayer::Resources] = 21;
+    const libsiedler2::ArchivItem_Map::ConstNodeRef constNodeRef = std::as_const(*map).getNodeRef(idx);
+    BOOST_TEST(constNodeRef[MapLayer::Resources] == 21);
+    BOOST_TEST(constNodeRef[MapLayer::Altitude] == 42);
+}
+
+BOOST_AUTO_TEST_CASE(ReadTruncatedMap)
+{
+    boost::nowide::ifstream file(libsiedler2::test::inputPath / "map.wld", std::ios::binary);
+    const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    BOOST_TEST_REQUIRE(data.size() > 2000u);
+    // Cut off inside the layers and inside the extra infos
+    for(const size_t size : {data.size() / 2, data.size() - 1})
+    {
+        std::stringstream stream(data.substr(0, size));
+        libsiedler2::ArchivItem_Map map;
+        BOOST_TEST(map.load(stream, false) == libsiedler2::ErrorCode::UNEXPECTED_EOF);
+    }
+    std::stringstream stream(data);
+    libsiedler2::ArchivItem_Map map;
+    BOOST_TEST(map.load(stream, false) == 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(MapFolderIndexOnlyReadsChangedMaps)
+{
+    const bfs::path folder = libsiedler2::test::outputPath / "mapFolder";
+    const bfs::path indexPath = libsiedler2::test::outputPath / "mapFolder.idx";
+    bfs::create_directories(folder);
+    bfs::copy_file(libsiedler2::test::inputPath / "map.wld", folder / "map.wld");
+    bfs::copy_file(libsiedler2::test::inputPath / "map.SWD", folder / "map2.SWD");
+    boost::nowide::ofstream(folder / "readme.txt") << "No map";
+
+    libsiedler2::MapFolderIndex index;
+    BOOST_TEST_REQUIRE(index.scan(folder, 2) == 0);
+    BOOST_TEST(index.getNumHeadersRead() == 2u);
+    BOOST_TEST_REQUIRE(index.getMaps().size() == 2u);
+
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(folder / "map.wld", archiv) == 0);
+    const auto& header = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*archiv[0]).getHeader();
+    const libsiedler2::MapInfo& info = index.getMaps()[0];
+    BOOST_TEST(info.filePath == folder / "map.wld");
+    BOOST_TEST(info.errorCode == 0);
+    BOOST_TEST(info.name == header.getName());
+    BOOST_TEST(info.author == header.getAuthor());
+    BOOST_TEST(info.width == header.getWidth());
+    BOOST_TEST(info.height == header.getHeight());
+    BOOST_TEST(info.gfxSet == header.getGfxSet());
+    BOOST_TEST(info.numPlayers == header.getNumPlayers());
+    for(unsigned i = 0; i < libsiedler2::ArchivItem_Map_Header::maxPlayers; i++)
+    {
+        uint16_t x, y;
+        header.getPlayerHQ(i, x, y);
+        BOOST_TEST(info.hqX[i] == x);
+        BOOST_TEST(info.hqY[i] == y);
+    }
+    BOOST_TEST_REQUIRE(index.write(indexPath) == 0);
+
+    // Unchanged folder: Nothing to read
+    libsiedler2::MapFolderIndex index2;
+    BOOST_TEST_REQUIRE(index2.load(indexPath) == 0);
+    BOOST_TEST_REQUIRE(index2.getMaps().size() == 2u);
+    BOOST_TEST(index2.getMaps()[0].name == info.name);
+    BOOST_TEST(index2.getMaps()[0].hqX == info.hqX);
+    BOOST_TEST_REQUIRE(index2.scan(folder) == 0);
+    BOOST_TEST(index2.getNumHeadersRead() == 0u);
+    BOOST_TEST(index2.getMaps().size() == 2u);
+
+    // Only changed and new maps are read, removed ones are dropped
+    bfs::last_write_time(folder / "map2.SWD", bfs::last_write_time(folder / "map2.SWD") + 10);
+    bfs::copy_file(libsiedler2::test::inputPath / "map.wld", folder / "map3.wld");
+    bfs::remove(folder / "map.wld");
+    BOOST_TEST_REQUIRE(index2.scan(folder) == 0);
+    BOOST_TEST(index2.getNumHeadersRead() == 2u);
+    BOOST_TEST_REQUIRE(index2.getMaps().size() == 2u);
+    BOOST_TEST(index2.getMaps()[0].filePath == folder / "map2.SWD");
+    BOOST_TEST(index2.getMaps()[1].filePath == folder / "map3.wld");
+    BOOST_TEST(index2.getMaps()[1].name == info.name);
+
+    // Invalid number of maps: Fails without allocating entries for all of them
+    std::string indexData;
+    {
+        boost::nowide::ifstream indexFile(indexPath, std::ios::binary);
+        indexData.assign(std::istreambuf_iterator<char>(indexFile), std::istreambuf_iterator<char>());
+    }
+    // Count follows the ID (8 bytes) and version (2 bytes)
+    BOOST_TEST_REQUIRE(indexData.size() > 14u);
+    indexData.replace(10, 4, 4, '\xFF');
+    const bfs::path invalidIndexPath = libsiedler2::test::outputPath / "invalidMapFolder.idx";
+    boost::nowide::ofstream(invalidIndexPath, std::ios::binary) << indexData;
+    libsiedler2::MapFolderIndex index3;
+    BOOST_TEST(index3.load(invalidIndexPath) == libsiedler2::ErrorCode::UNEXPECTED_EOF);
+    BOOST_TEST(index3.getMaps().empty());
+}
+
+
+BOOST_AUTO_TEST_CASE(RenderMinimap)
+{
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "map.wld", archiv) == 0);
+    const auto& map = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*archiv[0]);
+    const uint16_t width = map.getHeader().getWidth();
+    const uint16_t height = map.getHeader().getHeight();
+
+    libsiedler2::MinimapOptions options;
+    for(unsigned i = 0; i < options.terrainColors.size(); i++)
+        options.terrainColors[i] = libsiedler2::ColorBGRA(i * 4, 0xFF - i * 4, i * 2, 0xFF);
+    options.shadeAltitude = false;
+    options.drawObjects = false;
+    options.numThreads = 1;
+    libsiedler2::PixelBufferBGRA buffer(width, height);
+    BOOST_TEST_REQUIRE(libsiedler2::renderMinimap(map, buffer, options) == 0);
+    // Same size: Even rows map 1:1 to nodes
+    for(uint16_t y = 0; y < height; y += 2)
+    {
+        for(uint16_t x = 0; x < width; x++)
+        {
+            const uint8_t t1 = map.getMapDataAt(libsiedler2::MapLayer::Terrain1, x, y) % 0x40;
+            const uint8_t t2 = map.getMapDataAt(libsiedler2::MapLayer::Terrain2, x, y) % 0x40;
+            const libsiedler2::ColorBGRA expected((t1 * 4 + t2 * 4 + 1) / 2, (0xFF * 2 - t1 * 4 - t2 * 4 + 1) / 2,
+                                                  (t1 * 2 + t2 * 2 + 1) / 2, 0xFF);
+            BOOST_TEST_REQUIRE(buffer.get(x, y).asValue() == expected.asValue());
+        }
+    }
+
+    // Result does not depend on the number of threads
+    options.shadeAltitude = true;
+    options.drawObjects = true;
+    libsiedler2::PixelBufferBGRA bigBuffer(width * 3, height * 2);
+    BOOST_TEST_REQUIRE(libsiedler2::renderMinimap(map, bigBuffer, options) == 0);
+    options.numThreads = 4;
+    libsiedler2::PixelBufferBGRA bigBuffer2(width * 3, height * 2);
+    BOOST_TEST_REQUIRE(libsiedler2::renderMinimap(map, bigBuffer2, options) == 0);
+    BOOST_TEST((bigBuffer.getPixels() == bigBuffer2.getPixels()));
+    libsiedler2::PixelBufferBGRA smallBuffer(32, 20);
+    BOOST_TEST(libsiedler2::renderMinimap(map, smallBuffer, options) == 0);
+
+    // Owners fully covering the terrain
+    const std::vector<uint8_t> owners(map.getNumNodes(), 2);
+    options.owners = owners;
+    options.playerColors = {libsiedler2::ColorBGRA(), libsiedler2::ColorBGRA(0xFF, 0, 0, 0xFF)};
+    options.ownerAlpha = 256;
+    options.shadeAltitude = false;
+    options.drawObjects = false;
+    BOOST_TEST_REQUIRE(libsiedler2::renderMinimap(map, smallBuffer, options) == 0);
+    for(const libsiedler2::ColorBGRA& clr : smallBuffer)
+        BOOST_TEST_REQUIRE(clr.asValue() == options.playerColors[1].asValue());
+
+    libsiedler2::PixelBufferBGRA emptyBuffer;
+    BOOST_TEST(libsiedler2::renderMinimap(map, emptyBuffer, options) == libsiedler2::ErrorCode::INVALID_BUFFER);
+    BOOST_TEST(libsiedler2::renderMinimap(libsiedler2::ArchivItem_Map(), smallBuffer, options)
+               == libsiedler2::ErrorCode::WRONG_FORMAT);
+}
+
+
+BOOST_AUTO_TEST_CASE(MapStatistics)
+{
+    using libsiedler2::MapLayer;
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "map.wld", archiv) == 0);
+    const auto& map = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*archiv[0]);
+    const unsigned width = map.getHeader().getWidth();
+    const unsigned height = map.getHeader().getHeight();
+
+    const libsiedler2::MapStatistics stats(map);
+    const auto objTypes = map.getLayer(MapLayer::ObjectType);
+    const auto resources = map.getLayer(MapLayer::Resources);
+    libsiedler2::LayerHistogram expectedHistogram{};
+    unsigned numTrees = 0, numStones = 0, numCoalNodes = 0, coalAmount = 0;
+    for(unsigned i = 0; i < map.getNumNodes(); i++)
+    {
+        expectedHistogram[map.getMapDataAt(MapLayer::Altitude, i)]++;
+        if(objTypes[i] >= 0xC4 && objTypes[i] <= 0xC7)
+            numTrees++;
+        if(objTypes[i] == 0xCC || objTypes[i] == 0xCD)
+            numStones++;
+        if(resources[i] > 0x40 && resources[i] <= 0x47)
+        {
+            numCoalNodes++;
+            coalAmount += resources[i] - 0x40;
+        }
+    }
+    BOOST_TEST_REQUIRE(numTrees > 0u);
+    BOOST_TEST_REQUIRE(coalAmount > 0u);
+    BOOST_TEST(stats.getHistogram(MapLayer::Altitude) == expectedHistogram);
+    BOOST_TEST(libsiedler2::computeHistogram(map.getLayer(MapLayer::Altitude)) == expectedHistogram);
+    BOOST_TEST(stats.getNumTrees() == numTrees);
+    BOOST_TEST(stats.getNumStones() == numStones);
+    BOOST_TEST(stats.getNumResourceNodes(libsiedler2::R_Coal) == numCoalNodes);
+    BOOST_TEST(stats.getResourceAmount(libsiedler2::R_Coal) == coalAmount);
+    BOOST_TEST(libsiedler2::countMasked(objTypes, 0xFC, 0xC4) == numTrees);
+    BOOST_TEST(!stats.hasHistogram(MapLayer::Owner));
+    BOOST_CHECK_THROW(stats.getHistogram(MapLayer::Owner), std::range_error);
+
+    const libsiedler2::SummedAreaTable trees(map, MapLayer::ObjectType, libsiedler2::getRangeWeights(0xC4, 0xC7));
+    BOOST_TEST(trees.getTotal() == numTrees);
+    BOOST_TEST(trees.getSum(0, 0, width, height) == numTrees);
+    const auto isTree = [&](int x, int y) {
+        const unsigned wrappedX = (x + width) % width;
+        const unsigned wrappedY = (y + height) % height;
+        const uint8_t objType = objTypes[wrappedY * width + wrappedX];
+        return objType >= 0xC4 && objType <= 0xC7;
+    };
+    // Rectangles, also crossing the borders
+    for(const auto& rect : {std::array<int, 4>{0, 0, 1, 1}, std::array<int, 4>{3, 5, 10, 7},
+                            std::array<int, 4>{-4, 2, 9, 9}, std::array<int, 4>{static_cast<int>(width) - 2, -3, 5, 6}})
+    {
+        unsigned expected = 0;
+        for(int y = rect[1]; y < rect[1] + rect[3]; y++)
+        {
+            for(int x = rect[0]; x < rect[0] + rect[2]; x++)
+                expected += isTree(x, y);
+        }
+        BOOST_TEST(trees.getSum(rect[0], rect[1], rect[2], rect[3]) == expected);
+    }
+    // Hexagons: Compare with nodes reachable in radius steps
+    for(const auto& center : {std::array<unsigned, 3>{10, 10, 3}, std::array<unsigned, 3>{0, 1, 4},
+                              std::array<unsigned, 3>{width - 1, height - 1, 2}, std::array<unsigned, 3>{5, 6, 0}})
+    {
+        std::set<std::pair<unsigned, unsigned>> nodes{{center[0], center[1]}};
+        for(unsigned i = 0; i < center[2]; i++)
+        {
+            for(const auto& node : std::set<std::pair<unsigned, unsigned>>(nodes))
+            {
+                const unsigned x = node.first, y = node.second;
+                const unsigned xLeft = (x + width - 1) % width, xRight = (x + 1) % width;
+                const unsigned yUp = (y + height - 1) % height, yDown = (y + 1) % height;
+                // Odd rows are shifted to the right
+                const unsigned xUpLeft = (y & 1) ? x : xLeft, xUpRight = (y & 1) ? xRight : x;
+                nodes.insert({{xLeft, y}, {xRight, y}, {xUpLeft, yUp}, {xUpRight, yUp}, {xUpLeft, yDown},
+                              {xUpRight, yDown}});
+            }
+        }
+        unsigned expected = 0;
+        for(const auto& node : nodes)
+            expected += isTree(node.first, node.second);
+        BOOST_TEST(trees.getHexSum(center[0], center[1], center[2]) == expected);
+        // Count nodes instead of trees
+        const libsiedler2::SummedAreaTable allNodes(map, MapLayer::ObjectType, libsiedler2::getRangeWeights(0, 0xFF));
+        BOOST_TEST(allNodes.getHexSum(center[0], center[1], center[2]) == nodes.size());
+    }
+
+    // Regions around the HQs
+    const libsiedler2::SummedAreaTable coal(map, MapLayer::Resources,
+                                            libsiedler2::getResourceWeights(libsiedler2::R_Coal));
+    const std::vector<libsiedler2::PlayerRegionSummary> summaries = libsiedler2::computePlayerRegionSummaries(map, 5);
+    BOOST_TEST_REQUIRE(!summaries.empty());
+    BOOST_TEST(summaries.size() <= map.getHeader().getNumPlayers());
+    for(const libsiedler2::PlayerRegionSummary& summary : summaries)
+    {
+        uint16_t hqX, hqY;
+        map.getHeader().getPlayerHQ(summary.player, hqX, hqY);
+        BOOST_TEST(summary.hqX == hqX);
+        BOOST_TEST(summary.hqY == hqY);
+        BOOST_TEST(summary.numTrees == trees.getHexSum(hqX, hqY, 5));
+        BOOST_TEST(summary.getResourceAmount(libsiedler2::R_Coal) == coal.getHexSum(hqX, hqY, 5));
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(MapViewMatchesLoadedMap)
+{
+    using libsiedler2::MapLayer;
+    const std::vector<std::pair<std::string, std::string>> files = {
+      {"map.SWD", "map.SWD"}, {"map.wld", "map.wld"}, {"faultyMap.wld", "map.wld"}};
+    for(const auto& file : files)
+    {
+        const bfs::path mapPath = libsiedler2::test::inputPath / file.first;
+        libsiedler2::Archiv archiv;
+        BOOST_TEST_REQUIRE(libsiedler2::Load(mapPath, archiv) == 0);
+        const auto& map = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*archiv[0]);
+
+        libsiedler2::MapView view;
+        BOOST_TEST_REQUIRE(view.open(mapPath) == 0);
+        BOOST_TEST_REQUIRE(view.isOpen());
+        BOOST_TEST(view.getHeader().getName() == map.getHeader().getName());
+        BOOST_TEST(view.getNumNodes() == map.getNumNodes());
+        for(unsigned i = 0; i <= static_cast<unsigned>(MapLayer::Owner); i++)
+        {
+            const auto type = static_cast<MapLayer>(i);
+            BOOST_TEST_REQUIRE(view.hasLayer(type) == map.hasLayer(type));
+            if(!map.hasLayer(type))
+                continue;
+            const auto viewLayer = view.getLayer(type);
+            const auto mapLayer = map.getLayer(type);
+            BOOST_TEST(std::equal(viewLayer.begin(), viewLayer.end(), mapLayer.begin(), mapLayer.end()));
+        }
+        BOOST_CHECK_THROW(view.getLayer(MapLayer::Owner), std::range_error);
+        BOOST_TEST(view.getExtraInfo().size() == map.extraInfo.size());
+
+        // Owned copy can be modified and written like a loaded map
+        const auto ownedMap = view.materialize();
+        BOOST_TEST_REQUIRE(ownedMap);
+        view.close();
+        BOOST_TEST(!view.isOpen());
+        const bfs::path mapOutPath = libsiedler2::test::outputPath / ("view_" + file.first);
+        libsiedler2::Archiv outArchiv;
+        outArchiv.push(libsiedler2::clone(*ownedMap));
+        BOOST_TEST_REQUIRE(libsiedler2::Write(mapOutPath, outArchiv) == 0);
+        BOOST_TEST(testFilesEqual(mapOutPath, libsiedler2::test::inputPath / file.second));
+        ownedMap->setMapDataAt(MapLayer::Altitude, 0, 42);
+        BOOST_TEST(ownedMap->getMapDataAt(MapLayer::Altitude, 0) == 42);
+
+        // View of a buffer in memory
+        boost::nowide::ifstream mapFile(mapPath, std::ios::binary);
+        const std::vector<uint8_t> data((std::istreambuf_iterator<char>(mapFile)), std::istreambuf_iterator<char>());
+        BOOST_TEST_REQUIRE(view.open(data) == 0);
+        BOOST_TEST(view.getMapDataAt(MapLayer::Altitude, 7) == map.getMapDataAt(MapLayer::Altitude, 7));
+        // Layers point into the data, except the patched first layer of maps with the extra word bug
+        const auto isInData = [&data](const uint8_t* ptr) {
+            return !std::less<const uint8_t*>()(ptr, data.data())
+                   && std::less<const uint8_t*>()(ptr, data.data() + data.size());
+        };
+        BOOST_TEST(isInData(view.getLayer(MapLayer::Terrain1).data()));
+        BOOST_TEST(isInData(view.getLayer(MapLayer::Altitude).data()) == !view.getHeader().hasExtraWord());
+        const std::vector<uint8_t> truncatedData(data.begin(), data.begin() + data.size() / 2);
+        BOOST_TEST(view.open(truncatedData) == libsiedler2::ErrorCode::UNEXPECTED_EOF);
+        BOOST_TEST(!view.isOpen());
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(BlockCompressionRoundTrip)
+{
+    std::vector<std::vector<uint8_t>> inputs = {{}, {1}, {1, 2, 3}, std::vector<uint8_t>(1000, 7)};
+    std::vector<uint8_t> mixed;
+    for(unsigned i = 0; i < 100000; i++)
+        mixed.push_back(static_cast<uint8_t>((i % 1000 < 500) ? i * 7 : i / 3000));
+    inputs.push_back(mixed);
+    for(const auto& input : inputs)
+    {
+        const std::vector<uint8_t> compressed = libsiedler2::compressBlock(input);
+        std::vector<uint8_t> output(input.size());
+        BOOST_TEST_REQUIRE(libsiedler2::decompressBlock(compressed, output) == 0);
+        BOOST_TEST(output == input, boost::test_tools::per_element());
+        // Too small or too big output
+        if(!input.empty())
+        {
+            std::vector<uint8_t> smallOutput(input.size() - 1u);
+            BOOST_TEST(libsiedler2::decompressBlock(compressed, smallOutput) != 0);
+        }
+        std::vector<uint8_t> bigOutput(input.size() + 1u);
+        BOOST_TEST(libsiedler2::decompressBlock(compressed, bigOutput) != 0);
+    }
+    BOOST_TEST(libsiedler2::compressBlock(inputs[3]).size() < 20u);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedMapRoundTrip)
+{
+    for(const std::string fileName : {"map.SWD", "map.wld"})
+    {
+        const bfs::path mapPath = libsiedler2::test::inputPath / fileName;
+        const bfs::path compressedPath = libsiedler2::test::outputPath / (fileName + ".swz");
+        const bfs::path mapOutPath = libsiedler2::test::outputPath / ("uncompressed_" + fileName);
+        libsiedler2::Archiv archiv;
+        BOOST_TEST_REQUIRE(libsiedler2::Load(mapPath, archiv) == 0);
+        BOOST_TEST_REQUIRE(libsiedler2::Write(compressedPath, archiv) == 0);
+        BOOST_TEST(bfs::file_size(compressedPath) * 3u < bfs::file_size(mapPath));
+
+        libsiedler2::Archiv compressedArchiv;
+        BOOST_TEST_REQUIRE(libsiedler2::Load(compressedPath, compressedArchiv) == 0);
+        const auto& map = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*archiv[0]);
+        const auto& decompressedMap = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*compressedArchiv[0]);
+        BOOST_TEST(decompressedMap.getHeader().getName() == map.getHeader().getName());
+        BOOST_TEST(decompressedMap.extraInfo.size() == map.extraInfo.size());
+        BOOST_TEST_REQUIRE(libsiedler2::Write(mapOutPath, compressedArchiv) == 0);
+        BOOST_TEST(testFilesEqual(mapOutPath, mapPath));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CompressedMapWithInvalidSizes)
+{
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "map.SWD", archiv) == 0);
+    const auto& map = dynamic_cast<const libsiedler2::ArchivItem_Map&>(*archiv[0]);
+    std::stringstream compressed;
+    BOOST_TEST_REQUIRE(map.writeCompressed(compressed) == 0);
+    const std::string data = compressed.str();
+    // Sizes of the header block follow the ID (4 bytes) and version (2 bytes)
+    constexpr size_t sizeOffset = 6, compressedSizeOffset = 10;
+    const auto loadModified = [&data](size_t offset, uint32_t value) {
+        std::string modifiedData = data;
+        for(unsigned i = 0; i < 4; i++)
+            modifiedData[offset + i] = static_cast<char>(value >> (i * 8u));
+        std::stringstream stream(modifiedData);
+        libsiedler2::ArchivItem_Map loadedMap;
+        return loadedMap.loadCompressed(stream);
+    };
+    BOOST_TEST(loadModified(sizeOffset, 0xFFFFFFFF) == libsiedler2::ErrorCode::WRONG_FORMAT);
+    BOOST_TEST(loadModified(compressedSizeOffset, 0xFFFFFFFF) == libsiedler2::ErrorCode::UNEXPECTED_EOF);
+    // Layers missing after the layer mask
+    uint32_t compressedHeaderSize = 0;
+    for(unsigned i = 0; i < 4; i++)
+        compressedHeaderSize |= static_cast<uint32_t>(static_cast<uint8_t>(data[compressedSizeOffset + i])) << (i * 8u);
+    const size_t layerMaskOffset = compressedSizeOffset + 4u + compressedHeaderSize;
+    BOOST_TEST_REQUIRE(layerMaskOffset + 2u < data.size());
+    {
+        std::stringstream stream(data.substr(0, layerMaskOffset + 2u));
+        libsiedler2::ArchivItem_Map loadedMap;
+        BOOST_TEST(loadedMap.loadCompressed(stream) == libsiedler2::ErrorCode::UNEXPECTED_EOF);
+    }
+    std::stringstream stream(data);
+    libsiedler2::ArchivItem_Map loadedMap;
+    BOOST_TEST(loadedMap.loadCompressed(stream) == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
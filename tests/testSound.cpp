@@ -5,13 +5,27 @@
 #include "cmpFiles.h"
 #include "test/config.h"
 #include "libsiedler2/Archiv.h"
+#include "libsiedler2/ArchivItem_Bob.h"
 #include "libsiedler2/ArchivItem_Sound_Midi.h"
 #include "libsiedler2/ArchivItem_Sound_Other.h"
 #include "libsiedler2/ArchivItem_Sound_Wave.h"
 #include "libsiedler2/ArchivItem_Sound_XMidi.h"
+#include "libsiedler2/ErrorCodes.h"
+#include "libsiedler2/MIDI_EventReader.h"
+#include "libsiedler2/MIDI_Track.h"
+#include "libsiedler2/PcmConversion.h"
+#include "libsiedler2/SharedBytes.h"
+#include "libsiedler2/SoundBank.h"
+#include "libsiedler2/XMIDI_Track.h"
+#include "libsiedler2/XMIDI_TrackConverter.h"
 #include "libsiedler2/libsiedler2.h"
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 namespace bfs = boost::filesystem;
 
@@ -173,4 +187,369 @@ BOOST_AUTO_TEST_CASE(Clone)
     BOOST_TEST_REQUIRE(snd8->getData() == snd4.getData(), boost::test_tools::per_element());
 }
 
+
+BOOST_AUTO_TEST_CASE(ConvertXMidiWithOverlappingNotes)
+{
+    // Note off of the 1st note is after the whole 2nd note
+    const std::vector<uint8_t> xmidiData = {
+      0x90, 0x3C, 0x7F, 0x0A,       // t=0: Note 0x3C on, duration 10
+      0x05, 0x90, 0x3E, 0x7F, 0x02, // t=5: Note 0x3E on, duration 2
+      0x0A, 0xFF, 0x2F, 0x00        // t=15: End of track
+    };
+    std::istringstream xmidiStream(std::string(xmidiData.begin(), xmidiData.end()));
+    libsiedler2::XMIDI_Track xmidiTrack;
+    BOOST_TEST_REQUIRE(xmidiTrack.read(xmidiStream, xmidiData.size()) == 0);
+    libsiedler2::XMIDI_TrackConverter converter(xmidiTrack);
+    BOOST_TEST_REQUIRE(converter.Convert());
+    BOOST_TEST(!converter.Convert());
+
+    const std::vector<uint8_t> expected = {
+      'M',  'T',  'r',  'k',  0x00, 0x00, 0x00, 24,   // Header
+      0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,       // t=0: Tempo
+      0x00, 0x90, 0x3C, 0x7F,                         // t=0: Note on
+      0x05, 0x3E, 0x7F,                               // t=5: Note on (running status)
+      0x02, 0x3E, 0x00,                               // t=7: Note off
+      0x03, 0x3C, 0x00,                               // t=10: Note off
+      0x05, 0xFF, 0x2F, 0x00                          // t=15: End of track
+    };
+    const libsiedler2::MIDI_Track midiTrack = converter.CreateMidiTrack();
+    BOOST_TEST(midiTrack.getData() == expected, boost::test_tools::per_element());
+}
+
+
+BOOST_AUTO_TEST_CASE(ConvertAllXMidiTracks)
+{
+    const bfs::path inPath = libsiedler2::test::inputPath / "testXMidi.xmi";
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(inPath, archiv) == 0);
+    // Same sound multiple times and in a sub archive (bobs are archives too)
+    const auto& snd = dynamic_cast<const libsiedler2::ArchivItem_Sound_XMidi&>(*archiv[0]);
+    const auto origSnd = libsiedler2::clone(snd);
+    archiv.pushC(snd);
+    auto subArchiv = std::make_unique<libsiedler2::ArchivItem_Bob>();
+    subArchiv->pushC(snd);
+    archiv.push(std::move(subArchiv));
+    libsiedler2::convertAllXMidiTracks(archiv, 4);
+
+    const auto& storedSubArchiv = dynamic_cast<const libsiedler2::ArchivItem_Bob&>(*archiv[2]);
+    const auto& subSnd = dynamic_cast<const libsiedler2::ArchivItem_Sound_XMidi&>(*storedSubArchiv[0]);
+    for(uint16_t i = 0; i < origSnd->getNumTracks(); i++)
+    {
+        // Converted tracks are cached
+        const libsiedler2::MIDI_Track& midiTrack = snd.getMidiTrack(i);
+        BOOST_TEST(&midiTrack == &snd.getMidiTrack(i));
+        BOOST_TEST(midiTrack.getData() == origSnd->getMidiTrack(i).getData(), boost::test_tools::per_element());
+        BOOST_TEST(subSnd.getMidiTrack(i).getData() == midiTrack.getData(), boost::test_tools::per_element());
+    }
+
+    // Concurrent access converts once
+    const auto snd2 = libsiedler2::clone(*origSnd);
+    std::vector<const libsiedler2::MIDI_Track*> results(4);
+    std::vector<std::thread> threads;
+    for(auto& result : results)
+        threads.emplace_back([&snd2, &result]() { result = &snd2->getMidiTrack(0); });
+    for(std::thread& thread : threads)
+        thread.join();
+    for(const auto* result : results)
+        BOOST_TEST(result == results[0]);
+    BOOST_CHECK_THROW(snd2->getMidiTrack(snd2->getNumTracks()), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(ReadMidiEvents)
+{
+    const bfs::path inPath = libsiedler2::test::inputPath / "testXMidi.xmi";
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(inPath, archiv) == 0);
+    const auto& snd = dynamic_cast<const libsiedler2::ArchivItem_Sound_XMidi&>(*archiv[0]);
+    for(uint16_t i = 0; i < snd.getNumTracks(); i++)
+    {
+        // Events of the XMIDI track are the same as the ones parsed from the converted track
+        libsiedler2::MIDI_EventReader xmidiReader(*snd.getTrack(i));
+        libsiedler2::MIDI_EventReader midiReader(snd.getMidiTrack(i));
+        libsiedler2::MIDI_EventReader::Event xmidiEvent, midiEvent;
+        unsigned numEvents = 0, numNotes = 0;
+        uint32_t lastTime = 0;
+        while(xmidiReader.next(xmidiEvent))
+        {
+            BOOST_TEST_REQUIRE(midiReader.next(midiEvent));
+            BOOST_TEST_REQUIRE(xmidiEvent.time == midiEvent.time);
+            BOOST_TEST_REQUIRE(xmidiEvent.status == midiEvent.status);
+            BOOST_TEST_REQUIRE(xmidiEvent.data == midiEvent.data, boost::test_tools::per_element());
+            BOOST_TEST_REQUIRE(xmidiEvent.payload == midiEvent.payload, boost::test_tools::per_element());
+            BOOST_TEST_REQUIRE(xmidiEvent.time >= lastTime);
+            lastTime = xmidiEvent.time;
+            ++numEvents;
+            if((xmidiEvent.status >> 4) == 0x9)
+                ++numNotes;
+        }
+        BOOST_TEST(xmidiEvent.isEndOfTrack());
+        BOOST_TEST(!midiReader.next(midiEvent));
+        BOOST_TEST(midiReader.isDone());
+        BOOST_TEST(numEvents > 1u);
+        BOOST_TEST(numNotes > 0u);
+    }
+
+    // Running status and SysEx payload
+    const std::vector<uint8_t> midiData = {
+      'M',  'T',  'r',  'k',  0x00, 0x00, 0x00, 17,   // Header
+      0x00, 0x90, 0x3C, 0x7F,                         // t=0: Note on
+      0x81, 0x00, 0x3C, 0x00,                         // t=128: Note off (running status)
+      0x01, 0xF0, 0x02, 0x43, 0xF7,                   // t=129: SysEx
+      0x00, 0xFF, 0x2F, 0x00                          // t=129: End of track
+    };
+    const libsiedler2::MIDI_Track midiTrack(midiData);
+    libsiedler2::MIDI_EventReader reader(midiTrack);
+    libsiedler2::MIDI_EventReader::Event event;
+    BOOST_TEST_REQUIRE(reader.next(event));
+    BOOST_TEST(event.time == 0u);
+    BOOST_TEST(event.status == 0x90);
+    BOOST_TEST(event.data[0] == 0x3C);
+    BOOST_TEST(event.data[1] == 0x7F);
+    BOOST_TEST_REQUIRE(reader.next(event));
+    BOOST_TEST(event.time == 128u);
+    BOOST_TEST(event.status == 0x90);
+    BOOST_TEST(event.data[0] == 0x3C);
+    BOOST_TEST(event.data[1] == 0);
+    BOOST_TEST_REQUIRE(reader.next(event));
+    BOOST_TEST(event.time == 129u);
+    BOOST_TEST(event.status == 0xF0);
+    BOOST_TEST_REQUIRE(event.payload.size() == 2u);
+    BOOST_TEST(event.payload.data() == &midiTrack.getData()[19]);
+    BOOST_TEST_REQUIRE(reader.next(event));
+    BOOST_TEST(event.isEndOfTrack());
+    BOOST_TEST(!reader.next(event));
+
+    // Truncated track
+    std::vector<uint8_t> truncatedData(midiData.begin(), midiData.begin() + 10);
+    truncatedData[7] = 2;
+    const libsiedler2::MIDI_Track truncatedTrack(truncatedData);
+    libsiedler2::MIDI_EventReader truncatedReader(truncatedTrack);
+    BOOST_CHECK_THROW(truncatedReader.next(event), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ResampleSine)
+{
+    const libsiedler2::PolyphaseResampler resampler(11025, 48000);
+    BOOST_TEST(resampler.getUpFactor() == 640u);
+    BOOST_TEST(resampler.getDownFactor() == 147u);
+    BOOST_TEST(resampler.getNumTaps() % 8u == 0u);
+
+    constexpr double pi = 3.14159265358979323846;
+    const auto sine = [pi](double freq, double rate, size_t i) {
+        return static_cast<float>(std::sin(2 * pi * freq * i / rate));
+    };
+    std::vector<float> input(11025);
+    for(size_t i = 0; i < input.size(); i++)
+        input[i] = sine(1000, 11025, i);
+    std::vector<float> output;
+    resampler.process(input, output);
+    BOOST_TEST_REQUIRE(output.size() == 48000u);
+    // Ignore the borders which are faded by the zero padding
+    for(size_t i = 100; i < output.size() - 100u; i++)
+        BOOST_TEST_REQUIRE(std::abs(output[i] - sine(1000, 48000, i)) < 0.01f);
+
+    // Frequencies above the new nyquist frequency are removed when downsampling
+    const libsiedler2::PolyphaseResampler downsampler(48000, 11025);
+    std::vector<float> highInput(48000);
+    for(size_t i = 0; i < highInput.size(); i++)
+        highInput[i] = sine(8000, 48000, i);
+    std::vector<float> highOutput;
+    downsampler.process(highInput, highOutput);
+    BOOST_TEST_REQUIRE(highOutput.size() == 11025u);
+    for(size_t i = 100; i < highOutput.size() - 100u; i++)
+        BOOST_TEST_REQUIRE(std::abs(highOutput[i]) < 0.05f);
+}
+
+BOOST_AUTO_TEST_CASE(ConvertWave)
+{
+    // Headerless S2 sound: 8 bit unsigned mono with 11025Hz
+    const std::vector<uint8_t> rawData = {128, 255, 0, 64, 192};
+    std::istringstream rawStream(std::string(rawData.begin(), rawData.end()));
+    libsiedler2::ArchivItem_Sound_Wave rawWave;
+    BOOST_TEST_REQUIRE(rawWave.load(rawStream, static_cast<uint32_t>(rawData.size())) == 0);
+    std::vector<float> samples;
+    BOOST_TEST_REQUIRE(rawWave.convert(libsiedler2::PcmFormat{11025, 2}, samples) == 0);
+    const std::vector<float> expectedSamples = {0.f,  0.f,  127 / 128.f, 127 / 128.f, -1.f,
+                                                -1.f, -.5f, -.5f,        .5f,         .5f};
+    BOOST_TEST(samples == expectedSamples, boost::test_tools::per_element());
+    std::vector<int16_t> intSamples;
+    BOOST_TEST_REQUIRE(rawWave.convert(libsiedler2::PcmFormat{11025, 1}, intSamples) == 0);
+    const std::vector<int16_t> expectedIntSamples = {0, 127 * 256, -32768, -16384, 16384};
+    BOOST_TEST(intSamples == expectedIntSamples, boost::test_tools::per_element());
+    BOOST_TEST_REQUIRE(rawWave.convert(libsiedler2::PcmFormat{48000, 2}, samples) == 0);
+    BOOST_TEST(samples.size() == (rawData.size() * 640u + 146u) / 147u * 2u);
+
+    // 16 bit stereo with 44100Hz
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "testStereo.wav", archiv) == 0);
+    const auto& wave = dynamic_cast<const libsiedler2::ArchivItem_Sound_Wave&>(*archiv[0]);
+    const libsiedler2::span<const uint8_t> data = wave.getData();
+    const size_t numFrames = data.size() / 4u;
+    BOOST_TEST_REQUIRE(wave.convert(libsiedler2::PcmFormat{44100, 2}, intSamples) == 0);
+    BOOST_TEST_REQUIRE(intSamples.size() == numFrames * 2u);
+    for(size_t i = 0; i < intSamples.size(); i++)
+        BOOST_TEST_REQUIRE(intSamples[i] == static_cast<int16_t>(data[i * 2u] | (data[i * 2u + 1u] << 8)));
+    BOOST_TEST_REQUIRE(wave.convert(libsiedler2::PcmFormat{44100, 1}, samples) == 0);
+    BOOST_TEST_REQUIRE(samples.size() == numFrames);
+    for(size_t i = 0; i < numFrames; i++)
+        BOOST_TEST_REQUIRE(samples[i] == (intSamples[i * 2u] + intSamples[i * 2u + 1u]) / 65536.f);
+
+    // Batch conversion of all sounds
+    archiv.pushC(rawWave);
+    archiv.pushC(libsiedler2::ArchivItem_Sound_XMidi());
+    libsiedler2::ArchivItem_Sound_Wave invalidWave(rawWave);
+    libsiedler2::WAV_Header header = invalidWave.getHeader();
+    header.bitsPerSample = 24;
+    invalidWave.setHeader(header);
+    archiv.pushC(invalidWave);
+    std::vector<std::vector<float>> buffers;
+    BOOST_TEST(libsiedler2::convertAllWaves(archiv, libsiedler2::PcmFormat(), buffers, 2)
+               == libsiedler2::ErrorCode::UNSUPPORTED_FORMAT);
+    BOOST_TEST_REQUIRE(buffers.size() == 4u);
+    std::vector<float> expectedBuffer;
+    BOOST_TEST_REQUIRE(wave.convert(libsiedler2::PcmFormat(), expectedBuffer) == 0);
+    BOOST_TEST(buffers[0] == expectedBuffer, boost::test_tools::per_element());
+    BOOST_TEST_REQUIRE(rawWave.convert(libsiedler2::PcmFormat(), expectedBuffer) == 0);
+    BOOST_TEST(buffers[1] == expectedBuffer, boost::test_tools::per_element());
+    BOOST_TEST(buffers[2].empty());
+    BOOST_TEST(buffers[3].empty());
+}
+
+BOOST_AUTO_TEST_CASE(MapSoundData)
+{
+    // Archive with waves, other sounds and parsed sounds
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "testStereo.wav", archiv) == 0);
+    libsiedler2::Archiv archivOgg, archivXMidi;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "test.ogg", archivOgg) == 0);
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "testXMidi.xmi", archivXMidi) == 0);
+    const std::vector<uint8_t> rawData(1000, 42);
+    std::istringstream rawStream(std::string(rawData.begin(), rawData.end()));
+    libsiedler2::ArchivItem_Sound_Wave rawWave;
+    BOOST_TEST_REQUIRE(rawWave.load(rawStream, static_cast<uint32_t>(rawData.size())) == 0);
+    archiv.pushC(rawWave);
+    archiv.pushC(*archivOgg[0]);
+    archiv.pushC(*archivXMidi[0]);
+    const bfs::path lstPath = libsiedler2::test::outputPath / "mappedSounds.lst";
+    BOOST_TEST_REQUIRE(libsiedler2::Write(lstPath, archiv) == 0);
+
+    libsiedler2::Archiv copiedArchiv, mappedArchiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(lstPath, copiedArchiv) == 0);
+    BOOST_TEST(!libsiedler2::setSoundDataMapping(true));
+    BOOST_TEST_REQUIRE(libsiedler2::Load(lstPath, mappedArchiv) == 0);
+    libsiedler2::Archiv mappedWav;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "testStereo.wav", mappedWav) == 0);
+    BOOST_TEST(libsiedler2::setSoundDataMapping(false));
+    BOOST_TEST_REQUIRE(mappedArchiv.size() == 4u);
+
+    const auto& wave = dynamic_cast<const libsiedler2::ArchivItem_Sound_Wave&>(*mappedArchiv[0]);
+    const auto& copiedWave = dynamic_cast<const libsiedler2::ArchivItem_Sound_Wave&>(*copiedArchiv[0]);
+    BOOST_TEST(wave.getData() == copiedWave.getData(), boost::test_tools::per_element());
+    BOOST_TEST(std::memcmp(&wave.getHeader(), &copiedWave.getHeader(), sizeof(libsiedler2::WAV_Header)) == 0);
+    const auto& wave2 = dynamic_cast<const libsiedler2::ArchivItem_Sound_Wave&>(*mappedArchiv[1]);
+    BOOST_TEST(wave2.getData() == rawData, boost::test_tools::per_element());
+    BOOST_TEST(wave2.getHeader().samplesPerSec == 11025u);
+    const auto& ogg = dynamic_cast<const libsiedler2::ArchivItem_Sound_Other&>(*mappedArchiv[2]);
+    BOOST_TEST(ogg.getData() == dynamic_cast<const libsiedler2::ArchivItem_Sound_Other&>(*copiedArchiv[2]).getData(),
+               boost::test_tools::per_element());
+    // Payloads point into the file: Each is followed by the item header (used flag, bobtype, length) of the next
+    BOOST_TEST(wave2.getData().data() == wave.getData().end() + 2 + 2 + 4 + sizeof(libsiedler2::WAV_Header));
+    BOOST_TEST(ogg.getData().data() == wave2.getData().end() + 2 + 2 + 4);
+    const auto& xmidi = dynamic_cast<const libsiedler2::ArchivItem_Sound_XMidi&>(*mappedArchiv[3]);
+    BOOST_TEST(xmidi.getMidiTrack(0).getData()
+                 == dynamic_cast<const libsiedler2::ArchivItem_Sound_XMidi&>(*archivXMidi[0]).getMidiTrack(0).getData(),
+               boost::test_tools::per_element());
+
+    // Mapping outlives the archive and stays valid in copies
+    const auto waveCopy = libsiedler2::clone(wave);
+    mappedArchiv.clear();
+    BOOST_TEST(waveCopy->getData() == copiedWave.getData(), boost::test_tools::per_element());
+    BOOST_TEST(dynamic_cast<const libsiedler2::ArchivItem_Sound_Wave&>(*mappedWav[0]).getData() == copiedWave.getData(),
+               boost::test_tools::per_element());
+
+    const bfs::path outPath = libsiedler2::test::outputPath / "mappedSounds2.lst";
+    libsiedler2::Archiv outArchiv;
+    outArchiv.push(libsiedler2::clone(*waveCopy));
+    outArchiv.pushC(*copiedArchiv[1]);
+    outArchiv.pushC(*copiedArchiv[2]);
+    outArchiv.pushC(*copiedArchiv[3]);
+    BOOST_TEST_REQUIRE(libsiedler2::Write(outPath, outArchiv) == 0);
+    BOOST_TEST(testFilesEqual(outPath, lstPath));
+
+    // Headerless sounds reference all bytes
+    const libsiedler2::SharedBytes rawBytes(rawData);
+    libsiedler2::ArchivItem_Sound_Wave headerlessWave;
+    BOOST_TEST_REQUIRE(headerlessWave.loadShared(rawBytes) == 0);
+    BOOST_TEST(headerlessWave.getData().data() == rawBytes.data());
+    BOOST_TEST(headerlessWave.getData().size() == rawData.size());
+    BOOST_TEST(std::memcmp(&headerlessWave.getHeader(), &rawWave.getHeader(), sizeof(libsiedler2::WAV_Header)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(WriteAndOpenSoundBank)
+{
+    libsiedler2::Archiv archiv;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "testStereo.wav", archiv) == 0);
+    libsiedler2::Archiv archivOgg;
+    BOOST_TEST_REQUIRE(libsiedler2::Load(libsiedler2::test::inputPath / "test.ogg", archivOgg) == 0);
+    const std::vector<uint8_t> rawData = {128, 255, 0, 64, 192};
+    std::istringstream rawStream(std::string(rawData.begin(), rawData.end()));
+    libsiedler2::ArchivItem_Sound_Wave rawWave;
+    BOOST_TEST_REQUIRE(rawWave.load(rawStream, static_cast<uint32_t>(rawData.size())) == 0);
+    archiv.pushC(*archivOgg[0]);
+    archiv.pushC(rawWave);
+
+    const libsiedler2::PcmFormat format{22050, 2};
+    const bfs::path intBankPath = libsiedler2::test::outputPath / "sounds16.sbk";
+    const bfs::path floatBankPath = libsiedler2::test::outputPath / "soundsF.sbk";
+    BOOST_TEST_REQUIRE(
+      libsiedler2::SoundBank::write(intBankPath, archiv, format, libsiedler2::SampleFormat::Int16, 2) == 0);
+    BOOST_TEST_REQUIRE(
+      libsiedler2::SoundBank::write(floatBankPath, archiv, format, libsiedler2::SampleFormat::Float32, 2) == 0);
+
+    libsiedler2::SoundBank intBank, floatBank;
+    BOOST_TEST(!intBank.isOpen());
+    BOOST_TEST_REQUIRE(intBank.open(intBankPath) == 0);
+    BOOST_TEST_REQUIRE(floatBank.open(floatBankPath) == 0);
+    BOOST_TEST_REQUIRE(intBank.getNumSounds() == 3u);
+    BOOST_TEST_REQUIRE(floatBank.getNumSounds() == 3u);
+    BOOST_TEST((intBank.getSampleFormat() == libsiedler2::SampleFormat::Int16));
+    BOOST_TEST((floatBank.getSampleFormat() == libsiedler2::SampleFormat::Float32));
+    for(size_t i : {0u, 2u})
+    {
+        const auto& wave = dynamic_cast<const libsiedler2::ArchivItem_Sound_Wave&>(*archiv[i]);
+        std::vector<int16_t> expectedInt;
+        std::vector<float> expectedFloat;
+        BOOST_TEST_REQUIRE(wave.convert(format, expectedInt) == 0);
+        BOOST_TEST_REQUIRE(wave.convert(format, expectedFloat) == 0);
+
+        const libsiedler2::SoundBank::Entry& entry = intBank.getEntry(i);
+        BOOST_TEST(entry.offset % libsiedler2::SoundBank::alignment == 0u);
+        BOOST_TEST(entry.numFrames == expectedInt.size() / 2u);
+        BOOST_TEST(entry.sampleRate == format.sampleRate);
+        BOOST_TEST(entry.numChannels == format.numChannels);
+        const auto intSamples = intBank.getSamplesInt16(i);
+        BOOST_TEST(intSamples == expectedInt, boost::test_tools::per_element());
+        // Points into the file
+        BOOST_TEST(reinterpret_cast<const uint8_t*>(intSamples.data()) == intBank.getData().data() + entry.offset);
+        BOOST_TEST(floatBank.getSamplesFloat(i) == expectedFloat, boost::test_tools::per_element());
+    }
+    // Not a wave
+    BOOST_TEST(intBank.getEntry(1).numFrames == 0u);
+    BOOST_TEST(intBank.getSamplesInt16(1).empty());
+    BOOST_CHECK_THROW(intBank.getSamplesFloat(0), std::logic_error);
+    BOOST_CHECK_THROW(intBank.getEntry(3), std::out_of_range);
+
+    // Data must be aligned
+    libsiedler2::SoundBank bankView;
+    BOOST_TEST(bankView.open(intBank.getData().subspan(1, intBank.getData().size() - 1u))
+               == libsiedler2::ErrorCode::INVALID_BUFFER);
+    BOOST_TEST_REQUIRE(bankView.open(intBank.getData()) == 0);
+    BOOST_TEST(bankView.getSamplesInt16(2) == intBank.getSamplesInt16(2), boost::test_tools::per_element());
+    // Truncated
+    BOOST_TEST(bankView.open(intBank.getData().first(intBank.getData().size() - 1u))
+               == libsiedler2::ErrorCode::UNEXPECTED_EOF);
+    intBank.close();
+    BOOST_TEST(!intBank.isOpen());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,7 +5,9 @@
 #include "test/config.h"
 #include "libsiedler2/Archiv.h"
 #include "libsiedler2/ArchivItem_Text.h"
+#include "libsiedler2/TextTable.h"
 #include "libsiedler2/libsiedler2.h"
+#include "libsiedler2/oem.h"
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <cstdlib>
@@ -153,4 +155,108 @@ BOOST_AUTO_TEST_CASE(ReadOriginalFiles)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ConvertOem)
+{
+    // ANSI 0xF6 (o umlaut) is OEM 0x94, 0xDF (sharp s) is 0xE1, chars up to 128 are kept
+    BOOST_TEST(libsiedler2::OemToAnsi("Gr\x94\xE1" "e\x80") == "Gr\xF6\xDF" "e\x80");
+    BOOST_TEST(libsiedler2::AnsiToOem("Gr\xF6\xDF" "e\x80") == "Gr\x94\xE1" "e\x80");
+    // Chars without conversion become 0
+    BOOST_TEST(libsiedler2::OemToAnsi("\xB0") == std::string(1, '\0'));
+    // Every OEM char which has an ANSI char converts back
+    for(unsigned c = 1; c < 256; c++)
+    {
+        const std::string oem(1, static_cast<char>(c));
+        const std::string ansi = libsiedler2::OemToAnsi(oem);
+        if(ansi[0] != '\0')
+            BOOST_TEST(libsiedler2::AnsiToOem(ansi) == oem);
+    }
+
+    // UTF-8 of the ANSI char, including the special chars of Windows-1252
+    BOOST_TEST(libsiedler2::OemToUtf8("Gr\x94\xE1" "e") == "Gr\xC3\xB6\xC3\x9F" "e");
+    BOOST_TEST(libsiedler2::OemToUtf8("\x9F\xD8") == "\xC6\x92\xE2\x80\xA1");
+    BOOST_TEST(libsiedler2::AnsiToUtf8("\x80 \xF6") == "\xE2\x82\xAC \xC3\xB6");
+    // Chars without an ANSI char use the code page 437 char (light shade, alpha, infinity)
+    BOOST_TEST(libsiedler2::OemToUtf8("\xB0\xE0\xEC") == "\xE2\x96\x91\xCE\xB1\xE2\x88\x9E");
+    for(unsigned c = 1; c < 256; c++)
+    {
+        const std::string oem(1, static_cast<char>(c));
+        const std::string utf8 = libsiedler2::OemToUtf8(oem);
+        BOOST_TEST(utf8.find('\0') == std::string::npos);
+        const std::string ansi = libsiedler2::OemToAnsi(oem);
+        if(ansi[0] != '\0')
+            BOOST_TEST(utf8 == libsiedler2::AnsiToUtf8(ansi));
+    }
+
+    // Line breaks
+    BOOST_TEST(libsiedler2::OemTextToAnsi("a@@@b\r\nc\x94@") == "a\n@b\n\nc\xF6@");
+    BOOST_TEST(libsiedler2::AnsiTextToOem("a\n@b\xF6\n") == "a@@@b\x94@@");
+    BOOST_TEST(libsiedler2::normalizeLineBreaks("a\r\nb\rc\n\r") == "a\nb\nc\n\n");
+
+    libsiedler2::ArchivItem_Text txt;
+    txt.setText("Line1@@Line2\x94", true);
+    BOOST_TEST(txt.getText() == "Line1\nLine2\xF6");
+    BOOST_TEST(txt.getFileText(true) == "Line1@@Line2\x94");
+    BOOST_TEST(txt.getFileText(false) == "Line1\nLine2\xF6");
+    txt.setText("Line1\r\nLine2\rLine3");
+    BOOST_TEST(txt.getText() == "Line1\nLine2\nLine3");
+}
+
+BOOST_AUTO_TEST_CASE(LoadTextTable)
+{
+    for(const auto& fileName : {"outTable.ENG", "outTable.GER", "outTablePlain.GER"})
+    {
+        BOOST_TEST_INFO_SCOPE("For " << fileName);
+        const bfs::path outFilepath = libsiedler2::test::outputPath / fileName;
+        libsiedler2::Archiv archiv, archivIn, archivTable;
+        createTxt(archiv, outFilepath, bfs::path(fileName).stem() == "outTablePlain" ? 1 : 17);
+        BOOST_TEST_REQUIRE(libsiedler2::Load(outFilepath, archivIn) == 0);
+
+        libsiedler2::TextTable table;
+        BOOST_TEST_REQUIRE(table.load(outFilepath) == 0);
+        BOOST_TEST_REQUIRE(table.size() == archivIn.size());
+        for(unsigned i = 0; i < archivIn.size(); i++)
+        {
+            const auto* txtIn = dynamic_cast<const libsiedler2::ArchivItem_Text*>(archivIn[i]);
+            BOOST_TEST(table.hasText(i) == (txtIn != nullptr));
+            if(txtIn)
+                BOOST_TEST(table[i] == libsiedler2::AnsiToUtf8(txtIn->getText()));
+            else
+                BOOST_TEST(table[i].empty());
+        }
+        BOOST_TEST(!table.hasText(table.size()));
+
+        table.toArchiv(archivTable);
+        BOOST_TEST_REQUIRE(archivTable.size() == archivIn.size());
+        for(unsigned i = 0; i < archivIn.size(); i++)
+        {
+            const auto* txtIn = dynamic_cast<const libsiedler2::ArchivItem_Text*>(archivIn[i]);
+            const auto* txtTable = dynamic_cast<const libsiedler2::ArchivItem_Text*>(archivTable[i]);
+            BOOST_TEST_REQUIRE((txtIn != nullptr) == (txtTable != nullptr));
+            if(txtIn)
+                BOOST_TEST(txtTable->getText() == txtIn->getText());
+        }
+    }
+
+    // OEM chars without an ANSI char do not add NULL chars, so each text has only its terminator
+    {
+        const std::string oemText = "a\xB0@@b\xE0";
+        libsiedler2::TextTable table;
+        const libsiedler2::span<const uint8_t> data(reinterpret_cast<const uint8_t*>(oemText.data()), oemText.size());
+        BOOST_TEST_REQUIRE(table.load(data) == 0);
+        BOOST_TEST_REQUIRE(table.size() == 1u);
+        BOOST_TEST(table[0] == "a\xE2\x96\x91\nb\xCE\xB1");
+        BOOST_TEST(table[0].find('\0') == std::string_view::npos);
+        BOOST_TEST(table[0].data()[table[0].size()] == '\0');
+    }
+
+    // Converting back from UTF-8 returns the same ANSI chars
+    for(unsigned c = 1; c < 256; c++)
+    {
+        const std::string ansi(1, static_cast<char>(c));
+        BOOST_TEST(libsiedler2::Utf8ToAnsi(libsiedler2::AnsiToUtf8(ansi)) == ansi);
+    }
+    BOOST_TEST(libsiedler2::Utf8ToAnsi("a\xE2\x82\xAC\xE2\x82") == "a\x80?");
+    BOOST_TEST(libsiedler2::Utf8ToAnsi("\xE2\x88\x9E!") == "?!");
+}
+
 BOOST_AUTO_TEST_SUITE_END()